@@ -1,12 +1,14 @@
 // Duino/Common/AVR/DA_Analogue.hpp - Arduino-AVR interfacing to ADC and experimental PWM-DAC
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Dec 2020 - Mar 2021
+// (c) Project Contributors Dec 2020 - Oct 2026
 
 #ifndef DA_ANALOGUE_HPP
 #define DA_ANALOGUE_HPP
 
+#ifndef SLEEP_MODE_ADC
 #include <avr/sleep.h>
+#endif
 
 #ifdef ARDUINO_AVR_MEGA2560
 #define NO_IN_THERM
@@ -54,7 +56,7 @@ public:
       Mux ref=VCC // reference for all 
    )
    {
-      ref&= REF_MASK;
+      ref= (Mux)(ref & REF_MASK);
       i&= ANLG_MUX_MSK;
       c&= IN_MASK;
       while (i<ANLG_MUX_MAX)
@@ -112,7 +114,7 @@ public:
    
    void init (uint8_t clkPS)
    {
-      ADCSRA= (1<<ADEN) | clkPS & 0x07; // Enable, clock prescaler 128 -> 125kHz sampling clock (~12kHz 10b sample rate?)
+      ADCSRA= (1<<ADEN) | (clkPS & 0x07); // Enable, clock prescaler 128 -> 125kHz sampling clock (~12kHz 10b sample rate?)
    }
    void on (void) { ADCSRA|= (1<<ADEN); }
    void off (void) { ADCSRA&= ~(1<<ADEN); }
@@ -245,8 +247,7 @@ public:
 
    uint8_t avail (void)
    {
-      int8_t n= nE - nR;
-      if (n < 0) { n+= 0xFF; }
+      uint8_t n= nE - nR; // modulo 256
       return(n); // min(n,ANLG_VQ_MAX);
    } // avail
 
@@ -278,6 +279,99 @@ public:
    } // dump
 }; // CAnalogueDbg
 
+// Free running sampler: auto triggered conversions with the ISR walking the first n
+// entries of vmux by itself. As the next conversion starts (latching ADMUX) when the
+// interrupt is raised, a mux change made by the ISR applies to the conversion after
+// the one in progress, so the ISR tracks both. After each switch nSettle results
+// are discarded, then nDwell kept. Kept samples go to a ring with the vmux index and
+// conversion count (time stamp in units of 13 ADC clocks, assuming no interrupt
+// is missed); when the ring is full samples are dropped & counted.
+#ifndef ANLG_RING_SH
+#define ANLG_RING_SH (5)
+#endif
+#define ANLG_RING_MAX (1<<ANLG_RING_SH)
+#define ANLG_RING_MSK  (ANLG_RING_MAX-1)
+
+class CAnSampler : public CAnCommon
+{
+public:
+   struct Sample { uint16_t v, t; }; // value | vmux index << 12, conversion count
+
+protected:
+   Sample r[ANLG_RING_MAX];
+   volatile uint8_t iW; // written by ISR only
+   uint8_t iR;
+   volatile uint16_t nConv, nLost;
+   uint8_t cC, qC, cN, qN; // vmux index & position in dwell: completing, in progress
+   uint8_t n, nSettle, nDwell;
+
+   uint16_t atomic16 (volatile uint16_t& v) const { const uint8_t s= SREG; cli(); const uint16_t r= v; SREG= s; return(r); }
+
+public:
+   CAnSampler (uint8_t profileID=0) : CAnCommon(profileID), iW{0}, iR{0}, nConv{0}, nLost{0},
+      cC{0}, qC{0}, cN{0}, qN{0}, n{1}, nSettle{1}, nDwell{1} { ; }
+
+   using CAnMux::get;
+
+   void init (uint8_t clkPS=0x7) { CAnMux::init(0); CAnCommon::init(clkPS); }
+
+   // Sample vmux[0..nSeq-1] in turn, discarding nS after each switch then keeping nD
+   void start (const uint8_t nSeq, const uint8_t nS=1, const uint8_t nD=1)
+   {
+      stop();
+      n= constrain(nSeq, 1, ANLG_MUX_MAX);
+      nSettle= nS; nDwell= max(nD, 1);
+      iR= iW; nConv= nLost= 0;
+      cC= qC= 0; set(0); // first conversion (and second, latched before first interrupt)
+      cN= 0; qN= (nSettle + nDwell > 1);
+      ADCSRB&= ~0x07; // free running
+      ADCSRA= (1<<ADEN) | (1<<ADIE) | (1<<ADATE) | (1<<ADSC) | (1<<ADIF) | (ADCSRA & 0x7);
+   } // start
+
+   void stop (void) { ADCSRA&= ~((1<<ADATE) | (1<<ADIE)); }
+
+   void event (void) // ISR
+   {
+      const uint16_t v= ADCW;
+      if (qC >= nSettle)
+      {
+         if ((uint8_t)(iW - iR) < ANLG_RING_MAX)
+         {
+            Sample& e= r[iW & ANLG_RING_MSK];
+            e.v= v | (cC << 12); e.t= nConv;
+            iW++;
+         }
+         else { nLost++; }
+      }
+      nConv++;
+      cC= cN; qC= qN;
+      if (++qN >= nSettle + nDwell)
+      {
+         qN= 0;
+         cN= (cN+1 < n) ? cN+1 : 0;
+         if (cN != cC) { set(cN); } // applies to conversion after next
+      }
+   } // event
+
+   uint8_t avail (void) const { return(iW - iR); }
+
+   // Batch of up to max samples, returns number
+   uint8_t get (Sample d[], const uint8_t max)
+   {
+      uint8_t k= 0;
+      while ((k < max) && (iR != iW)) { d[k++]= r[iR & ANLG_RING_MSK]; iR++; }
+      return(k);
+   } // get
+
+   static uint16_t value (const Sample& s) { return(s.v & 0xFFF); }
+   static uint8_t index (const Sample& s) { return(s.v >> 12); }
+
+   uint16_t lost (void) { return atomic16(nLost); }
+   uint16_t conversions (void) { return atomic16(nConv); }
+}; // CAnSampler
+
+// *REMEMBER* declare handler eg. : ISR (ADC_vect) { gADC.event(); }
+
 // PWM needs timer/counter - plenty extra on Mega series
 // at 1kHz update rate (standard for general purpose task management) a
 // 470 Ohm resistor & 10uF capacitor gives reasonable smoothing. 
@@ -27,6 +27,8 @@ public:
   {
 #if (1 == AVR_FAST_TIMER)
       return TCNT1;
+#else
+      return(micros() << 4); // same tick (16MHz), 4us granularity on AVR
 #endif // AVR
   } // stamp
 
@@ -6,12 +6,16 @@
 // ---
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Apr-May 2022
+// (c) Project Contributors Apr 2022 - Oct 2026
 
 #ifndef DA_TWMISR_HPP
 #define DA_TWMISR_HPP
 
+#ifndef TW_STATUS_MASK // else host model (HS_TWM.hpp)
 #include <util/twi.h>
+#endif
+#include "DA_FastPollTimer.hpp"
+#include "../TWTrace.hpp"
 
 namespace TWM { // Two Wire Master
 
@@ -24,10 +28,41 @@ enum ClkTok : uint8_t   // Tokens -> magic numbers for wire clock rate (for pres
    CLK_INVALID=0x00 // -> 1MHz but not usable
 };
 
+// Clock planning: SCL = F_CPU / (16 + 2 * TWBR * 4^PS). Rates are rounded down
+// (never exceeding the target) using the smallest prescaler that fits TWBR,
+// constexpr so that constant targets cost nothing at run time.
+#ifndef TWM_CORE_CLK
+#ifdef F_CPU
+#define TWM_CORE_CLK F_CPU
+#else
+#define TWM_CORE_CLK 16000000UL
+#endif
+#endif
+#ifndef TWM_SCL_MAX // Fast mode, define 1000000 for fast mode plus where pins/devices allow
+#define TWM_SCL_MAX 400000UL
+#endif
+
+struct Rate { uint8_t br, ps; }; // TWBR & prescaler select (0..3, 0xFF -> bus default)
+
+#define TWM_RATE_DEFAULT TWM::Rate{0, 0xFF}
+
+constexpr uint32_t ratioFor (const uint32_t fC, const uint32_t fS) { return((fC + fS - 1) / fS); } // ceil
+constexpr uint32_t brFor (const uint32_t d, const uint8_t ps) { return((d <= 16) ? 0 : (d - 16 + (2U << (2*ps)) - 1) / (2U << (2*ps))); } // ceil
+constexpr uint8_t psFor (const uint32_t d, const uint8_t ps=0) { return(((ps < 3) && (brFor(d,ps) > 0xFF)) ? psFor(d, ps+1) : ps); }
+constexpr uint8_t brClamp (const uint32_t br) { return((br > 0xFF) ? 0xFF : br); }
+constexpr Rate planD (const uint32_t d) { return Rate{ brClamp(brFor(d, psFor(d))), psFor(d) }; }
+constexpr Rate plan (const uint32_t fS, const uint32_t fC=TWM_CORE_CLK)
+   { return planD(ratioFor(fC, (fS > TWM_SCL_MAX) ? TWM_SCL_MAX : ((fS > 0) ? fS : 1))); }
+constexpr uint32_t cycles (const Rate r) { return(16 + ((uint32_t)r.br << (1 + 2 * (r.ps & 0x3)))); } // core clocks per SCL
+constexpr uint32_t sclHz (const Rate r, const uint32_t fC=TWM_CORE_CLK) { return(fC / cycles(r)); }
+
+inline bool operator== (const Rate a, const Rate b) { return((a.br == b.br) && (a.ps == b.ps)); }
+
 enum StateFlag : uint8_t {
    LOCK=0x01, START=0x02,
    ADDR=0x04, AACK=0x08,
-   SACK=0x10, RACK=0x20
+   SACK=0x10, RACK=0x20,
+   VFAIL=0x40 // verify failed
 };
 enum CountId : uint8_t { NOUT, NIN, NVER, NUM };
 
@@ -40,48 +75,93 @@ enum FragMode : uint8_t {
    RESTART= 0x80
 };
 
+inline FragMode operator| (const FragMode a, const FragMode b) { return((FragMode)((uint8_t)a | (uint8_t)b)); }
+
 struct Frag { uint8_t *pB, nB; FragMode m; };
 
-// Buffer management
-#define BUFF_FRAG_MAX 2
+// Transactions: a device address and a fragment list of any length (each
+// fragment following in the same direction continues the transfer, a change of
+// direction or RESTART flag is preceded by a repeated start). Descriptors,
+// fragment lists and buffers are owned by the caller and must persist until
+// complete. Queued transactions are chained by the ISR through repeated start,
+// the bus being released only when the queue empties (or on failure).
+enum TransState : int8_t { FREE, QUEUED, ACTIVE, DONE, FAIL };
+
+struct Trans;
+typedef void (*DoneFunc) (Trans&);
+
+struct Trans
+{
+   Frag *pF;
+   Rate rate;           // per device clock, bus default if ps invalid
+   uint8_t nF, devAddr;
+   uint8_t nX, nV;      // result: bytes transferred & verified
+   volatile int8_t state;
+   DoneFunc done;       // completion callback (ISR context) may post another
+   void *ctx;           // for use by callback
+
+   Trans (void) : pF{NULL}, rate(TWM_RATE_DEFAULT), nF{0}, devAddr{0}, nX{0}, nV{0}, state{FREE}, done{NULL}, ctx{NULL} { ; }
+
+   void set (const uint8_t a, Frag f[], const uint8_t n, const Rate r=TWM_RATE_DEFAULT) { devAddr= a; pF= f; nF= n; rate= r; }
+
+   bool busy (void) const { return((QUEUED == state) || (ACTIVE == state)); }
+}; // struct Trans
+
+#ifndef TWM_QUEUE_MAX
+#define TWM_QUEUE_MAX 4 // power of 2
+#endif
+
+// Single producer (main loop or callback) single consumer (ISR) ring of descriptor pointers
+class Ring
+{
+protected:
+   Trans *q[TWM_QUEUE_MAX];
+   volatile uint8_t iW, iR;
+
+   bool push (Trans *p)
+   {
+      if (queued() >= TWM_QUEUE_MAX) { return(false); }
+      q[iW & (TWM_QUEUE_MAX-1)]= p;
+      iW++;
+      return(true);
+   } // push
+
+   Trans *front (void) const { if (queued() > 0) { return q[iR & (TWM_QUEUE_MAX-1)]; } return(NULL); }
+
+   void pop (void) { if (queued() > 0) { iR++; } }
+
+public:
+   Ring (void) : iW{0}, iR{0} { ; }
+
+   uint8_t queued (void) const { return(iW - iR); }
+}; // class Ring
+
+// Fragment traversal of the active transaction
 class Buffer // NB: includes interface properties
 {
 protected:
    volatile uint8_t state, count[3];//, dR;
    uint8_t hwAddr;
    uint8_t nF, iF, iB;
-   Frag frag[BUFF_FRAG_MAX]; // Consider: factor out?
+   Frag *frag;
 
-   FragMode getMode (uint8_t m=RWVM) { return(m & frag[iF].m); }
-
-   bool lock (void)
-   {
-      bool r= sync();
-      if (r) { state= LOCK; }
-      return(r);
-   } // lock
-
-   void unlock (void) { state&= ~LOCK; }
+   FragMode getMode (uint8_t m=RWVM) const { return((FragMode)(m & frag[iF].m)); }
 
    void setAddr (const uint8_t devAddr) { hwAddr= devAddr << 1; }
 
    void resetFrags (void) { iF=0; iB=0; }
 
-   void clearAll (void)
+   void load (const Trans& t)
    {
-      nF=0;
+      state= LOCK;
+      setAddr(t.devAddr);
+      frag= t.pF;
+      nF= t.nF;
       resetFrags();
       for (int8_t i=0; i < CountId::NUM; i++) { count[i]= 0; }
-   } // clearAll
+   } // load
 
-   void addFrag (uint8_t b[], const uint8_t n, const FragMode m)
-   {
-      if (nF >= BUFF_FRAG_MAX) { return; }
-      frag[nF].pB= b;
-      frag[nF].nB= n;
-      frag[nF].m=  m;
-      nF++;
-   } // addFrag
+   void unlock (void) { state&= ~LOCK; }
 
    bool nextFragValid (uint8_t i) const { return(((i+1) < nF) && (frag[i+1].nB > 0)); }
    uint8_t nextFrag (void)
@@ -95,7 +175,11 @@ protected:
       return(0);
    }
 
-   bool continuation (uint8_t i) const { return( nextFragValid(i) && ((READ & frag[i].m) == (READ & frag[i+1].m)) ); }
+   // Next fragment continues the transfer: same direction and no RESTART
+   bool continuation (uint8_t i) const
+   {
+      return( nextFragValid(i) && (0 == (RESTART & frag[i+1].m)) && ((READ & frag[i].m) == (READ & frag[i+1].m)) );
+   } // continuation
 
    uint8_t& next (void)
    {
@@ -121,18 +205,23 @@ protected:
       {
          case FragMode::READ : next()= b; return(true);
          case FragMode::VERA : count[NVER]+= (b == next()); return(true);
-         case FragMode::VERF : if (b == next()) { count[NVER]++; return(true); } break;
+         case FragMode::VERF : // NB: byte following failure (NACKed) is not verified
+            if ((0 == (state & VFAIL)) && (b == next())) { count[NVER]++; return(true); }
+            state|= VFAIL;
+            break;
          //case FragMode::WRITE : return(false);
+         default : break;
       }
       return(false);
    } // incoming
 
 public:
-   Buffer (void) : state{0} { ; }
+   Buffer (void) : state{0}, nF{0}, frag{NULL} { ; }
 
    uint8_t getHWAddr (void) const { return(hwAddr| getMode(FragMode::READ)); }
 
-   bool sync (void) const { return(LOCK != (LOCK & state)); }
+   // Bus idle (queue empty)
+   bool idle (void) const { return(LOCK != (LOCK & state)); }
 
    uint8_t remaining (bool lazy=true) const
    {
@@ -162,6 +251,18 @@ public:
 class HWRC
 {
 protected:
+   Rate rDef, rCur; // bus default & present
+
+   // Effective rate of transaction, true if registers changed
+   bool apply (const Rate r)
+   {
+      const Rate e= (r.ps > 3) ? rDef : r;
+      if (e == rCur) { return(false); }
+      TWSR= e.ps; // status bits not writable
+      TWBR= e.br;
+      rCur= e;
+      return(true);
+   } // apply
 
    void start (void) { TWCR= _BV(TWINT) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA); }
 
@@ -180,17 +281,18 @@ protected:
    uint8_t recv (void) { return(TWDR); }
 
 public:
+   HWRC (void) : rDef{CLK_100, 0}, rCur{0, 0xFF} { ; }
 
-   void setClkT (ClkTok t)
-   {
-      //TWSR&= ~0x3; // unnecessary, status bits not writable anyway
-      TWSR= 0x00; // clear PS1&0 so clock prescale= 1 (high speed)
-      TWBR= t;
-   } // set
+   // Bus default rate (for transactions without their own)
+   void setRate (const Rate r) { rDef= r; apply(r); }
+   void setRate (const uint32_t fHz) { setRate(plan(fHz)); }
+   Rate getRate (void) const { return(rDef); }
+
+   void setClkT (ClkTok t) { setRate(Rate{t, 0}); } // clear PS1&0 so clock prescale= 1 (high speed)
 
-   ClkTok getClkT (void) { return(TWBR); }
+   ClkTok getClkT (void) { return((ClkTok)TWBR); }
 
-   void setClkPS (uint8_t s) { TWSR= s; } // & 0x3 (unnecessary)
+   void setClkPS (uint8_t s) { rDef.ps= s & 0x3; apply(rDef); }
 
    uint8_t getClkPS (void) { return(TWSR & 0x3); } // 0,1,2,3 -> 1,4,16,64
 
@@ -198,30 +300,79 @@ public:
 
 //class CCommonTWAS; // forward decl.
 
-class ISR : public HWRC, public Buffer
+class ISR : public HWRC, public Buffer, public Ring
 {
 private:
    void reply (bool accept=true) { if (accept && Buffer::notLast()) { HWRC::ack(); } else { HWRC::nack(); } }
 
    void send (void) { HWRC::send( Buffer::outgoing() ); }
 
-protected:
+   // Load front of queue: 0 if empty (bus to be released), 2 if clock rate changed
+   // (NB: applies from the stop of the stop-start used to change), else 1
+   uint8_t activate (void)
+   {
+      Trans *p= front();
+      if (NULL == p) { Buffer::unlock(); return(0); }
+      p->state= ACTIVE;
+      load(*p);
+      return(1 + HWRC::apply(p->rate));
+   } // activate
+
+   // Complete active transaction, non zero if another follows (as activate)
+   uint8_t finish (const int8_t r)
+   {
+      Trans *p= front();
+      if (p)
+      {
+         p->nX= count[NOUT] + count[NIN];
+         p->nV= count[NVER];
+         p->state= r;
+         pop();
+         nDone++;
+         nFail+= (FAIL == r);
+         if (p->done) { p->done(*p); }
+      }
+      return activate();
+   } // finish
 
-   bool beginTransfer (const uint8_t devAddr)
+   // Fragment exhausted: next fragment, else next transaction, else release bus
+   void advance (void)
    {
-      if (lock())
+      switch(nextFrag())
       {
-         clearAll();
-         setAddr(devAddr);
-         return(true);
+         case 2 : HWRC::restart(); break;
+         case 1 : HWRC::start(); break; // repeated start
+         default :
+            switch(finish(DONE))
+            {
+               case 2 : HWRC::restart(); break; // stop-start at new rate
+               case 1 : HWRC::start(); break; // repeated start of next
+               default : HWRC::stop(); break;
+            }
+            break;
       }
-      return(false);
-   } // beginTransfer
+   } // advance
 
 public:
-   //ISR (void) { HWRC::setClk(CLK_100); }
+   uint16_t nDone, nFail;
+
+   ISR (void) : nDone{0}, nFail{0} { ; }
    //~ISR (void) { HWRC::halt(); }
 
+   // Queue transaction, starting bus if idle. Returns immediately, false if queue full.
+   bool post (Trans& t)
+   {
+      if ((NULL == t.pF) || (0 == t.nF)) { return(false); }
+      const uint8_t s= SREG;
+      cli();
+      t.state= QUEUED;
+      const bool r= push(&t);
+      if (!r) { t.state= FREE; }
+      else if (idle() && activate()) { HWRC::start(); } // NB: no ISR pending when idle
+      SREG= s;
+      return(r);
+   } // post
+
 #define SZ(i,v)  if (0 == i) { i= v; }
 
    int8_t event (const uint8_t flags)
@@ -240,15 +391,7 @@ public:
                send();
                HWRC::nack();
             }
-            else switch(nextFrag())
-            {
-               case 2 : HWRC::restart(); break;
-               case 1 : HWRC::start(); break; // repeated start or restart ?
-               default :
-                  HWRC::stop();
-                  Buffer::unlock();
-                  break;
-            }
+            else { advance(); }
             break;
 
          case TW_START: SZ(iE,4);
@@ -264,13 +407,16 @@ public:
             break;
 
          case TW_MR_DATA_NACK: SZ(iE,7);
-            Buffer::incoming(HWRC::recv()); // fall through stop(); unlock(); break;
+            Buffer::incoming(HWRC::recv()); // last byte of read fragment
+            advance();
+            break;
+
          case TW_MR_SLA_NACK: SZ(iE,8);
          case TW_MT_SLA_NACK: SZ(iE,9);
          case TW_MT_DATA_NACK: SZ(iE,10);
          default: SZ(iE,11);
-            HWRC::stop();
-            Buffer::unlock();
+            if (finish(FAIL)) { HWRC::restart(); } // stop then start next
+            else { HWRC::stop(); }
             break;
       }
       return(iE);
@@ -278,8 +424,29 @@ public:
 
 }; // class ISR
 
+#define BUFF_FRAG_MAX 2
 class TransferAS : public ISR
 {
+protected:
+   Trans lt; // for transfer1AS/transfer2AS
+   Frag lf[BUFF_FRAG_MAX];
+
+   bool beginTransfer (const uint8_t devAddr)
+   {
+      if (lt.busy()) { return(false); }
+      lt.set(devAddr, lf, 0);
+      return(true);
+   } // beginTransfer
+
+   void addFrag (uint8_t b[], const uint8_t n, const FragMode m)
+   {
+      if (lt.nF >= BUFF_FRAG_MAX) { return; }
+      lf[lt.nF].pB= b;
+      lf[lt.nF].nB= n;
+      lf[lt.nF].m=  m;
+      lt.nF++;
+   } // addFrag
+
 public:
    //TransferAS (ClkTok t=CLK_100) { setClkT(t); }
 
@@ -292,19 +459,23 @@ public:
    void begin (uint8_t dummyHWAddr=0x00) { setClkT(CLK_100); }
    bool end (bool syn=true)
    {
-      if (syn && !sync()) { return(false); }
+      if (syn && !idle()) { return(false); }
       //else
       HWRC::halt();
       return(true);
    } // end
 
+   // Single/double fragment transfer complete (or failed)
+   bool sync (void) const { return(!lt.busy()); }
+
+   bool failed (void) const { return(FAIL == lt.state); }
+
    int transfer1AS (const uint8_t devAddr, uint8_t b[], const uint8_t n, const FragMode m)
    {
       if (beginTransfer(devAddr))
       {
          addFrag(b, n, m);
-         start();
-         return(n);
+         if (post(lt)) { return(n); }
       }
       return(0);
     } // transfer1AS
@@ -321,45 +492,48 @@ public:
       {
          addFrag(b1, n1, m1);
          addFrag(b2, n2, m2);
-         start();
-         return(n1+n2);
+         if (post(lt)) { return(n1+n2); }
       }
       return(0);
     } // transfer2AS
 
 }; // class TransferAS
 
-// Debug extension
+// Debug extension: binary event trace (TWTrace.hpp), stamped on ISR entry
 class Debug : public TransferAS
 {
+protected:
+   CFastPollTimer tmr;
+
 public:
-   uint8_t evQ[64];
-   uint8_t stQ[8];
-   int8_t iEQ, iSQ;
+   TWT::Ring trace;
 
-   TWDebug (void) { clrEv(); }
+   Debug (void) { ; }
 
-   void clrEv (void) { iEQ= 0; iSQ=0; }
+   void clrEv (void) { trace.clear(); }
 
    int8_t event (const uint8_t flags)
    {
+      const uint16_t t= tmr.stamp();
       const int8_t iE= ISR::event(flags);
-      if (iSQ < sizeof(stQ)) { stQ[iSQ++]= Buffer::state; }
-      if (iEQ < sizeof(evQ)) { evQ[iEQ++]= iE; }
+      trace.event(t, flags, queued(), Buffer::state);
       return(iE);
    } // event
 
-   void logEv (Stream& s, const uint8_t sf=0xFE) const
+   // Drain pending records to binary frames (out of band), returns records
+   uint8_t sendEv (Stream& s, CSerMux& mux, const uint8_t epid) { return trace.drain(s, mux, epid); }
+
+   // Drain pending records as text (slow)
+   void logEv (Stream& s)
    {
-      //s.print("dR="); s.println(dR);
-      s.print("SQ:");
-      for (int8_t i=0; i<iSQ; i++) { s.print(" 0x"); s.print(stQ[i] & sf, HEX); }
-      s.print("\nEQ:");
-      for (int8_t i=0; i<iEQ; i++) { s.print(' '); s.print(evQ[i]); }
-      s.print("\nCounts:");
+      TWT::Rec d[4];
+      TWT::Decoder dec;
+      uint8_t n;
+      while ((n= trace.get(d, 4)) > 0) { dec.print(s, (const uint8_t*)d, n * sizeof(TWT::Rec)); }
+      s.print("Counts:");
       for (int8_t i=0; i < TWM::NUM; i++) { s.print(' '); s.print(count[i]); }
       s.println();
-   } // log
+   } // logEv
 
 }; // class Debug
 
@@ -381,32 +555,36 @@ SIGNAL(TWI_vect)
 
 // Now basic functionality provided by accessability layer,
 // stateless hence easily inheritable by device drivers
+// NB: refers to gTWM directly, I2C may name another transport (host build)
 class CCommonTWAS
 {
 public:
    CCommonTWAS (void) { ; }
 
+   // Queue transaction and continue: check t.state (or use t.done) for completion
+   bool postAS (TWM::Trans& t) { return gTWM.post(t); }
+
    int readFromAS (const uint8_t devAddr, uint8_t b[], const int n)
    {
-      if (n > 0) { return I2C.transfer1AS(devAddr, b, n, TWM::READ); }
+      if (n > 0) { return gTWM.transfer1AS(devAddr, b, n, TWM::READ); }
       else return(0);
    } // readFromAS
 
    int writeToAS (const uint8_t devAddr, const uint8_t b[], const int n)
    {
-      if (n > 0) { return I2C.transfer1AS(devAddr, b, n, TWM::WRITE); }
+      if (n > 0) { return gTWM.transfer1AS(devAddr, (uint8_t*)b, n, TWM::WRITE); }
       else return(0);
    } // writeToAS
 
    int readFromRevAS (const uint8_t devAddr, uint8_t b[], const int n)
    {
-      if (n > 0) { return I2C.transfer1AS(devAddr, b, n, TWM::REV|TWM::READ); }
+      if (n > 0) { return gTWM.transfer1AS(devAddr, b, n, TWM::REV|TWM::READ); }
       else return(0);
    } // readFromRevAS
 
    int writeToRevAS (const uint8_t devAddr, const uint8_t b[], const int n)
    {
-      if (n > 0) { return I2C.transfer1AS(devAddr, b, n, TWM::REV|TWM::WRITE); }
+      if (n > 0) { return gTWM.transfer1AS(devAddr, (uint8_t*)b, n, TWM::REV|TWM::WRITE); }
       else return(0);
    } // writeToRevAS
 
@@ -415,7 +593,7 @@ public:
    {
       if ((nRev > 0) && (nFwd > 0))
       {
-         return I2C.transfer2AS(devAddr, bRev, nRev, TWM::REV|TWM::WRITE, bFwd, nFwd, TWM::WRITE);
+         return gTWM.transfer2AS(devAddr, (uint8_t*)bRev, nRev, TWM::REV|TWM::WRITE, (uint8_t*)bFwd, nFwd, TWM::WRITE);
       }
       else return(0);
    } // writeToRevThenFwdAS
@@ -2,7 +2,7 @@
 // code, C++ classes.
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Mar-May 2022
+// (c) Project Contributors Mar 2022 - Oct 2026
 
 #ifndef DA_TWUTIL_HPP
 #define DA_TWUTIL_HPP
@@ -21,56 +21,21 @@ namespace TWUtil {
 class CClk
 {
 protected:
-   uint8_t getBT0 (uint8_t r)
-   {
-      switch(r)
-      {
-         case TWM::CLK_400 : return(23); // 22.5us
-         case TWM::CLK_100 : return(90);
-         default :
-         {
-            uint8_t n= r / TWM::CLK_400;
-            return( (22 * n) + (n / 2) + (n & 0x1) ); // = (22.5 * n) + 0.5
-         }
-      }
-   } // getBT0
-
+   // Byte time (9 SCL periods) of bus default rate, in microseconds (saturating)
    uint8_t getBT (void)
    {
-      uint8_t t0= getBT0(I2C.getClkT());
-      switch (I2C.getClkPS())
-      {
-         case 0x00 : return(t0);
-         case 0x01 : return(4*t0);
-         // others hopelessly slow...
-         //case 0x02 : return(16*t0); // >= 360us per byte
-         //case 0x03 : return(64*t0); // >= 1.44ms per byte
-      }
-      return(250); // just a hack...
-   } // setBT
+      const uint32_t t= (9 * TWM::cycles(I2C.getRate()) + (CORE_CLK / 1000000) - 1) / (CORE_CLK / 1000000); // NB: constant divisor
+      return((t > 250) ? 250 : t);
+   } // getBT
 
 public:
 
-   // General clock rate quert/change, inefficient for regular use on AVR
-   // due (sloooow) software division.
+   // General clock rate query/change (planned for CORE_CLK, never exceeding the
+   // target), inefficient for regular use on AVR due (sloooow) software division.
    uint32_t getSet (uint32_t fHz=0)
    {
-      uint32_t sc= 0;
-      if (fHz > 0)
-      {
-         if (fHz >= 100000) { I2C.setClkPS(0x00); sc= CORE_CLK; }
-         else if (fHz >= 475)
-         {
-            I2C.setClkPS(0x03);
-            sc= CORE_CLK / 64;
-         }
-         if (sc > 0)
-         {  //s.print(" -> "); s.print(TWBR,HEX); s.print(','); s.println(TWSR,HEX); TWBR=
-            uint8_t t= ((sc / fHz) - 16) / 2;
-            I2C.setClkT(t);
-         }
-      } else { sc= CORE_CLK / (1 << (4 * I2C.getClkPS())); }
-      return(sc / ((I2C.getClkT() * 2) + 16));
+      if (fHz > 0) { I2C.setRate(TWM::plan(fHz, CORE_CLK)); }
+      return TWM::sclHz(I2C.getRate(), CORE_CLK);
    } // getSet
 
 }; // class CClk
@@ -122,7 +87,7 @@ protected:
       do
       {
          r= I2C.transfer1AS(devAddr,b,n,m);
-         sync(-1);
+         if (sync(-1) && I2C.failed()) { r= -1; } // NACK (e.g. EEPROM write cycle)
       } while ((r <= 0) && (t-- > 0));
       return(r);
    } // transfer1
@@ -139,7 +104,7 @@ protected:
       do
       {
          r= I2C.transfer2AS(devAddr,b1,n1,m1,b2,n2,m2);
-         sync(-1);
+         if (sync(-1) && I2C.failed()) { r= -1; }
       } while ((r <= 0) && (t-- > 0));
       return(r);
    } // transfer1
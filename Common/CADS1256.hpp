@@ -1,7 +1,7 @@
 // Duino/Common/CADS1256.hpp - 'Duino high precison ADC
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Nov 2021
+// (c) Project Contributors Nov 2021 - Oct 2026
 
 #ifndef CADS1256_HPP
 #define CADS1256_HPP
@@ -106,7 +106,7 @@ protected:
 }; // CADS1256Signal
 
 
-class CADS1256SPI : CCommonSPI, public CADS1256Signal
+class CADS1256SPI : CCommonSPIX1, public CADS1256Signal
 {
 public:
    CADS1256SPI (uint8_t clk_hk=0) : CADS1256Signal() { init(clk_hk); }
@@ -124,6 +124,47 @@ public:
 
    void close (void) { CCommonSPI::end(); } // hsm= 0x00; }
 
+   // Enter read data continuous mode (call when ready), first sample to vB (as readData)
+   int8_t readContinuous (uint8_t vB[3])
+   {
+      start();
+      HSPI.transfer(ADS1256::RDATAC);
+      syncRead();
+      readRev(vB,3);
+      complete();
+      return(3);
+   } // readContinuous
+
+   void stopContinuous (void) { cmd(ADS1256::SDATAC); }
+
+   // Big-endian sample (as received by queued read) to 24b value (as read24b)
+   static uint32_t raw24 (const uint8_t be[3]) { return(((uint32_t)be[0] << 16) | ((uint16_t)be[1] << 8) | be[2]); }
+
+#ifdef SPI_TRANSQ_HPP
+   // Queued access: descriptor & buffer must persist until t.state == DONE. Only
+   // transactions without the t6 delay between command & data are queued: a read
+   // in continuous mode (submit when ready, vB big-endian) and register writes.
+   bool readContinuousAS (SPIQ::Sched& q, SPIQ::Trans& t, uint8_t vB[3])
+   {
+      t.pS= &spiSet;
+      t.pin= PIN_NCS;
+      t.nC= 0;
+      t.data(NULL, vB, 3, 0xAA);
+      return q.submit(t);
+   } // readContinuousAS
+
+   bool writeRegAS (SPIQ::Sched& q, SPIQ::Trans& t, ADS1256::Reg reg, const uint8_t vB[], const uint8_t nB)
+   {
+      const uint8_t c[2]= { (uint8_t)(ADS1256::WRITER|reg), (uint8_t)(nB-1) };
+      if ((nB < 1) || (nB > 16)) { return(false); }
+      t.pS= &spiSet;
+      t.pin= PIN_NCS;
+      t.cmd(c, 2);
+      t.data(vB, NULL, nB);
+      return q.submit(t);
+   } // writeRegAS
+#endif // SPI_TRANSQ_HPP
+
 protected:
    // NB: Delay of 50 CLKIN cycles (CLKIN typically 7.68MHz) required in
    // read operations. Allow 10us (rather than 6.5us) as a safety margin.
@@ -1,7 +1,7 @@
 // Duino/Common/CAT24C.hpp - class wrapper for Atmel I2C EEPROM
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Mar 2022
+// (c) Project Contributors Mar 2022 - Oct 2026
 
 #ifndef CAT24C_HPP
 #define CAT24C_HPP
@@ -18,8 +18,20 @@
 namespace AT24CHW
 {
   enum Device : uint8_t { BASE_ADDR=0x50 }; // NB: 7msb -> 0xA0|RNW on wire
+  enum Page : uint8_t { PAGE_BYTES=32, PAGE_SHIFT=5 };
 }; // namespace AT24CHW
 
+#ifndef CAT24C_XFER_MAX
+#if defined(ARDUINO_ARCH_AVR) || !defined(BUFFER_LENGTH)
+#define CAT24C_XFER_MAX AT24CHW::PAGE_BYTES // data bytes per write transaction
+#else
+#define CAT24C_XFER_MAX (BUFFER_LENGTH-2) // Wire buffer less word address
+#endif
+#endif
+#ifndef CAT24C_CYCLE_MS
+#define CAT24C_CYCLE_MS 10 // write cycle timeout (5ms typ.)
+#endif
+
 #ifndef UU16
 extern "C" { typedef union {uint16_t u16; uint8_t u8[2]; } UU16; }
 #endif
@@ -31,19 +43,24 @@ protected:
 
    int setAddr (const UU16 a) { return writeToRev(devAddr(), a.u8, 2); }
 
-   uint16_t pageAddr (uint8_t pageNum) { return(pageNum<<5); }
+   uint16_t pageAddr (uint16_t pageNum) { return(pageNum<<AT24CHW::PAGE_SHIFT); }
 
    int setPageAddr (uint8_t page) { UU16 a; a.u16= pageAddr(page); return setAddr(a); }
 
 public:
    CAT24C (void) { ; }
 
+   int readAddr (const UU16 a, uint8_t b[], int n)
+   {
+      int r= writeToRevThenReadFromFwd(devAddr(), a.u8, sizeof(a), b, n);
+      if (r >= n) { return(n); } else { return(0); }
+   } // readAddr
+
    int readPage (const uint8_t page, uint8_t b[], int n)
    {
 #if 1
       UU16 a= { pageAddr(page) };
-      int r= writeToRevThenReadFromFwd(devAddr(), a.u8, sizeof(a), b, n);
-      if (r >= n) { return(n); } else { return(0); }
+      return readAddr(a,b,n);
 #else
       int r= setPageAddr(page);
       if (r > 0) { r= readFrom(devAddr(), b, n); }
@@ -56,7 +73,20 @@ public:
       return(writeToRevThenFwd(devAddr(), a.u8, 2, b, n) - 2);
    } // writeAddr
 
-   bool sync (void) { delay(10); return(true); }
+   // Device acknowledges its address (no write cycle in progress). NB: the address
+   // write sets the word pointer only, no data -> no write cycle.
+   bool ready (void) { UU16 a={0}; return(setAddr(a) > 0); }
+
+   // ACK polling: wait for write cycle completion (or timeout)
+   bool sync (const uint8_t ms=CAT24C_CYCLE_MS)
+   {
+      const uint16_t t0= millis();
+      do
+      {
+         if (ready()) { return(true); }
+      } while ((uint16_t)(millis() - t0) < ms);
+      return(false);
+   } // sync
 
    int writePage (const uint8_t page, const uint8_t b[], int n)
    {
@@ -79,4 +109,176 @@ public:
 
 }; // class CAT24C
 
+#ifndef CAT24C_CACHE_PAGES
+#define CAT24C_CACHE_PAGES 4 // NB: 41 bytes RAM each
+#endif
+
+// Write-back cache of whole pages: write() compares against cached contents so that
+// only changed bytes become dirty; each dirty page is then written by a single
+// transaction spanning its first to last dirty byte (one write cycle) rather than one
+// per call. poll() from the main loop advances write back one step at a time: an
+// address probe (ACK polling) while the write cycle completes or the next page
+// write. Reads are served from the cache where present. Pages are allocated on write
+// (read from the device on miss), evicting the least recently used (clean first).
+class CAT24CCache : public CAT24C
+{
+protected:
+   struct Line
+   {
+      uint8_t b[AT24CHW::PAGE_BYTES];
+      uint32_t dirty; // byte mask
+      uint16_t page, used;
+      bool valid;
+   } line[CAT24C_CACHE_PAGES];
+   uint16_t tick;
+   bool busy; // write cycle (possibly) in progress
+
+   Line *find (const uint16_t page)
+   {
+      for (int i=0; i<CAT24C_CACHE_PAGES; i++) { if (line[i].valid && (page == line[i].page)) { return(line+i); } }
+      return(NULL);
+   } // find
+
+   // Least recently used dirty page (for write back) or, given any, any page (for eviction)
+   Line *oldest (const bool any)
+   {
+      Line *pL= NULL;
+      for (int i=0; i<CAT24C_CACHE_PAGES; i++)
+      {
+         Line& l= line[i];
+         if (!l.valid) { if (any) { return(&l); } else { continue; } }
+         if (!any && (0 == l.dirty)) { continue; }
+         if (pL && ((0 == pL->dirty) != (0 == l.dirty))) { if (0 == l.dirty) { pL= &l; } continue; } // prefer clean
+         if (!pL || ((uint16_t)(tick - l.used) > (uint16_t)(tick - pL->used))) { pL= &l; }
+      }
+      return(pL);
+   } // oldest
+
+   // Wait for device, true unless timeout
+   bool idle (void)
+   {
+      if (busy) { nPoll++; busy= !sync(); }
+      return(!busy);
+   } // idle
+
+   // Single write transaction of dirty span (from first dirty byte, up to transfer limit)
+   int writeBack (Line& l)
+   {
+      uint8_t i= 0, j= AT24CHW::PAGE_BYTES;
+      while (0 == (l.dirty & (1UL << i))) { ++i; }
+      while (0 == (l.dirty & (1UL << (j-1)))) { --j; }
+      if ((j - i) > CAT24C_XFER_MAX) { j= i + CAT24C_XFER_MAX; }
+      UU16 a= { (uint16_t)(pageAddr(l.page) + i) };
+      const int r= writeAddr(a, l.b+i, j-i);
+      if (r > 0)
+      {
+         for (uint8_t k= i; k < j; k++) { l.dirty&= ~(1UL << k); }
+         nWrite++;
+      }
+      busy= true; // NB: also after failure (NACK during unexpected cycle)
+      return(r);
+   } // writeBack
+
+   Line *load (const uint16_t page)
+   {
+      Line *pL= oldest(true);
+      while (0 != pL->dirty)
+      {  // evict
+         if (!idle() || (writeBack(*pL) <= 0)) { return(NULL); }
+      }
+      pL->valid= false;
+      UU16 a= { pageAddr(page) };
+      if (!idle() || (readAddr(a, pL->b, AT24CHW::PAGE_BYTES) < AT24CHW::PAGE_BYTES)) { return(NULL); }
+      pL->page= page;
+      pL->valid= true;
+      nLoad++;
+      return(pL);
+   } // load
+
+public:
+   uint16_t nWrite, nLoad, nPoll, nSkip; // write transactions, page reads, ACK polls, unchanged bytes
+
+   CAT24CCache (void) : tick{0}, busy{false}, nWrite{0}, nLoad{0}, nPoll{0}, nSkip{0}
+   {
+      for (int i=0; i<CAT24C_CACHE_PAGES; i++) { line[i].valid= false; line[i].dirty= 0; }
+   }
+
+   int read (const uint16_t a, uint8_t b[], const int n)
+   {
+      int i= 0;
+      while (i < n)
+      {
+         const uint16_t x= a + i, page= x >> AT24CHW::PAGE_SHIFT;
+         const uint8_t o= x & (AT24CHW::PAGE_BYTES-1);
+         const int m= min(n - i, AT24CHW::PAGE_BYTES - o);
+         Line *pL= find(page);
+         if (pL) { memcpy(b+i, pL->b+o, m); pL->used= tick++; }
+         else
+         {
+            UU16 u= { x };
+            if (!idle() || (readAddr(u, b+i, m) < m)) { break; }
+         }
+         i+= m;
+      }
+      return(i);
+   } // read
+
+   // Update cache, returns bytes accepted (< n when page could not be loaded)
+   int write (const uint16_t a, const uint8_t b[], const int n)
+   {
+      int i= 0;
+      while (i < n)
+      {
+         const uint16_t x= a + i, page= x >> AT24CHW::PAGE_SHIFT;
+         const uint8_t o= x & (AT24CHW::PAGE_BYTES-1);
+         const int m= min(n - i, AT24CHW::PAGE_BYTES - o);
+         Line *pL= find(page);
+         if (NULL == pL) { pL= load(page); }
+         if (NULL == pL) { break; }
+         for (uint8_t k= 0; k < m; k++)
+         {
+            if (pL->b[o+k] != b[i+k]) { pL->b[o+k]= b[i+k]; pL->dirty|= 1UL << (o+k); }
+            else { nSkip++; }
+         }
+         pL->used= tick++;
+         i+= m;
+      }
+      return(i);
+   } // write
+
+   uint8_t dirtyPages (void) const
+   {
+      uint8_t n= 0;
+      for (int i=0; i<CAT24C_CACHE_PAGES; i++) { n+= (0 != line[i].dirty); }
+      return(n);
+   } // dirtyPages
+
+   // Advance write back by one bus transaction, false when clean & idle
+   bool poll (void)
+   {
+      if (busy)
+      {
+         nPoll++;
+         if (!ready()) { return(true); }
+         busy= false;
+      }
+      Line *pL= oldest(false);
+      if (NULL == pL) { return(false); }
+      writeBack(*pL);
+      return(true);
+   } // poll
+
+   // Blocking write back of all dirty pages
+   bool flush (void)
+   {
+      Line *pL;
+      while (NULL != (pL= oldest(false)))
+      {
+         if (!idle() || (writeBack(*pL) <= 0)) { return(false); }
+      }
+      return idle();
+   } // flush
+
+}; // class CAT24CCache
+
 #endif // CAT24C_HPP
@@ -1,7 +1,7 @@
 // Duino/Common/CCommonSPI.hpp - 'Duino (Adafruit Wire) encapsulation of common I2C functionality.
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: GPL V3A
-// (c) Project Contributors Mar 2022
+// (c) Project Contributors Mar 2022 - Oct 2026
 
 #ifndef CCOMMON_I2C_HPP
 #define CCOMMON_I2C_HPP
@@ -59,6 +59,39 @@ public:
    // convenience wrapper
    int writeTo (const uint8_t devAddr, const uint8_t b) { return writeTo(devAddr, &b, 1); }
 
+   // Register address then data (single transaction)
+   int writeTo (const uint8_t devAddr, const uint8_t a, const uint8_t *p, const int n)
+   {
+      I2C.beginTransmission(devAddr);
+      I2C.write(a);
+      int m= 1 + write(p,n);
+      int r= I2C.endTransmission();
+      if (0 == r) { return(m); } //else
+      return(-r);
+   } // writeTo
+
+   // Register address then n copies of byte b
+   int writeToFill (const uint8_t devAddr, const uint8_t a, const uint8_t b, const int n)
+   {
+      I2C.beginTransmission(devAddr);
+      I2C.write(a);
+      for (int i=0; i<n; i++) { I2C.write(b); }
+      int r= I2C.endTransmission();
+      if (0 == r) { return(1+n); } //else
+      return(-r);
+   } // writeToFill
+
+   // Write (typically register address) then read, joined by repeated start
+   int writeToThenReadFrom (const uint8_t devAddr, const uint8_t bW[], const int nW, uint8_t bR[], int nR)
+   {
+      I2C.beginTransmission(devAddr);
+      int n= write(bW,nW);
+      int r= I2C.endTransmission(false);
+      if (0 != r) { return(-r); }
+      nR= I2C.requestFrom(devAddr,(uint8_t)nR);
+      return(n + read(bR,nR));
+   } // writeToThenReadFrom
+
 }; // CCommonI2C
 
 // Endian reversal extensions
@@ -100,6 +133,16 @@ public:
       return(-r);
    } // writeToRev
 
+   int writeToThenReadFromRev (const uint8_t devAddr, const uint8_t bW[], const int nW, uint8_t bR[], int nR)
+   {
+      I2C.beginTransmission(devAddr);
+      int n= write(bW,nW);
+      int r= I2C.endTransmission(false);
+      if (0 != r) { return(-r); }
+      nR= I2C.requestFrom(devAddr,(uint8_t)nR);
+      return(n + readRev(bR,nR));
+   } // writeToThenReadFromRev
+
    // Useful for transactions requiring big-endian address followed by arbitrary byte data
    int writeToRevThenFwd (const uint8_t devAddr, const uint8_t bR[], const int nR, const uint8_t bF[], const int nF)
    {
@@ -112,6 +155,17 @@ public:
       return(-r);
    } // writeToRevThenFwd
 
+   // Big-endian (register/memory) address then read
+   int writeToRevThenReadFromFwd (const uint8_t devAddr, const uint8_t bW[], const int nW, uint8_t bR[], int nR)
+   {
+      I2C.beginTransmission(devAddr);
+      int n= writeRev(bW,nW);
+      int r= I2C.endTransmission(false);
+      if (0 != r) { return(-r); }
+      nR= I2C.requestFrom(devAddr,(uint8_t)nR);
+      return(n + read(bR,nR));
+   } // writeToRevThenReadFromFwd
+
 }; // CCommonI2CX1
 
 
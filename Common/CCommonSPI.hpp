@@ -29,6 +29,20 @@
 #define SPI_CLOCK_DEFAULT 8
 #endif
 
+// Block transfer: a single core call per buffer avoids per-byte call overhead,
+// which exceeds the wire time at high clock rates. Below SPI_BLOCK_MIN bytes the
+// simple byte loop is used. Where the core offers only in-place transfer, TX-only
+// & reverse order writes are staged through a stack buffer of SPI_BLOCK_BYTES.
+#ifndef SPI_BLOCK_MIN
+#define SPI_BLOCK_MIN   4
+#endif
+#ifndef SPI_BLOCK_BYTES
+#define SPI_BLOCK_BYTES 32
+#endif
+#if defined(ARDUINO_ARCH_STM32F1) && !defined(SPI_BLOCK_GENERIC)
+#define SPI_BLOCK_DMA // libmaple dmaSend() / dmaTransfer()
+#endif
+
 // TODO: rethink device hard/soft state sbstraction...
 namespace Device
 {
@@ -122,25 +136,99 @@ protected:
    // Beware of sending "dummy" bytes for reading: some devices
    // may interpret certain bytes as a command causing eg. a reset
 
-   int read (uint8_t b[], const int n, const uint8_t w=0xAA)
+   // Per byte transfer loops
+   int readPB (uint8_t b[], const int n, const uint8_t w=0xAA)
    {
       int i;
       for (i=0; i<n; i++) { b[i]= HSPI.transfer(w); }
       return(i);
-   } // write
+   } // readPB
 
-   int writeb (const uint8_t b, const int n=1)
+   int writebPB (const uint8_t b, const int n=1)
    {
       int i= 0;
       for (; i<n; i++) { HSPI.transfer(b); }
       return(i);
-   } // writeb
+   } // writebPB
 
-   int write (const uint8_t b[], const int n)
+   int writePB (const uint8_t b[], const int n)
    {
       int i= 0;
       for (; i<n; i++) { HSPI.transfer(b[i]); }
       return(i);
+   } // writePB
+
+   // Block transfer primitives, whole buffer
+   // In-place read-write
+   void xferBlock (uint8_t b[], const int n)
+   {
+#ifdef SPI_BLOCK_DMA
+      HSPI.dmaTransfer(b,b,n); // TX always leads RX so in-place is safe
+#else
+      HSPI.transfer(b,n);
+#endif
+   } // xferBlock
+
+   // TX only, RX discarded
+   void writeBlock (const uint8_t b[], int n)
+   {
+#ifdef SPI_BLOCK_DMA
+      HSPI.dmaSend((void*)b,n); // NB: libmaple only reads the buffer (non-const param)
+#else
+      uint8_t t[SPI_BLOCK_BYTES];
+      while (n > 0)
+      {
+         const int m= min(n, SPI_BLOCK_BYTES);
+         memcpy(t,b,m);
+         HSPI.transfer(t,m);
+         b+= m; n-= m;
+      }
+#endif
+   } // writeBlock
+
+   // TX repeated byte, RX discarded
+   void writebBlock (const uint8_t w, int n)
+   {
+#ifdef SPI_BLOCK_DMA
+      HSPI.dmaSend((void*)&w,n,0); // no memory increment, NB: only read (non-const param)
+#else
+      uint8_t t[SPI_BLOCK_BYTES];
+      while (n > 0)
+      {
+         const int m= min(n, SPI_BLOCK_BYTES);
+         memset(t,w,m);
+         HSPI.transfer(t,m);
+         n-= m;
+      }
+#endif
+   } // writebBlock
+
+   // RX with fill byte
+   void readBlock (uint8_t b[], const int n, const uint8_t w=0xAA)
+   {
+      memset(b,w,n);
+      xferBlock(b,n);
+   } // readBlock
+
+   int read (uint8_t b[], const int n, const uint8_t w=0xAA)
+   {
+      if (n < SPI_BLOCK_MIN) { return readPB(b,n,w); }
+      readBlock(b,n,w);
+      return(n);
+   } // read
+
+   int writeb (const uint8_t b, const int n=1)
+   {
+      if (n < SPI_BLOCK_MIN) { return writebPB(b,n); }
+      writebBlock(b,n);
+      return(n);
+   } // writeb
+
+   int write (const uint8_t b[], const int n)
+   {
+      if (n < SPI_BLOCK_MIN) { return writePB(b,n); }
+      writeBlock(b,n);
+      return(n);
    } // write
 
 }; // CCommonSPI
@@ -189,7 +277,13 @@ public:
    {
       if (n <= 0) { return(0); }
       int i= n;
-      while (i-- > 0) { b[i]= HSPI.transfer(w); }
+      if (n < SPI_BLOCK_MIN) { while (i-- > 0) { b[i]= HSPI.transfer(w); } }
+      else
+      {  // read forward then reverse in place
+         int j= 0;
+         readBlock(b,n,w);
+         while (--i > j) { uint8_t t= b[i]; b[i]= b[j]; b[j++]= t; }
+      }
       return(n);
    } // readRev
 
@@ -197,7 +291,17 @@ public:
    {
       if (n <= 0) { return(0); }
       int i= n;
-      while (i-- > 0) { HSPI.transfer(b[i]); }
+      if (n < SPI_BLOCK_MIN) { while (i-- > 0) { HSPI.transfer(b[i]); } }
+      else
+      {  // stage reversed chunks
+         uint8_t t[SPI_BLOCK_BYTES];
+         while (i > 0)
+         {
+            int m= 0;
+            while ((i > 0) && (m < SPI_BLOCK_BYTES)) { t[m++]= b[--i]; }
+            xferBlock(t,m);
+         }
+      }
       return(n);
    } // writeRev
 
@@ -1,7 +1,7 @@
 // Duino/Common/CDS1307.hpp - class wrapper for Dallas basic RTC with battery backed storage
 // https://github.com/DrAl-HFS/Duino.git ?
 // Licence: GPL V3A
-// (c) Project Contributors Mar-May 2022
+// (c) Project Contributors Mar 2022 - Oct 2026
 
 #ifndef CDS1307_HPP
 #define CDS1307_HPP
@@ -39,16 +39,20 @@ protected:
    // if n=1 then seconds will be set.
    // 2) An extra byte is required to append the starting
    // register address (sent first due to order reversal).
-   int setDateTimeBCD (uint8_t ymdwhmsA[], int n=7)
+   // 3) <last> is the register of the rightmost byte: T_SS
+   // when the time is present, DOW (or D_DD) for date only.
+   int setDateTimeBCD (uint8_t ymdwhmsA[], int n=7, const uint8_t last=DS1307HW::T_SS)
    {
-      if ((0x7 & n) != n) { return(0); }
+      if (((0x7 & n) != n) || ((last + n) > DS1307HW::SQ_CTRL)) { return(0); }
       // Functionally elegant but programmatically obscure...
-      ymdwhmsA[n]= DS1307HW::SQ_CTRL-n; // starting register address
+      ymdwhmsA[n]= last; // starting register address
       return writeToRev(devAddr(), ymdwhmsA, n+1)-1;
    } // setDateTimeBCD
 
 public:
+#ifdef ARDUINO_ARCH_AVR
    using CClk::getSet;
+#endif
    //CDS1307 (void) { ; }
 
    int readTimeBCD (uint8_t hms[], int n=3)
@@ -141,7 +145,7 @@ public:
    int clearV (uint8_t a, uint8_t b, int n)
    {
       if (constrainA(a,n) < 0) { return(-1); }
-      writeToFill(devAddr(),a,b,n);
+      return writeToFill(devAddr(),a,b,n);
    } // clearV
 
    int adjustSec (const int dSec=1)
@@ -149,7 +153,7 @@ public:
       int r=0, s=0;
       if (0 != dSec)
       {
-         const uint8_t bcd[2]= { 0x00, 0 };
+         uint8_t bcd[2]= { 0x00, 0 };
          if (readTimeBCD(bcd,1))
          {
             s= fromBCD4(bcd[0],2);
@@ -167,9 +171,145 @@ public:
 
 }; // CDS1307Util
 
+#ifndef DS1307_RESYNC_MS
+#define DS1307_RESYNC_MS 60000
+#endif
+#define DS1307_DAY_MS 86400000UL
+
+// Time service: one burst read of the 7 time & date registers, thereafter time of
+// day interpolated from millis(). With the 1Hz square wave enabled (setSqCtrl(SQWE))
+// edge() called at each falling edge, which coincides with the seconds increment,
+// re-phases interpolation to the millisecond without bus traffic. Registers are
+// re-read at the resync interval (0 -> only on day roll over) to catch missed edges
+// & date changes. Without edges the phase is refined by each read (lagging < 1s).
+// Reported time of day never decreases, except on day roll over or setting.
+class CDS1307Time : public CDS1307Util
+{
+protected:
+   uint8_t reg[7];   // T_SS .. D_YY as last read (BCD)
+   uint32_t mB, tB;  // millis() at base & time of day (ms) at base
+   uint32_t mR, tS;  // millis() of last read (attempt) & second read (ms)
+   uint32_t tLast;   // last reported
+   bool valid, phased;
+
+   uint32_t interp (const uint32_t m) const { return(tB + (m - mB)); }
+
+   uint32_t secOfDay (void) const
+   {
+      uint8_t h= reg[DS1307HW::T_HH];
+      if (h & DS1307HW::T_HH_12H) { h= (fromBCD4(h & 0x1F, 2) % 12) + ((h & DS1307HW::T_HH_12H_PM) ? 12 : 0); }
+      else { h= fromBCD4(h & 0x3F, 2); }
+      return(fromBCD4(reg[DS1307HW::T_SS] & 0x7F, 2) + 60 * fromBCD4(reg[DS1307HW::T_MM], 2) + 3600UL * h);
+   } // secOfDay
+
+   // Burst read: keep interpolation within the second read, else rebase
+   bool resync (const uint32_t m)
+   {
+      uint8_t a= DS1307HW::T_SS;
+      const int r= writeToThenReadFrom(devAddr(), &a, 1, reg, sizeof(reg));
+      mR= m;
+      nRead++;
+      halted= (r > 1) && (reg[DS1307HW::T_SS] & DS1307HW::T_SS_STOP);
+      if ((r < (int)(1 + sizeof(reg))) || halted) { valid= false; return(false); }
+      const uint32_t t= 1000 * secOfDay(), i= interp(m);
+      tS= t;
+      if (valid && (i + 1000 > t) && (i < t + 2000))
+      {  // consistent: clamp to second read (drift correction)
+         if (i < t) { tB= t; } // lagging: forward
+         else if (i >= t + 1000) { tB= t + 999; phased= false; } // leading
+         else { tB= i; }
+      }
+      else
+      {
+         if (t < tLast) { tLast= 0; } // new day (or set)
+         tB= t; phased= false;
+      }
+      mB= m;
+      valid= true;
+      return(true);
+   } // resync
+
+   bool due (const uint32_t m) const
+   {
+      if (!valid) { return((m - mR) >= (halted ? resyncMs : 1000) || (0 == nRead)); }
+      return(((resyncMs > 0) && ((m - mR) >= resyncMs)) || (interp(m) >= DS1307_DAY_MS));
+   } // due
+
+   int setDateTimeBCD (uint8_t ymdwhmsA[], int n=7, const uint8_t last=DS1307HW::T_SS)
+   {
+      valid= false; tLast= 0; nRead= 0;
+      return CDS1307::setDateTimeBCD(ymdwhmsA, n, last);
+   } // setDateTimeBCD
+
+public:
+   uint32_t resyncMs;
+   uint16_t nRead, nEdge;
+   bool halted;
+
+   CDS1307Time (const uint32_t rs=DS1307_RESYNC_MS) : mB{0}, tB{0}, mR{0}, tS{0}, tLast{0}, valid{false}, phased{false},
+      resyncMs{rs}, nRead{0}, nEdge{0}, halted{false} { ; }
+
+   // Square wave falling edge (pin change ISR or poll): second boundary at millis() m
+   void edge (const uint32_t m=millis())
+   {
+      if (!valid) { return; }
+      const uint32_t i= interp(m);
+      uint32_t s= ((i + 999) / 1000) * 1000; // unphased: lagging, next boundary
+      if (!phased && ((m - mR) <= 1050)) { s= tS + 1000; } // first edge after read: exact
+      else if (phased)
+      {
+         s= ((i + 500) / 1000) * 1000; // nearest
+         if ((i + 250 < s) || (i > s + 250)) { return; } // spurious
+      }
+      if (s >= DS1307_DAY_MS) { return; } // resync pending
+      mB= m; tB= s;
+      phased= true;
+      nEdge++;
+   } // edge
+
+   bool isPhased (void) const { return(phased && valid); }
+
+   // Time of day in milliseconds (reading registers only when due), 0xFFFFFFFF if unavailable
+   uint32_t msOfDay (const uint32_t m=millis())
+   {
+      if (due(m)) { resync(m); }
+      if (!valid) { return(0xFFFFFFFF); }
+      uint32_t t= interp(m);
+      if (t >= DS1307_DAY_MS) { t= DS1307_DAY_MS - 1; } // until date read
+      if (t < tLast) { t= tLast; }
+      tLast= t;
+      return(t);
+   } // msOfDay
+
+   // As readTimeBCD (hours first) from time service: 3, -1 if clock halted, else 0
+   int timeBCD (uint8_t hms[3], uint16_t *pMS=NULL)
+   {
+      const uint32_t t= msOfDay();
+      if (!valid) { return(halted ? -1 : 0); }
+      uint32_t s= t / 1000;
+      if (pMS) { *pMS= t - 1000 * s; }
+      bcd4FromU8(hms+2, s % 60); s/= 60;
+      bcd4FromU8(hms+1, s % 60);
+      bcd4FromU8(hms+0, s / 60);
+      return(3);
+   } // timeBCD
+
+   // As readDateBCD (year first) from last register read
+   int dateBCD (uint8_t ymd[3])
+   {
+      msOfDay();
+      if (!valid) { return(0); }
+      for (int i=0; i<3; i++) { ymd[i]= reg[DS1307HW::D_YY-i]; }
+      return(3);
+   } // dateBCD
+
+   int adjustSec (const int dSec=1) { valid= false; return CDS1307Util::adjustSec(dSec); }
+
+}; // CDS1307Time
+
 // ASCII (debug) conversions
 #include "dateTimeUtil.hpp"
-class CDS1307A : public CDS1307Util
+class CDS1307A : public CDS1307Time
 {
 protected:
 
@@ -202,22 +342,19 @@ protected:
 public:
    //CDS1307 (void) { ; }
 
+   // From time service (bus read only when due), -1 if clock halted
    int printTime (Stream& s, const char end='\n')
    {
       uint8_t hms[3];
-      const int r= readTimeBCD(hms);
-      if (r > 2)
-      {
-         printTimeBCD(s,hms,end);
-         if (DS1307HW::T_SS_STOP == hms[r-1]) { return(-1); }
-      }
+      const int r= timeBCD(hms);
+      if (r > 2) { printTimeBCD(s,hms,end); }
       return(r);
    } // printTime
 
    int printDate (Stream& s, const char end='\n')
    {
       uint8_t ymd[3];
-      const int r= readDateBCD(ymd);
+      const int r= dateBCD(ymd);
       if (r > 2) { printDateBCD(s,ymd,end); }
       return(r);
    } // printTime
@@ -252,7 +389,7 @@ public:
             ymdwhmsA[3]= 1 + ((5 + sd) % 7); // NB: modulo works on *index* not number
          }
       }
-      if (n > 0) { ymdwhmsA[3]= consDOW(ymdwhmsA[3]); n++; }
+      if ((n > 0) || day) { ymdwhmsA[3]= consDOW(ymdwhmsA[3]); n++; }
       if (time)
       {
          bcd4FromTimeA(ymdwhmsA+4,time);
@@ -264,10 +401,10 @@ public:
          readTimeBCD(v,7);
          v[0]&= ~DS1307HW::T_SS_STOP;
          ymdwhmsA[7]= v[7]= 0;
-         r= strcmp(ymdwhmsA,v); // NB: potential for breakage by DOW...
+         r= strcmp((const char*)ymdwhmsA,(const char*)v); // NB: potential for breakage by DOW...
          /* r= sign((unsigned int)ymdwhmsA[i] - (unsigned int)v[i]);  */
       }
-      if (r > 0) { r= setDateTimeBCD(ymdwhmsA+o,n); }
+      if (r > 0) { r= setDateTimeBCD(ymdwhmsA+o, n, time ? DS1307HW::T_SS : DS1307HW::DOW); }
       return(r);
    } // setA
 
@@ -283,6 +420,7 @@ public:
       for (int i=0; i<4; i++) { s.print(ymd[i]); s.print(' '); }
       s.print("-> ");
       s.print(dYM[0]); s.print(' '); s.print(dYM[1]); s.print(' '); s.println(sd);
+      return(sd);
    }
 
    // -> debug
@@ -1,12 +1,14 @@
 // Duino/Common/CDS18.hpp - class wrapper for Dallas one wire temperature probe
 // https://github.com/DrAl-HFS/Duino.git ?
 // Licence: GPL V3A
-// (c) Project Contributors Jan 2022
+// (c) Project Contributors Jan 2022 - Oct 2026
 
 #ifndef CDS18_HPP
 #define CDS18_HPP
 
+#ifndef OneWire_h
 #include <OneWire.h>
+#endif
 
 #include "DN_Util.hpp"
 
@@ -18,14 +20,18 @@ void dumpHex (Stream& s, uint8_t b[], const int8_t n, const char *end=NULL)
 
 namespace DS18
 {
-   enum Cmd : uint8_t { START_CONV=0x44, READ_SCRATCH=0xBE };
-   enum ID : uint8_t { B20=0x28, };
+   enum Cmd : uint8_t { START_CONV=0x44, READ_SCRATCH=0xBE, WRITE_SCRATCH=0x4E, READ_POWER=0xB4 };
+   enum ID : uint8_t { S20=0x10, B20=0x28, B22=0x22 };
+   enum Res : uint8_t { R9, R10, R11, R12 }; // configuration register bits 6,5
+
+   // Conversion time (ms) 93.75 << (R - 9), rounded up
+   inline uint16_t convMs (const uint8_t r) { return((750 >> (3 - (r & 0x3))) + 1); }
 }; // namespace DS18
 
 class CDS18 : public OneWire
 {
 protected:
-  uint8_t id[8], c, f;
+  uint8_t id[8], f, c;
 
   bool rsw (uint8_t cmd)
   {
@@ -61,12 +67,153 @@ public:
   {
     rsw(DS18::READ_SCRATCH);
     OneWire::read_bytes(v,9);
-    if (OneWire::crc8(v, 8) == v[9]) { f|= 0x2; }
+    if (OneWire::crc8(v, 8) == v[8]) { f|= 0x2; }
     return((v[1] << 8) | v[0]);
   } // readRaw
 
 }; // CDS18
 
+#ifndef DS18_MAX_PROBES
+#define DS18_MAX_PROBES 16 // <= 32
+#endif
+
+// Many probes on one bus: ROM IDs (CRC valid, temperature families) are cached by
+// enumerate(). poll() from the main loop issues Convert T to all probes at once (skip
+// ROM), returns immediately until the conversion time of the configured resolution
+// (750ms if any DS18S20, which has no resolution setting) has elapsed, then reads
+// one scratchpad per call (match ROM, CRC8 checked) so that each call blocks for
+// ~12ms at most. A full set thus takes one conversion period plus the reads,
+// repeating no more often than periodMs.
+class CDS18Bus : public OneWire
+{
+protected:
+   enum Phase : uint8_t { IDLE, CONV, READ };
+
+   uint8_t rom[DS18_MAX_PROBES][8];
+   int16_t t16[DS18_MAX_PROBES]; // last valid reading, 1/16 C
+   uint32_t valid, tC; // probes read in last/current set, millis() at convert
+   uint8_t nP, iP, phase, res;
+   bool parasite, s20;
+
+   static bool known (const uint8_t family)
+   {
+      switch(family)
+      {
+         case DS18::S20 :
+         case DS18::B20 :
+         case DS18::B22 : return(true);
+      }
+      return(false);
+   } // known
+
+   bool readProbe (const uint8_t i)
+   {
+      uint8_t sp[9];
+      if (0 == OneWire::reset()) { return(false); }
+      OneWire::select(rom[i]);
+      OneWire::write(DS18::READ_SCRATCH);
+      OneWire::read_bytes(sp, 9);
+      if ((OneWire::crc8(sp, 8) != sp[8]) || (0xFF == (sp[4] & sp[5] & sp[7]))) { nCRC++; return(false); } // NB: absent -> all 1s
+      int16_t v= (sp[1] << 8) | sp[0];
+      if (DS18::S20 == rom[i][0]) { v= ((v & ~1) << 3) + 12 - sp[6]; } // extended resolution from count remain
+      else { v&= ~((1 << (3 - ((sp[4] >> 5) & 0x3))) - 1); } // undefined low bits
+      t16[i]= v;
+      return(true);
+   } // readProbe
+
+   // Configuration to one probe (id) or all (NULL)
+   bool writeConfig (const uint8_t *id, const DS18::Res r)
+   {
+      if (0 == OneWire::reset()) { return(false); }
+      if (id) { OneWire::select(id); } else { OneWire::skip(); }
+      OneWire::write(DS18::WRITE_SCRATCH);
+      OneWire::write(0x4B); OneWire::write(0x46);
+      OneWire::write((r << 5) | 0x1F);
+      return(true);
+   } // writeConfig
+
+   uint16_t convMs (void) const { return(DS18::convMs(s20 ? DS18::R12 : res)); }
+
+public:
+   uint16_t periodMs, nSet, nCRC;
+
+   CDS18Bus (uint8_t pin=8) : OneWire(pin), valid{0}, tC{0}, nP{0}, iP{0}, phase{IDLE}, res{DS18::R12}, parasite{false}, s20{false},
+      periodMs{0}, nSet{0}, nCRC{0} { ; }
+
+   // Search bus & cache ROM IDs, returns probes found
+   uint8_t enumerate (void)
+   {
+      nP= 0; phase= IDLE; valid= 0; s20= false;
+      OneWire::reset_search();
+      while ((nP < DS18_MAX_PROBES) && OneWire::search(rom[nP]))
+      {
+         if ((OneWire::crc8(rom[nP], 7) == rom[nP][7]) && known(rom[nP][0])) { s20|= (DS18::S20 == rom[nP][0]); nP++; }
+      }
+      if (OneWire::reset())
+      {  // any parasite powered probe needs strong pull up during conversion
+         OneWire::skip();
+         OneWire::write(DS18::READ_POWER);
+         parasite= (0 == OneWire::read_bit());
+      }
+      return(nP);
+   } // enumerate
+
+   // All probes (scratchpad only, not copied to EEPROM), TH & TL default. DS18S20
+   // (fixed resolution, two byte scratchpad write) are skipped: others are then
+   // addressed individually.
+   bool setResolution (const DS18::Res r)
+   {
+      bool ok= true;
+      res= r;
+      if (!s20) { return(writeConfig(NULL, r)); }
+      for (uint8_t i=0; i < nP; i++)
+      {
+         if (DS18::S20 != rom[i][0]) { ok&= writeConfig(rom[i], r); }
+      }
+      return(ok);
+   } // setResolution
+
+   // Advance pipeline by one bus step, true when a set has been completed
+   bool poll (const uint32_t m=millis())
+   {
+      switch(phase)
+      {
+         case IDLE :
+            if ((0 == nP) || ((nSet > 0) && ((m - tC) < periodMs))) { break; }
+            if (OneWire::reset())
+            {
+               OneWire::skip();
+               OneWire::write(DS18::START_CONV, parasite);
+               tC= m;
+               phase= CONV;
+            }
+            break;
+         case CONV :
+            if ((m - tC) < convMs()) { break; }
+            if (parasite) { OneWire::depower(); }
+            iP= 0; valid= 0;
+            phase= READ;
+            // fall through
+         case READ :
+            if (readProbe(iP)) { valid|= 1UL << iP; }
+            if (++iP >= nP) { phase= IDLE; nSet++; return(true); }
+            break;
+      }
+      return(false);
+   } // poll
+
+   uint8_t count (void) const { return(nP); }
+   const uint8_t *id (const uint8_t i) const { return(rom[i]); }
+
+   // Read in last completed (or current) set
+   bool isValid (const uint8_t i) const { return((valid >> i) & 0x1); }
+
+   // 1/16 C, last valid reading
+   int16_t raw (const uint8_t i) const { return(t16[i]); }
+   int16_t centiC (const uint8_t i) const { return(((int32_t)t16[i] * 100) / 16); }
+
+}; // CDS18Bus
+
 class CDS18Debug : public CDS18
 {
 public:
@@ -78,15 +225,15 @@ public:
   {
     uint8_t v[12];
     int16_t r=-1;
-    uint16_t f;
+    uint16_t d;
 
     clrb(v,12);
     r= readRaw(v);
     s.print("DS["); s.print(f,HEX); s.print(','); s.print(c,HEX); s.print("]:");
     dumpHex(s,id,8,":");//,0x0,-1);
     dumpHex(s,v,12,":");//,0x0,-1);
-    f= (r & 0xF) * 625;
-    s.print(r>>4); s.print('.'); if (f < 1000) { s.print('0'); } s.println(f);
+    d= (r & 0xF) * 625;
+    s.print(r>>4); s.print('.'); if (d < 1000) { s.print('0'); } s.println(d);
   }
 
 }; // CDS18Debug
@@ -1,12 +1,26 @@
 // Duino/Common/CMAX30102.hpp - MAXIM SpO2 sensor hackery
 // https://github.com/DrAl-HFS/Duino.git
 // Licence: AGPL3
-// (c) Project Contributors June 2022
+// (c) Project Contributors June 2022 - Oct 2026
 
 #ifndef CMAX10302_HPP
 #define CMAX10302_HPP
 
+#ifdef ARDUINO_ARCH_AVR
+#include "AVR/DA_TWUtil.hpp"
+#define I2C_BASE_CLASS TWUtil::CCommonTW
+#else
 #include "CCommonI2C.hpp"
+#define I2C_BASE_CLASS CCommonI2CX1
+#endif
+
+#ifndef MAX30102_XFER_MAX
+#ifdef BUFFER_LENGTH
+#define MAX30102_XFER_MAX BUFFER_LENGTH // Wire receive buffer
+#else
+#define MAX30102_XFER_MAX 32
+#endif
+#endif
 
 namespace MAX30102HW
 {
@@ -25,9 +39,11 @@ namespace MAX30102HW
    enum RangeCtrl : uint8_t { RC2K, RC4K, RC8K, RC16K };
    enum SampleRate : uint8_t { SR50, SR100, SR200, SR400, SR800, SR1000, SR1600, SR3200 };
    enum PulseWidth : uint8_t { PW69, PW118, PW215, PW411 };
+   enum Int1 : uint8_t { A_FULL=0x80, PPG_RDY=0x40, ALC_OVF=0x20, PWR_RDY=0x01 };
+   enum FIFO : uint8_t { DEPTH=32, ROLL_EN=0x10, SAMPLE_BYTES=6 }; // NB: SpO2 mode (red & IR, 18b each)
 }; // namespace MAX30102HW
 
-class CMAX30102 : public CCommonI2C
+class CMAX30102 : public I2C_BASE_CLASS
 {
    uint8_t fr[3];
    uint8_t f;
@@ -81,13 +97,13 @@ public:
 
    void logData (Stream& s) { dump(s, fr, 3,"fr[]=","\n"); }
 
-   void start (void)
+   void start (const MAX30102HW::SampleRate sr=MAX30102HW::SR100)
    {
       { // FCON, MCON & SPCON
          uint8_t rb[4]= { MAX30102HW::FCON, MAX30102HW::AV1<<5, MAX30102HW::SPO2, }; // Avg1; HRM|SpO2 ...
          //(0x1<<5) | (0x1<<2) | 0x1};
          // 15.63pA/4096nA, 100Hz, 118us / 16bit
-         rb[3]= defSCON(MAX30102HW::RC4K, MAX30102HW::SR100, MAX30102HW::PW118);
+         rb[3]= defSCON(MAX30102HW::RC4K, sr, MAX30102HW::PW118);
          writeTo(MAX30102HW::ADDR, rb, sizeof(rb));
       }
       { // LPA1 & 2
@@ -164,4 +180,206 @@ public:
 
 }; // class MAX30102
 
+#ifndef MAX30102_RING
+#define MAX30102_RING 32 // samples, power of 2
+#endif
+
+// Unpacked samples (platform independent, also used to replay recorded FIFO dumps)
+class CMAX30102Ring
+{
+public:
+   struct Sample { uint32_t red, ir; };
+
+protected:
+   Sample r[MAX30102_RING];
+   volatile uint16_t iW;
+   uint16_t iR;
+
+   // FIFO data: 3 bytes per LED, big endian, 18 significant bits (left justified
+   // ADC result, low bits zero at lower resolution)
+   static uint32_t u18 (const uint8_t b[3]) { return(((uint32_t)(b[0] & 0x03) << 16) | (b[1] << 8) | b[2]); }
+
+public:
+   uint32_t nIn, nLost; // unpacked, dropped (ring full)
+
+   CMAX30102Ring (void) : iW{0}, iR{0}, nIn{0}, nLost{0} { ; }
+
+   // Raw FIFO bytes of nS samples, returns samples stored
+   uint8_t unpack (const uint8_t b[], const uint8_t nS)
+   {
+      uint8_t i= 0;
+      for (; i < nS; i++)
+      {
+         if ((uint16_t)(iW - iR) >= MAX30102_RING) { nLost+= nS - i; break; }
+         Sample& e= r[iW & (MAX30102_RING-1)];
+         e.red= u18(b + i * MAX30102HW::SAMPLE_BYTES);
+         e.ir=  u18(b + i * MAX30102HW::SAMPLE_BYTES + 3);
+         iW++;
+      }
+      nIn+= i;
+      return(i);
+   } // unpack
+
+   uint16_t available (void) const { return(iW - iR); }
+
+   uint16_t get (Sample d[], const uint16_t max)
+   {
+      uint16_t n= 0;
+      while ((n < max) && (iR != iW)) { d[n++]= r[iR & (MAX30102_RING-1)]; iR++; }
+      return(n);
+   } // get
+
+}; // class CMAX30102Ring
+
+// FIFO streaming: the almost full interrupt (INT pin, active low) signals that the
+// FIFO holds 32 - nEmpty samples; the status & pointer registers then the whole FIFO
+// content are read in one burst and unpacked to the ring. With the TWM interrupt
+// driver (AVR, or a host build including AVR/DA_TWMISR.hpp beforehand) both reads
+// are queued and chained in ISR context, the main loop only unpacking completed
+// bursts, otherwise (or with useQ cleared) poll() reads synchronously through the
+// I2C base (TWUtil::CCommonTW on AVR, else Wire in chunks as permitted by its
+// buffer). NB: configuration always uses the I2C base.
+class CMAX30102Stream : public CMAX30102, public CMAX30102Ring
+{
+protected:
+   enum Phase : uint8_t { IDLE, STAT, DATA, READY };
+
+   uint8_t st[7]; // INTS1 .. FRDI
+   uint8_t fb[MAX30102HW::DEPTH * MAX30102HW::SAMPLE_BYTES];
+   volatile uint8_t phase, nB; // samples in burst
+   volatile bool pend;
+
+   // Samples held according to status read, device overflow accumulated
+   uint8_t count (void)
+   {
+      const uint8_t o= st[MAX30102HW::FOVC] & 0x1F;
+      nOvf+= o;
+      const uint8_t n= (st[MAX30102HW::FWRI] - st[MAX30102HW::FRDI]) & (MAX30102HW::DEPTH-1);
+      if ((o > 0) || ((0 == n) && (st[MAX30102HW::INTS1] & MAX30102HW::A_FULL))) { return(MAX30102HW::DEPTH); } // full
+      return(n);
+   } // count
+
+#ifdef DA_TWMISR_HPP
+   TWM::Trans tS, tD;
+   TWM::Frag fS[2], fD[2];
+   uint8_t aS, aD;
+
+   static void statDone (TWM::Trans& t)
+   {
+      CMAX30102Stream *p= (CMAX30102Stream*)t.ctx;
+      uint8_t n= 0;
+      if (TWM::DONE == t.state) { n= p->count(); } else { p->nErr++; }
+      if (n > 0)
+      {
+         p->fD[1].nB= n * MAX30102HW::SAMPLE_BYTES;
+         p->nB= n;
+         p->phase= DATA;
+         if (gTWM.post(p->tD)) { return; }
+         p->nErr++;
+      }
+      p->phase= IDLE;
+   } // statDone
+
+   static void dataDone (TWM::Trans& t)
+   {
+      CMAX30102Stream *p= (CMAX30102Stream*)t.ctx;
+      if (TWM::DONE == t.state) { p->phase= READY; } else { p->nErr++; p->phase= IDLE; }
+   } // dataDone
+
+   bool postStat (void)
+   {
+      phase= STAT;
+      if (gTWM.post(tS)) { return(true); }
+      phase= IDLE;
+      return(false);
+   } // postStat
+#endif
+
+   // Synchronous burst: status & pointers, then FIFO data in chunks
+   uint8_t readSync (void)
+   {
+      uint8_t a= MAX30102HW::INTS1, n= 0;
+      if (writeToThenReadFrom(MAX30102HW::ADDR, &a, 1, st, sizeof(st)) > (int)sizeof(st)) { n= count(); } else { nErr++; }
+      const int nC= MAX30102_XFER_MAX / MAX30102HW::SAMPLE_BYTES;
+      for (uint8_t i= 0; i < n; i+= nC)
+      {
+         const uint8_t m= min(n - i, nC);
+         a= MAX30102HW::FDAT;
+         if (writeToThenReadFrom(MAX30102HW::ADDR, &a, 1, fb, m * MAX30102HW::SAMPLE_BYTES) <= m * MAX30102HW::SAMPLE_BYTES) { nErr++; break; }
+         unpack(fb, m);
+      }
+      return(n);
+   } // readSync
+
+public:
+   uint32_t nBurst, nOvf; // FIFO reads, samples lost by device (FIFO full)
+   uint16_t nErr;
+   bool useQ;
+
+   CMAX30102Stream (void) : phase{IDLE}, nB{0}, pend{false}, nBurst{0}, nOvf{0}, nErr{0}, useQ{false}
+   {
+#ifdef DA_TWMISR_HPP
+      aS= MAX30102HW::INTS1; aD= MAX30102HW::FDAT;
+      fS[0]= {&aS, 1, TWM::WRITE}; fS[1]= {st, sizeof(st), TWM::READ};
+      fD[0]= {&aD, 1, TWM::WRITE}; fD[1]= {fb, 0, TWM::READ};
+      tS.set(MAX30102HW::ADDR, fS, 2); tS.done= statDone; tS.ctx= this;
+      tD.set(MAX30102HW::ADDR, fD, 2); tD.done= dataDone; tD.ctx= this;
+      useQ= true;
+#endif
+   }
+
+   // Interrupt when nEmpty (0..15) FIFO slots remain, FIFO roll over disabled
+   // (device counts lost samples). Clears FIFO & pending status.
+   void arm (const uint8_t nEmpty=15)
+   {
+      uint8_t b[4]= { MAX30102HW::FWRI, 0, 0, 0 }; // FWRI, FOVC, FRDI
+      writeTo(MAX30102HW::ADDR, b, 4);
+      b[0]= MAX30102HW::FCON; b[1]= (MAX30102HW::AV1<<5) | (nEmpty & 0xF);
+      writeTo(MAX30102HW::ADDR, b, 2);
+      b[0]= MAX30102HW::INTE1; b[1]= MAX30102HW::A_FULL; b[2]= 0;
+      writeTo(MAX30102HW::ADDR, b, 3);
+      b[0]= MAX30102HW::INTS1;
+      writeToThenReadFrom(MAX30102HW::ADDR, b, 1, b+1, 2);
+      phase= IDLE; pend= false;
+   } // arm
+
+   // INT pin asserted (pin change ISR or poll): start burst (queued) or defer
+   void irq (void)
+   {
+#ifdef DA_TWMISR_HPP
+      if (useQ && (IDLE == phase)) { postStat(); return; }
+#endif
+      pend= true;
+   } // irq
+
+   // Main loop: unpack completed burst / read synchronously, returns samples unpacked
+   uint8_t poll (void)
+   {
+      uint8_t n= 0;
+#ifdef DA_TWMISR_HPP
+      if (useQ)
+      {
+         if (READY == phase)
+         {
+            n= unpack(fb, nB);
+            nBurst++;
+            phase= IDLE;
+         }
+         if (pend && (IDLE == phase)) { pend= false; postStat(); }
+         return(n);
+      }
+#endif
+      if (pend)
+      {
+         pend= false;
+         const uint32_t n0= nIn;
+         readSync();
+         nBurst++;
+         n= nIn - n0;
+      }
+      return(n);
+   } // poll
+
+}; // class CMAX30102Stream
+
 #endif // CMAX30102_HPP
@@ -0,0 +1,80 @@
+// Duino/Common/CRC.hpp - Unified CRC interface: peripheral where available, else software tables
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef CRC_HPP
+#define CRC_HPP
+
+#include "SWCRC.hpp"
+
+// CRCU<B> (B = 8, 16 or 32) selects an implementation at compile time, each
+// providing compute(b,n,c) & computeF(pF,lF,nF,c) with identical results. On
+// STM32F1/F4 CRC32 is computed by the CRC peripheral, otherwise (& for CRC8/16)
+// by SWCRC tables.
+
+#if defined(ARDUINO_ARCH_STM32F1) || defined(ARDUINO_ARCH_STM32F4)
+#include "STM32/ST_Util.hpp"
+#define CRC_UNIT HWCRC
+#endif
+
+#ifdef CMX_UTIL // bitRev32
+
+// IEEE 802.3 CRC32 (as CRC32T) by an STM32 style CRC unit U, which is MSB first
+// (polynomial 0x04C11DB7, reset to 0xFFFFFFFF, no inversion) & accepts whole words
+// only. Words are bit reversed in & the result reversed out. Continuation from a
+// previous result seeds the unit with the word that produces that state from reset
+// (F1/F4 have no initial value register). Trailing bytes are completed in software.
+// NB: the unit is a shared resource, not to be used from an ISR while in use elsewhere.
+template <class U>
+class CRC32Unit : public U
+{
+protected:
+   // Word taking the unit from reset to state s (32 shifts reversed)
+   static uint32_t seed (uint32_t s)
+   {
+      for (int i= 0; i < 32; i++)
+      {
+         if (s & 1) { s= ((s ^ 0x04C11DB7) >> 1) | 0x80000000; } else { s>>= 1; }
+      }
+      return(s ^ 0xFFFFFFFF);
+   } // seed
+
+public:
+   CRC32Unit (void) { ; }
+
+   uint32_t compute (const uint8_t b[], uint32_t n, uint32_t c= 0)
+   {
+      U::reset();
+      if (0 != c) { U::add(seed(bitRev32(~c))); }
+      for (; n >= 4; n-= 4, b+= 4)
+      {
+         U::add(bitRev32(b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24)));
+      }
+      c= ~bitRev32(U::get(false));
+      if (n > 0) { c= CRC32T<1>().compute(b, n, c); } // nybble tables
+      return(c);
+   } // compute
+
+   uint32_t computeF (const uint8_t * const pF[], const uint8_t lF[], const uint8_t nF, uint32_t c= 0)
+   {
+      for (uint8_t i= 0; i < nF; i++) { c= compute(pF[i], lF[i], c); }
+      return(c);
+   } // computeF
+
+}; // CRC32Unit
+
+#endif // CMX_UTIL
+
+template <uint8_t B> struct CRCSel { };
+template <> struct CRCSel<8> { typedef CRC8 T; };
+template <> struct CRCSel<16> { typedef CRC16 T; };
+#ifdef CRC_UNIT
+template <> struct CRCSel<32> { typedef CRC32Unit<CRC_UNIT> T; };
+#else
+template <> struct CRCSel<32> { typedef CRC32 T; };
+#endif
+
+template <uint8_t B> using CRCU= typename CRCSel<B>::T;
+
+#endif // CRC_HPP
@@ -21,9 +21,11 @@ namespace W25Q
 
       RD_PG=0x03, WR_PG=0x02,    // data page (256 bytes)
       RF_PG=0x0B,                // "read fast" allows up to 133MHz SPI clock (requires very high quality signal path)
+      RD_DO=0x3B,                // fast read dual output: data on IO0 & IO1, 4 clocks per byte
       // erase sector/block/device
       GL_UN=0x98, // global unlock
       EE_4K=0x20, EE_32K=0x52, EE_64K=0xD8, EE_DV=0x60,
+      SUSPEND=0x75, RESUME=0x7A, // erase/program suspend (SUS flag in status 2)
       // simple commands (single byte)
       WR_EN=0x06, WR_DIS=0x04,   // write enable/disable
       SLEEP=0xB9, WAKE=0xAB      // power management
@@ -44,6 +46,14 @@ namespace W25Q
       DRV2=0x20, DRV1=0x40, RSV4=0x80
    };
    const int PAGE_BYTES= 256;
+   const int SECTOR_BYTES= 0x1000, BLOCK_SECTORS= 16;
+   const uint16_t SUSPEND_INTERVAL_US= 20; // min. resume to next suspend (tSUS)
+
+   // Read command selection: RD_PG has no dummy byte but is limited to fR (50MHz),
+   // RF_PG/RD_DO insert 8 dummy clocks after the address. Dual output requires a
+   // transport able to sample two data lines (SPI_DUAL_READ & transferDual()).
+   enum ReadMode : int8_t { RM_STD, RM_FAST, RM_DUAL };
+   const uint8_t RD_PG_MAX_MHZ= 50;
 }; // namespace W25Q
 
 // Basic access "toolkit"
@@ -52,6 +62,7 @@ class CW25Q : public CCommonSPIX1
    struct EraseParam { uint16_t nP; int8_t nE; W25Q::Cmd cmd; };
 
 protected:
+   W25Q::Cmd rdCmd;
 
    void cmd1 (const W25Q::Cmd c)
    {
@@ -78,6 +89,24 @@ protected:
       writeRev(addr.u8,3);
    } // cmdAddrFrag
 
+   // Single data line read command (for byte-wise scan & queued transfers)
+   W25Q::Cmd rdCmd1 (void) const { if (W25Q::RD_DO == rdCmd) { return(W25Q::RF_PG); } return(rdCmd); }
+
+   // Issue read command, address & any dummy byte, leaving device selected
+   void startRead (const UU32 addr, const W25Q::Cmd c)
+   {
+      cmdAddrFrag(addr, c);
+      if (W25Q::RD_PG != c) { HSPI.transfer(0x00); }
+   } // startRead
+
+   int readData (uint8_t b[], const int n)
+   {
+#ifdef SPI_DUAL_READ
+      if (W25Q::RD_DO == rdCmd) { HSPI.transferDual(b,n); return(n); }
+#endif
+      return read(b,n);
+   } // readData
+
    void startWrite (const UU32 addr, const W25Q::Cmd cmd)
    {
       sync();
@@ -129,8 +158,43 @@ public:
    CW25Q (const uint8_t clkMHz=SPI_CLOCK_DEFAULT) // NB: full clock rate for (84MHz) STM32F4
    {
       spiSet= SPISettings(clkMHz*1000000, MSBFIRST, SPI_MODE0);
+      setReadMode(readModeFor(clkMHz));
    }
 
+   // Preferred read for bulk transfer at given clock: the dummy byte costs
+   // less than the data time saved by dual output after a couple of bytes.
+   static W25Q::ReadMode readModeFor (const uint8_t clkMHz)
+   {
+#ifdef SPI_DUAL_READ
+      return(W25Q::RM_DUAL);
+#else
+      if (clkMHz > W25Q::RD_PG_MAX_MHZ) { return(W25Q::RM_FAST); }
+      return(W25Q::RM_STD);
+#endif
+   } // readModeFor
+
+   void setReadMode (const W25Q::ReadMode m)
+   {
+      switch(m)
+      {
+#ifdef SPI_DUAL_READ
+         case W25Q::RM_DUAL : rdCmd= W25Q::RD_DO; break;
+#endif
+         case W25Q::RM_FAST : rdCmd= W25Q::RF_PG; break;
+         default : rdCmd= W25Q::RD_PG; break;
+      }
+   } // setReadMode
+
+   W25Q::ReadMode getReadMode (void) const
+   {
+      switch(rdCmd)
+      {
+         case W25Q::RD_DO : return(W25Q::RM_DUAL);
+         case W25Q::RF_PG : return(W25Q::RM_FAST);
+         default : return(W25Q::RM_STD);
+      }
+   } // getReadMode
+
    void init (void)
    {
       CCommonSPI::begin();
@@ -144,19 +208,52 @@ public:
       cmd1(W25Q::GL_UN);
    } // unlock
 
+   // Streaming read: a single command then any number of streamRead() calls.
+   // The device address increments across page, sector & block boundaries
+   // (wrapping at the end of the array) for as long as select is held.
+   void streamOpen (const UU32 addr) { startRead(addr, rdCmd); }
+
+   int streamRead (uint8_t b[], const int n)
+   {
+      if (n > 0) { return readData(b,n); }
+      return(0);
+   } // streamRead
+
+   int streamSkip (int n)
+   {
+      uint8_t t[SPI_BLOCK_BYTES];
+      const int r= n;
+      while (n > 0) { n-= readData(t, min(n, SPI_BLOCK_BYTES)); }
+      return(r);
+   } // streamSkip
+
+   void streamClose (void) { complete(); }
+
    int dataRead (uint8_t b[], int n, const UU32 addr) // UU32
    {
       if (n > 0)
       {
-         //start();
-         cmdAddrFrag(addr, W25Q::RD_PG);
-         read(b,n);
-         complete();
+         streamOpen(addr);
+         streamRead(b,n);
+         streamClose();
          return(n);
       }
       return(0);
    } // dataRead
 
+#ifdef SPI_TRANSQ_HPP
+   // Queue a data read: descriptor & buffer must persist until t.state == DONE
+   bool dataReadAS (SPIQ::Sched& q, SPIQ::Trans& t, uint8_t b[], const uint16_t n, const UU32 addr)
+   {
+      if (n <= 0) { return(false); }
+      t.pS= &spiSet;
+      t.pin= PIN_NCS;
+      t.cmdAddr(rdCmd1(), addr.u32, 3, W25Q::RD_PG != rdCmd1());
+      t.data(NULL, b, n, 0xAA);
+      return q.submit(t);
+   } // dataReadAS
+#endif // SPI_TRANSQ_HPP
+
    int dataWrite (const uint8_t b[], int n, const UU32 addr) // UU32
    {
       if (n > 0)
@@ -208,60 +305,52 @@ public:
 // Extended functionality for common problems
 class CW25QUtil : public CW25Q
 {
-/*   friend struct SplitFrag
+protected:
+   // Position within a gather list, fragments may be consumed in parts
+   struct FragCursor
    {
-     const uint8_t *pF; uint8_t h, t;
-
-      SplitFrag (void) : pF{NULL}, h{0}, t{0} {;}
+      const uint8_t * const *ppF;
+      const uint8_t *lF;
+      int nF, iF;
+      uint8_t oF;    // offset within current fragment
 
-      bool set (const uint8_t *p, const uint8_t l, const int r)
-      {
-         if ((NULL == pF) && (0 == h) && (0 == t))
-         {
-            pF= p; h= r; t= l - r;
-            return(true);
-         }
-         return(false);
-      } // set
+      FragCursor (const uint8_t * const ppFrag[], const uint8_t lFrag[], const int nFrag) : ppF{ppFrag}, lF{lFrag}, nF{nFrag}, iF{0}, oF{0} { ; }
 
-      int writeH (CCommonSPI& dev)
-      {
-         int w=0;
-         if (pF && (h > 0))
-         {
-            w= dev.write(pF,h);
-            if (t > 0) { pF+= h; }
-            else { pF= NULL; } // weird?
-            h= 0;
-         }
-         return(w);
-      } // writeH
+      bool more (void) const { return(iF < nF); }
+   }; // struct FragCursor
 
-      int writeT (CCommonSPI& dev)
+#ifndef W25Q_PAGE_PIECE_MAX
+#define W25Q_PAGE_PIECE_MAX 16
+#endif
+   // Fragment pieces making up one program operation (within a single page)
+   struct PageSpan
+   {
+      const uint8_t *pP[W25Q_PAGE_PIECE_MAX];
+      uint8_t lP[W25Q_PAGE_PIECE_MAX];
+      uint8_t nP;
+      uint16_t bytes;
+
+      // Take up to max bytes from the cursor, splitting the last fragment as needed.
+      // Stops short of max when pieces run out: the remainder then follows as a
+      // further program of the same page.
+      uint16_t plan (FragCursor& c, const uint16_t max)
       {
-         int w=0;
-         if (pF && (0 == h) && (t > 0))
+         nP= 0; bytes= 0;
+         while (c.more() && (bytes < max) && (nP < W25Q_PAGE_PIECE_MAX))
          {
-            w= dev.write(pF,t);
-            pF= NULL;
-            t= 0;
+            const uint8_t r= c.lF[c.iF] - c.oF;
+            const uint16_t m= min((uint16_t)r, (uint16_t)(max - bytes));
+            if (m > 0)
+            {
+               pP[nP]= c.ppF[c.iF] + c.oF;
+               lP[nP++]= m;
+               bytes+= m;
+            }
+            if (m < r) { c.oF+= m; } else { c.iF++; c.oF= 0; }
          }
-         return(w);
-      } // writeT
-
-   }; // struct SplitFrag
-*/
-   int numFragsWithin (const uint8_t lF[], const int nF, const int max)
-   {
-      int n=0;
-      if (nF > 0)
-      {
-         int sum= lF[0];
-         while ((++n < nF) && ((sum+= lF[n]) <= max)); // { sum+= lF[n]; }
-         //if (sum > max) { split.b= sum-max; split.a= lF[n] - split.b; }
-      }
-      return(n);
-   } // numFragsWithin
+         return(bytes);
+      } // plan
+   }; // struct PageSpan
 
    // CAVEAT: no address&size checking - beware circular wrap!
    int dataWriteF (const UU32 addr, const uint8_t * const ppF[], const uint8_t lF[], const int nF)
@@ -272,56 +361,71 @@ class CW25QUtil : public CW25Q
       complete();
       return(t);
    } // dataWriteF
-/*
-   int dataWriteFS (const UU32 addr, const uint8_t * const ppF[], const uint8_t lF[], const int nF, Split& s)
-   {
-      int t;
-      startWrite(addr, W25Q::WR_PG);
-      t= s.writeT();  // Yech...
-      t+= writeFrags(ppF+iF, lF+iF, n);
-      t+= s.writeH();
-      complete();
-      return(t);
-   } // dataWriteFS
-*/
+
 public:
    CW25QUtil (const uint8_t clkMHz=SPI_CLOCK_DEFAULT) : CW25Q(clkMHz) { ; }
 
-   // Check for unused storage (or some other constant value) without using a buffer
+   // Pause erase in flight so that read & program are accepted, true if suspended.
+   // NB: at least SUSPEND_INTERVAL_US must elapse after opResume().
+   bool opSuspend (void)
+   {
+      if (0 == (cmdRW1(W25Q::RD_ST1) & W25Q::BUSY)) { return(false); }
+      cmd1(W25Q::SUSPEND);
+      sync(); // tSUS
+      return(0 != (cmdRW1(W25Q::RD_ST2) & W25Q::SUS));
+   } // opSuspend
+
+   void opResume (void)
+   {
+      sync(); // any program issued meanwhile
+      cmd1(W25Q::RESUME);
+   } // opResume
+
+   bool opSuspended (void) { return(0 != (cmdRW1(W25Q::RD_ST2) & W25Q::SUS)); }
+
+   // Check for unused storage (or some other constant value): streamed in
+   // small blocks, so may clock up to SPI_BLOCK_BYTES-1 beyond the result.
    int dataScan (const UU32 addr, const int max=1<<12, const uint8_t v=0xFF, const bool until=false)
    {
-      cmdAddrFrag(addr,W25Q::RD_PG);
-      int n= CCommonSPIX1::scan(&v,1,max,until);
-      complete();
+      uint8_t b[SPI_BLOCK_BYTES];
+      int n= 0;
+      streamOpen(addr);
+      while (n < max)
+      {
+         const int m= streamRead(b, min(max-n, SPI_BLOCK_BYTES));
+         int i= 0;
+         while ((i < m) && ((b[i] == v) ^ until)) { ++i; }
+         n+= i;
+         if (i < m) { break; }
+      }
+      streamClose();
       return(n);
    } // dataScan
 
-   // Gathered fragment write :
-   // Write fragments as continuous sequence, ? over pages ?
-   // CAVEAT: device write buffer is *circular* 256Bytes
-   int dataWriteFrags (UU32 addr, const uint8_t * const ppF[], const uint8_t lF[], const int nF)
+   // Gathered fragment write: fragments are written as a continuous sequence
+   // from addr, split at page boundaries (the device write buffer is *circular*
+   // 256Bytes) with one WR_EN/WR_PG cycle per page. The next page is planned
+   // while the previous one programs. Returns bytes written, which is short of
+   // the total if the device remains busy beyond maxPoll status reads.
+   int dataWriteFrags (UU32 addr, const uint8_t * const ppF[], const uint8_t lF[], const int nF, const uint32_t maxPoll=-1)
    {
-      int n= numFragsWithin(lF, nF, W25Q::PAGE_BYTES - addr.u8[0]);
-      if (n == nF) { return dataWriteF(addr,ppF,lF,nF); }
-      else { // not properly figured out yet...
-      }
-      /*
-      int t=0, iF=0;
-      if (nF > 0)
+      FragCursor c(ppF, lF, nF);
+      PageSpan s;
+      int t= 0;
+
+      s.plan(c, W25Q::PAGE_BYTES - addr.u8[0]);
+      while (s.bytes > 0)
       {
-         //SplitFrag split;
-         do
-         {
-               //{ i-= !split.set(ppF[i],lF[i],rem); }
-               int n= i-iF; // NB: already i+1
-               iF+= n;
-               t+= t0;
-               addr.u32+= t0;
-         } while (iF < nF);
+         if (!sync(maxPoll)) { break; }
+         cmd1(W25Q::WR_EN);
+         cmdAddrFrag(addr, W25Q::WR_PG);
+         writeFrags(s.pP, s.lP, s.nP);
+         complete();
+         t+= s.bytes;
+         addr.u32+= s.bytes;
+         s.plan(c, W25Q::PAGE_BYTES - addr.u8[0]); // overlaps tPP
       }
       return(t);
-      */
-      return(0);
    } // dataWriteFrags
 
 // DISPLACE -> CW25QUtilA ???
@@ -0,0 +1,159 @@
+// Duino/Common/CW25QErase.hpp - Background erase scheduling for W25Q logging
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef CW25Q_ERASE_HPP
+#define CW25Q_ERASE_HPP
+
+#include "CW25Q.hpp"
+
+// Maintains a pool of pre-erased 4K sectors ahead of the write pointer of a
+// circular log region. Erase commands are issued from service(), which should
+// be called while the application is idle: it reads status at most once and
+// never waits on BUSY. A 64K block erase is used whenever an aligned block is
+// wanted. An erase in flight is suspended for urgent access (dataReadNow,
+// dataWriteNow) so that latency is bounded by tSUS + program time rather than
+// the erase time.
+class CW25QErase : public CW25QUtil
+{
+protected:
+   uint16_t bS, nS;  // region: base sector & count
+   uint16_t wS, eS;  // next sector to hand out & next to erase (offsets within region)
+   uint16_t nE;      // pool: erased sectors from wS
+   uint16_t nI;      // sectors covered by erase in flight, 0 -> none
+   uint16_t ahead;   // target pool size
+   uint32_t tR;      // time of last resume (us)
+   bool sus;
+
+   UU32 sectorAddr (const uint16_t o) const { UU32 a={ (uint32_t)(bS + o) << 12 }; return(a); }
+
+   uint16_t wrap (const uint16_t o) const { if (o >= nS) { return(o - nS); } return(o); }
+
+   bool busyPoll (void) { return(0 != (cmdRW1(W25Q::RD_ST1) & W25Q::BUSY)); }
+
+   // Start erase of the largest unit that fits what is wanted, stopping short of
+   // the sector in use (wS-1). Already blank sectors are just counted.
+   void issue (void)
+   {
+      const uint16_t want= ahead - nE;
+      const uint16_t room= nS - 1 - nE;
+      UU32 a= sectorAddr(eS);
+      W25Q::Cmd c= W25Q::EE_64K;
+      uint16_t n= W25Q::BLOCK_SECTORS;
+
+      if ((0 != ((bS + eS) & (W25Q::BLOCK_SECTORS-1))) || (want < n) || (room < n) || ((eS + n) > nS))
+      {
+         if (dataScan(a, W25Q::SECTOR_BYTES) >= W25Q::SECTOR_BYTES)
+         {
+            nBlank++;
+            nE++;
+            eS= wrap(eS + 1);
+            return;
+         }
+         c= W25Q::EE_4K;
+         n= 1;
+      }
+      cmd1(W25Q::WR_EN);
+      cmdAddrFrag(a, c);
+      complete();
+      nI= n;
+      nErase++;
+   } // issue
+
+public:
+   uint16_t nErase, nBlank, nStall, nSuspend;
+
+   CW25QErase (const uint8_t clkMHz=SPI_CLOCK_DEFAULT) : CW25QUtil(clkMHz) { setRegion(0,0); }
+
+   // Log region in sectors, pool target (at least 1, less than region)
+   void setRegion (const uint16_t baseS, const uint16_t numS, const uint16_t aheadS=W25Q::BLOCK_SECTORS)
+   {
+      bS= baseS; nS= numS;
+      wS= eS= nE= nI= 0;
+      ahead= constrain(aheadS, 1, max(1, nS-1));
+      tR= 0; sus= false;
+      nErase= nBlank= nStall= nSuspend= 0;
+   } // setRegion
+
+   uint16_t pool (void) const { return(nE); }
+   bool erasing (void) const { return(nI > 0); }
+
+   // Idle time work: complete/launch background erase, returns true while erase in flight
+   bool service (void)
+   {
+      if (sus || ((nE >= ahead) && (0 == nI))) { return(sus); }
+      if (busyPoll()) { return(nI > 0); } // erase in flight, or a page programs
+      if (nI > 0)
+      {
+         nE+= nI;
+         eS= wrap(eS + nI);
+         nI= 0;
+      }
+      if (nE < ahead) { issue(); }
+      return(nI > 0);
+   } // service
+
+   // Fill the pool, blocking (e.g. at start up)
+   void prime (void)
+   {
+      while (service() || (nE < ahead)) { sync(); }
+   } // prime
+
+   // Hand out address of the next erased sector, waiting only if the pool is exhausted
+   UU32 take (void)
+   {
+      if (0 == nE)
+      {
+         nStall++;
+         resume();
+         while (0 == nE) { service(); sync(); }
+      }
+      const UU32 a= sectorAddr(wS);
+      wS= wrap(wS + 1);
+      nE--;
+      return(a);
+   } // take
+
+   // Pause an erase in flight so that the device accepts read/program
+   void suspend (void)
+   {
+      if ((nI > 0) && !sus && busyPoll())
+      {
+         const uint32_t dt= micros() - tR;
+         if (dt < W25Q::SUSPEND_INTERVAL_US) { delayMicroseconds(W25Q::SUSPEND_INTERVAL_US - dt); }
+         sus= opSuspend();
+         nSuspend+= sus;
+      }
+   } // suspend
+
+   void resume (void)
+   {
+      if (sus)
+      {
+         opResume();
+         tR= micros();
+         sus= false;
+      }
+   } // resume
+
+   // Urgent access: not delayed by erase in flight. NB: must not target the sector(s) being erased
+   int dataReadNow (uint8_t b[], const int n, const UU32 addr)
+   {
+      suspend();
+      const int r= dataRead(b, n, addr);
+      resume();
+      return(r);
+   } // dataReadNow
+
+   int dataWriteNow (const uint8_t b[], const int n, const UU32 addr)
+   {
+      suspend();
+      const int r= dataWrite(b, n, addr);
+      resume();
+      return(r);
+   } // dataWriteNow
+
+}; // CW25QErase
+
+#endif // CW25Q_ERASE_HPP
@@ -0,0 +1,463 @@
+// Duino/Common/CW25QWear.hpp - Wear levelling & bad sector remapping for W25Q
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef CW25Q_WEAR_HPP
+#define CW25Q_WEAR_HPP
+
+#include "CW25Q.hpp"
+#include "SWCRC.hpp"
+
+// A region of 4K sectors is presented as fewer logical sectors at the same base
+// address, the surplus being spares plus two journal sectors at the region end.
+// Each logical sector erase is redirected to the least worn free physical sector
+// (the previous one becoming free). When the erase count spread between the
+// most worn free sector and the least worn sector in use exceeds WEAR_DELTA, the
+// cold data is moved so that its sector can take a share of the erases. With
+// verification enabled, every program is read back: a sector that fails is
+// retired and its logical contents moved to a spare.
+// Mapping & erase counts persist in a journal: a snapshot followed by 4 byte
+// event records {logical:12, physical:12, CRC8}, alternating between the two
+// journal sectors when full. Addresses outside the region pass straight through.
+// The device is a private base: only the remapped API (as used by MFD_DEV) and
+// address free controls are public, so physical access needs its own CW25QUtil.
+
+#ifndef WEAR_SECT_MAX
+#define WEAR_SECT_MAX 256 // physical sectors in region
+#endif
+#ifndef WEAR_DELTA
+#define WEAR_DELTA 32 // static levelling threshold (erase counts)
+#endif
+
+namespace Wear
+{
+   const uint16_t NONE= 0xFFF, RETIRE= 0xFFE;   // event codes (logical field)
+   const uint8_t F_FREE= 0x1, F_BAD= 0x2;       // per sector flags (low byte of count word)
+
+   struct JHdr
+   {
+      uint8_t m[3], crc;
+      uint16_t seq, nS, nL, rsv;
+   }; // struct JHdr
+}; // namespace Wear
+
+class CW25QWear : private CW25QUtil
+{
+protected:
+   uint32_t cf[WEAR_SECT_MAX];   // physical: erase count << 8 | flags
+   uint16_t map[WEAR_SECT_MAX];  // logical -> physical offset
+   uint16_t bS, nS, nL;          // region: base sector, physical & logical sectors
+   uint16_t jS, jW, jSeq;        // current journal sector (offset), write offset, sequence
+   uint32_t sL;                  // stream: logical address
+   CRC8 crc8;
+
+   uint16_t jBytes (void) const { return(sizeof(Wear::JHdr) + nS * sizeof(cf[0]) + nL * sizeof(map[0])); }
+   uint32_t physAddr (const uint16_t o) const { return((uint32_t)(bS + o) << 12); }
+
+   // Logical sector offset within region, or nL
+   uint16_t logical (const uint32_t a) const
+   {
+      const uint16_t s= a >> 12;
+      if ((s >= bS) && (s < (bS + nL))) { return(s - bS); }
+      return(nL);
+   } // logical
+
+   UU32 phys (const uint32_t a) const
+   {
+      const uint16_t l= logical(a);
+      UU32 r={a};
+      if (l < nL) { r.u32= physAddr(map[l]) | (a & 0xFFF); }
+      return(r);
+   } // phys
+
+   uint32_t count (const uint16_t p) const { return(cf[p] >> 8); }
+
+   void physErase (const uint16_t p)
+   {
+      UU32 a={physAddr(p)};
+      erase(a, W25Q::EE_4K);
+      cf[p]+= 0x100;
+      nErase++;
+   } // physErase
+
+   // Least worn (or, hot, most worn) free sector, nS if none
+   uint16_t pickFree (const bool hot=false) const
+   {
+      uint16_t r= nS;
+      for (uint16_t p= 0; p < (nS - 2); p++)
+      {
+         if (Wear::F_FREE != (cf[p] & 0xFF)) { continue; }
+         if ((nS == r) || (hot ? (count(p) > count(r)) : (count(p) < count(r)))) { r= p; }
+      }
+      return(r);
+   } // pickFree
+
+   bool progVerify (const uint8_t b[], const int n, const UU32 a)
+   {
+      uint8_t t[W25Q::PAGE_BYTES];
+      CW25QUtil::dataWrite(b, n, a);
+      nProgP+= n;
+      if (!verify) { return(true); }
+      sync();
+      CW25QUtil::dataRead(t, n, a);
+      return(0 == memcmp(t, b, n));
+   } // progVerify
+
+   // Copy used pages of physical sector s to d, substituting page image pI at
+   // offset oI (where a program failed). Returns false on verify failure.
+   bool copySector (const uint16_t d, const uint16_t s, const uint8_t *pI=NULL, const uint16_t oI=0)
+   {
+      uint8_t b[W25Q::PAGE_BYTES];
+      bool ok= true;
+      for (uint16_t o= 0; ok && (o < W25Q::SECTOR_BYTES); o+= W25Q::PAGE_BYTES)
+      {
+         UU32 a={physAddr(s) + o};
+         const uint8_t *p= b;
+         if (pI && (o == oI)) { p= pI; }
+         else
+         {
+            sync();
+            CW25QUtil::dataRead(b, sizeof(b), a);
+         }
+         int i= 0;
+         while ((i < W25Q::PAGE_BYTES) && (0xFF == p[i])) { i++; }
+         if (i < W25Q::PAGE_BYTES)
+         {
+            a.u32= physAddr(d) + o;
+            ok= progVerify(p, W25Q::PAGE_BYTES, a);
+            nCopy+= W25Q::PAGE_BYTES;
+         }
+      }
+      return(ok);
+   } // copySector
+
+   void jWrite (const uint8_t b[], uint16_t n)
+   {
+      while (n > 0)
+      {
+         const uint16_t m= min(n, (uint16_t)(W25Q::PAGE_BYTES - (jW & 0xFF)));
+         UU32 a={physAddr(jS) + jW};
+         CW25QUtil::dataWrite(b, m, a);
+         nProgP+= m;
+         jW+= m; b+= m; n-= m;
+      }
+   } // jWrite
+
+   // Start the other journal sector with a full snapshot
+   void snapshot (void)
+   {
+      Wear::JHdr h;
+      jS= (nS - 2) + ((nS - 1) != jS);
+      physErase(jS);
+      memcpy(h.m, "WLJ", 3);
+      if (0 == ++jSeq) { jSeq= 1; } // 0 -> invalid
+      h.seq= jSeq; h.nS= nS; h.nL= nL; h.rsv= 0;
+      h.crc= crc8.compute((const uint8_t*)&h.seq, 8);
+      for (uint16_t i= 0; i < nS; i+= 16) { h.crc= crc8.compute((const uint8_t*)(cf+i), min(16, nS-i) * sizeof(cf[0]), h.crc); }
+      for (uint16_t i= 0; i < nL; i+= 16) { h.crc= crc8.compute((const uint8_t*)(map+i), min(16, nL-i) * sizeof(map[0]), h.crc); }
+      jW= 0;
+      jWrite((const uint8_t*)&h, sizeof(h));
+      jWrite((const uint8_t*)cf, nS * sizeof(cf[0]));
+      jWrite((const uint8_t*)map, nL * sizeof(map[0]));
+   } // snapshot
+
+   void event (const uint16_t l, const uint16_t p)
+   {
+      uint8_t e[4];
+      if ((jW + sizeof(e)) > W25Q::SECTOR_BYTES) { snapshot(); return; } // snapshot includes event
+      e[0]= l; e[1]= ((l >> 8) & 0xF) | (p << 4); e[2]= p >> 4;
+      e[3]= crc8.compute(e, 3);
+      jWrite(e, sizeof(e));
+   } // event
+
+   void apply (const uint16_t l, const uint16_t p)
+   {
+      if (p >= nS) { return; }
+      if (Wear::RETIRE == l) { cf[p]= (cf[p] & ~0xFF) | Wear::F_BAD; return; }
+      if (l >= nL) { return; }
+      cf[map[l]]|= Wear::F_FREE;
+      map[l]= p;
+      cf[p]= (cf[p] & ~0xFF) + 0x100; // erased once more, in use
+   } // apply
+
+   // Header of journal sector o, sequence 0 if not a journal of this region
+   uint16_t jHead (Wear::JHdr& h, const uint16_t o)
+   {
+      UU32 a={physAddr(o)};
+      sync();
+      CW25QUtil::dataRead((uint8_t*)&h, sizeof(h), a);
+      if ((0 != memcmp(h.m, "WLJ", 3)) || (h.nS != nS) || (h.nL != nL)) { return(0); }
+      return(h.seq);
+   } // jHead
+
+   // Load journal sector o, replaying events. Returns sequence, 0 if invalid.
+   uint16_t load (const uint16_t o)
+   {
+      Wear::JHdr h;
+      uint8_t e[4];
+      if (0 == jHead(h, o)) { return(0); }
+      UU32 a={physAddr(o) + (uint32_t)sizeof(h)};
+      CW25QUtil::dataRead((uint8_t*)cf, nS * sizeof(cf[0]), a);
+      a.u32+= nS * sizeof(cf[0]);
+      CW25QUtil::dataRead((uint8_t*)map, nL * sizeof(map[0]), a);
+      a.u32+= nL * sizeof(map[0]);
+      uint8_t c= crc8.compute((const uint8_t*)&h.seq, 8);
+      for (uint16_t i= 0; i < nS; i+= 16) { c= crc8.compute((const uint8_t*)(cf+i), min(16, nS-i) * sizeof(cf[0]), c); }
+      for (uint16_t i= 0; i < nL; i+= 16) { c= crc8.compute((const uint8_t*)(map+i), min(16, nL-i) * sizeof(map[0]), c); }
+      if (c != h.crc) { return(0); }
+      jS= o; jW= jBytes();
+      while ((jW + sizeof(e)) <= W25Q::SECTOR_BYTES)
+      {
+         CW25QUtil::dataRead(e, sizeof(e), a);
+         if ((0xFF == e[0]) && (0xFF == e[1]) && (0xFF == e[2])) { break; }
+         if (crc8.compute(e, 3) == e[3]) { apply(e[0] | ((e[1] & 0xF) << 8), (e[1] >> 4) | (e[2] << 4)); }
+         a.u32+= sizeof(e); jW+= sizeof(e);
+      }
+      return(h.seq);
+   } // load
+
+   // Erase logical sector: move to least worn free sector
+   void eraseL (const uint16_t l)
+   {
+      const uint16_t p= pickFree();
+      if (p < nS)
+      {
+         physErase(p);
+         cf[map[l]]|= Wear::F_FREE;
+         map[l]= p;
+         cf[p]&= ~0xFF;
+         event(l, p);
+         level();
+      }
+      else { physErase(map[l]); } // no spares: in place
+   } // eraseL
+
+   // Static levelling: move coldest data into the most worn free sector
+   void level (void)
+   {
+      uint16_t c= nS, l= nL;
+      for (uint16_t i= 0; i < nL; i++)
+      {
+         if ((nS == c) || (count(map[i]) < count(c))) { c= map[i]; l= i; }
+      }
+      const uint16_t h= pickFree(true);
+      if ((h < nS) && (c < nS) && (count(h) > (count(c) + WEAR_DELTA)))
+      {
+         physErase(h);
+         if (!copySector(h, c)) { return; } // retried at next erase
+         cf[h]&= ~0xFF;
+         cf[c]|= Wear::F_FREE;
+         map[l]= h;
+         event(l, h);
+         nMove++;
+      }
+   } // level
+
+   // Program failed in logical sector l: move contents to a spare, retire old
+   bool retire (const uint16_t l, const uint16_t o, const uint8_t b[], const int n)
+   {
+      uint8_t pg[W25Q::PAGE_BYTES];
+      const uint16_t oP= o & ~(W25Q::PAGE_BYTES-1);
+      const uint16_t s= map[l];
+      UU32 a={physAddr(s) + oP};
+      sync();
+      CW25QUtil::dataRead(pg, sizeof(pg), a);
+      memcpy(pg + (o - oP), b, n);  // NB: assumes intended bytes were over erased storage
+      for (int i= 0; i < 3; i++)
+      {
+         const uint16_t p= pickFree();
+         if (p >= nS) { return(false); }
+         physErase(p);
+         if (copySector(p, s, pg, oP))
+         {
+            cf[s]= (cf[s] & ~0xFF) | Wear::F_BAD;
+            cf[p]&= ~0xFF;
+            map[l]= p;
+            event(Wear::RETIRE, s);
+            event(l, p);
+            nRetire++;
+            return(true);
+         }
+         cf[p]= (cf[p] & ~0xFF) | Wear::F_BAD; // spare failed too
+         event(Wear::RETIRE, p);
+         nRetire++;
+      }
+      return(false);
+   } // retire
+
+public:
+   uint32_t nErase, nMove, nRetire, nFail; // physical erases, cold data moves, sectors retired, unrecoverable writes
+   uint64_t nProgL, nProgP, nCopy;         // bytes programmed: logical, physical (incl. copy & journal), copied
+   bool verify;
+
+   CW25QWear (const uint8_t clkMHz=SPI_CLOCK_DEFAULT) : CW25QUtil(clkMHz), bS{0}, nS{0}, nL{0}, verify{true} { clearStat(); }
+
+   using CW25QUtil::init;
+   using CW25QUtil::unlock;
+   using CW25QUtil::setReadMode;
+   using CW25QUtil::getReadMode;
+   using CW25QUtil::sync;
+   using CW25QUtil::opSuspend;
+   using CW25QUtil::opResume;
+   using CW25QUtil::opSuspended;
+   using CW25QUtil::streamClose;
+
+   void clearStat (void) { nErase= nMove= nRetire= nFail= 0; nProgL= nProgP= nCopy= 0; }
+
+   // Region of numS physical sectors (at most WEAR_SECT_MAX), presenting numS-2-spareS logical sectors
+   bool setRegion (const uint16_t baseS, const uint16_t numS, const uint16_t spareS)
+   {
+      if ((numS > WEAR_SECT_MAX) || (numS < (spareS + 3))) { nS= nL= 0; return(false); }
+      bS= baseS; nS= numS; nL= numS - 2 - spareS;
+      jS= nS - 1; jW= 0; jSeq= 0;
+      for (uint16_t p= 0; p < nS; p++) { cf[p]= (p >= nL) ? Wear::F_FREE : 0; }
+      for (uint16_t l= 0; l < nL; l++) { map[l]= l; }
+      cf[nS-2]= cf[nS-1]= 0;
+      return(true);
+   } // setRegion
+
+   uint16_t logicalSectors (void) const { return(nL); }
+   uint16_t spares (void) const
+   {
+      uint16_t n= 0;
+      for (uint16_t p= 0; p < (nS - 2); p++) { n+= (Wear::F_FREE == (cf[p] & 0xFF)); }
+      return(n);
+   } // spares
+
+   // Restore state from the newer valid journal sector (the older if the newer is
+   // torn), else start a new journal. Returns true if a journal was found.
+   bool mount (void)
+   {
+      Wear::JHdr h;
+      if (0 == nS) { return(false); }
+      const uint16_t s0= jHead(h, nS-2), s1= jHead(h, nS-1);
+      uint16_t o= nS-2;
+      if (0 == s0) { o= nS-1; }
+      else if ((0 != s1) && ((int16_t)(s1 - s0) > 0)) { o= nS-1; }
+      jSeq= load(o);
+      if (0 == jSeq) { jSeq= load((2*nS - 3) - o); }
+      if (jSeq > 0) { return(true); }
+      setRegion(bS, nS, nS - 2 - nL);
+      snapshot();
+      return(false);
+   } // mount
+
+   // Erase count range over data sectors in use or free (not journal or retired)
+   void wearRange (uint32_t& lo, uint32_t& hi) const
+   {
+      lo= -1; hi= 0;
+      for (uint16_t p= 0; p < (nS - 2); p++)
+      {
+         if (cf[p] & Wear::F_BAD) { continue; }
+         lo= min(lo, count(p)); hi= max(hi, count(p));
+      }
+   } // wearRange
+
+   // Logical access: as CW25QUtil, translating addresses within the region.
+   // Streams are re-addressed at each sector boundary.
+   void streamOpen (const UU32 addr) { sL= addr.u32; CW25QUtil::streamOpen(phys(sL)); }
+
+   int streamRead (uint8_t b[], int n)
+   {
+      const int r= n;
+      while (n > 0)
+      {
+         const int m= min(n, (int)(W25Q::SECTOR_BYTES - (sL & 0xFFF)));
+         CW25QUtil::streamRead(b, m);
+         sL+= m; b+= m; n-= m;
+         if (0 == (sL & 0xFFF)) { CW25QUtil::streamClose(); CW25QUtil::streamOpen(phys(sL)); }
+      }
+      return(r);
+   } // streamRead
+
+   int streamSkip (int n)
+   {
+      const int r= n;
+      while (n > 0)
+      {
+         const int m= min(n, (int)(W25Q::SECTOR_BYTES - (sL & 0xFFF)));
+         CW25QUtil::streamSkip(m);
+         sL+= m; n-= m;
+         if (0 == (sL & 0xFFF)) { CW25QUtil::streamClose(); CW25QUtil::streamOpen(phys(sL)); }
+      }
+      return(r);
+   } // streamSkip
+
+   int dataRead (uint8_t b[], int n, const UU32 addr)
+   {
+      if (n <= 0) { return(0); }
+      streamOpen(addr);
+      streamRead(b, n);
+      streamClose();
+      return(n);
+   } // dataRead
+
+   // As CW25QUtil, through the logical stream
+   int dataScan (const UU32 addr, const int max=1<<12, const uint8_t v=0xFF, const bool until=false)
+   {
+      uint8_t b[SPI_BLOCK_BYTES];
+      int n= 0;
+      streamOpen(addr);
+      while (n < max)
+      {
+         const int m= streamRead(b, min(max-n, SPI_BLOCK_BYTES));
+         int i= 0;
+         while ((i < m) && ((b[i] == v) ^ until)) { ++i; }
+         n+= i;
+         if (i < m) { break; }
+      }
+      streamClose();
+      return(n);
+   } // dataScan
+
+   // Single page program (as CW25Q), verified & remapped on failure within the region
+   int dataWrite (const uint8_t b[], int n, const UU32 addr)
+   {
+      const uint16_t l= logical(addr.u32);
+      if (n > W25Q::PAGE_BYTES) { n= W25Q::PAGE_BYTES; }
+      if (n <= 0) { return(0); }
+      nProgL+= n;
+      if (l >= nL) { nProgP+= n; return CW25QUtil::dataWrite(b, n, addr); }
+      if (!progVerify(b, n, phys(addr.u32)) && !retire(l, addr.u32 & 0xFFF, b, n)) { nFail++; }
+      return(n);
+   } // dataWrite
+
+   // Gather write, staged page by page. As CW25QUtil, returns bytes written which is
+   // short of the total if the device remains busy beyond maxPoll status reads
+   // before a page. NB: verification also waits for each page to program.
+   int dataWriteFrags (UU32 addr, const uint8_t * const ppF[], const uint8_t lF[], const int nF, const uint32_t maxPoll=-1)
+   {
+      uint8_t pg[W25Q::PAGE_BYTES];
+      int t= 0, m= 0;
+      for (int i= 0; i < nF; i++)
+      {
+         for (int j= 0; j < lF[i]; j++)
+         {
+            pg[m++]= ppF[i][j];
+            if (0 == ((addr.u32 + m) & 0xFF))
+            {
+               if (!sync(maxPoll)) { return(t); }
+               dataWrite(pg, m, addr); addr.u32+= m; t+= m; m= 0;
+            }
+         }
+      }
+      if ((m > 0) && sync(maxPoll)) { dataWrite(pg, m, addr); t+= m; }
+      return(t);
+   } // dataWriteFrags
+
+   // Logical pages, sector aligned
+   int dataErase (uint16_t aP, const int nP=16)
+   {
+      if ((aP & 0xF) || (nP & 0xF)) { return(0); }
+      for (int i= 0; i < nP; i+= 16, aP+= 16)
+      {
+         const uint16_t l= logical((uint32_t)aP << 8);
+         if (l < nL) { eraseL(l); } else { CW25QUtil::dataErase(aP, 16); nErase++; }
+      }
+      return(nP);
+   } // dataErase
+
+}; // CW25QWear
+
+#endif // CW25Q_WEAR_HPP
@@ -0,0 +1,142 @@
+// Duino/Common/Host/HS_ADC.hpp - AVR ADC hardware model for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_ADC_HPP
+#define HS_ADC_HPP
+
+#include "HS_Arduino.hpp"
+
+// Stands in for the ATmega ADC so that AVR/DA_Analogue.hpp runs unmodified. A
+// conversion takes 13 ADC clocks (25 for the first after enable) latching ADMUX at
+// its start; in free running mode (ADATE, trigger source 0) the next conversion
+// starts as each completes, before the interrupt is serviced. poll() from the main
+// loop stands in for the interrupt; reading ADCSRA (spin wait) costs 4 core clocks.
+// Input values are set per mux input; the first conversion after the mux changes
+// returns the mean of previous & new values (incomplete settling).
+
+#define ADPS0  0
+#define ADIE   3
+#define ADIF   4
+#define ADATE  5
+#define ADSC   6
+#define ADEN   7
+#define MUX5   3
+
+#ifndef _BV
+#define _BV(b) (1 << (b))
+#endif
+
+#ifndef HS_ADC_CORE_CLK
+#define HS_ADC_CORE_CLK 16000000UL
+#endif
+
+#ifndef HS_AVR_SREG
+#define HS_AVR_SREG
+uint8_t SREG; // NB: no interrupt nesting on host
+void cli (void) { ; }
+void sei (void) { ; }
+#endif
+
+// <avr/sleep.h>
+#define SLEEP_MODE_ADC 1
+void set_sleep_mode (const uint8_t m) { ; }
+
+#ifndef SIGNAL // NB: ISR() clashes with TWM::ISR on host
+#define SIGNAL(v) void v (void)
+#endif
+void ADC_vect (void);
+
+uint8_t DIDR0, PORTC, DDRC;
+
+class CHostADC
+{
+protected:
+   uint64_t tDone;
+   uint16_t vPrev;
+   uint8_t cr, mux, muxPrev; // ADCSRA & latched ADMUX
+   bool conv, first;
+
+   uint32_t clkNs (void) const { const uint8_t ps= cr & 0x7; return(((uint64_t)(ps ? (1 << ps) : 2) * 1000000000) / HS_ADC_CORE_CLK); }
+
+   void begin (void)
+   {
+      mux= admux;
+      tDone= gHostClock.nowNs() + (first ? 25 : 13) * clkNs();
+      first= false; conv= true;
+   } // begin
+
+   uint16_t convert (void)
+   {
+      const uint16_t v= in[mux & 0x1F] & 0x3FF;
+      const uint16_t r= (mux != muxPrev) ? (v + vPrev) / 2 : v;
+      muxPrev= mux; vPrev= v;
+      return(r);
+   } // convert
+
+public:
+   class Ctrl // ADCSRA
+   {
+   public:
+      Ctrl& operator= (const int c);
+      Ctrl& operator|= (const int c);
+      Ctrl& operator&= (const int c);
+      operator uint8_t () const;
+   } ctrl;
+   uint16_t in[32], dr;
+   uint8_t admux, srb;
+   uint32_t nConv, nISR;
+
+   CHostADC (void) : tDone{0}, vPrev{0}, cr{0}, mux{0}, muxPrev{0xFF}, conv{false}, first{true}, dr{0}, admux{0}, srb{0}, nConv{0}, nISR{0}
+   {
+      for (int i=0; i<32; i++) { in[i]= 0; }
+   }
+
+   uint8_t status (void) const { return(cr | (conv ? _BV(ADSC) : 0)); }
+
+   void control (const uint8_t c)
+   {
+      if (0 == (c & _BV(ADEN))) { cr= c & ~_BV(ADSC); conv= false; first= true; return; }
+      cr= (c & ~(_BV(ADSC) | _BV(ADIF))) | (cr & ~c & _BV(ADIF)); // ADIF cleared by writing 1
+      if ((c & _BV(ADSC)) && !conv) { begin(); }
+   } // control
+
+   // Call from loop(): completes conversions due, stands in for the ADC interrupt
+   uint32_t poll (void)
+   {
+      uint32_t n= 0;
+      while (conv && (gHostClock.nowNs() >= tDone))
+      {
+         dr= convert();
+         nConv++; n++;
+         cr|= _BV(ADIF);
+         if ((cr & _BV(ADATE)) && (0 == (srb & 0x7))) { const uint64_t t= tDone; begin(); tDone= t + 13 * clkNs(); } // free running
+         else { conv= false; }
+         if (cr & _BV(ADIE)) { cr&= ~_BV(ADIF); nISR++; ADC_vect(); }
+      }
+      return(n);
+   } // poll
+
+   // Spin wait cost
+   void spin (void) { gHostClock.advance(4000000000ULL / HS_ADC_CORE_CLK); poll(); }
+
+   // sleep_cpu(): until next conversion complete
+   void sleep (void) { if (conv) { gHostClock.advanceTo(tDone); } poll(); }
+}; // CHostADC
+
+CHostADC gHostADC;
+
+CHostADC::Ctrl& CHostADC::Ctrl::operator= (const int c) { gHostADC.control(c); return(*this); }
+CHostADC::Ctrl& CHostADC::Ctrl::operator|= (const int c) { gHostADC.control(gHostADC.status() | c); return(*this); }
+CHostADC::Ctrl& CHostADC::Ctrl::operator&= (const int c) { gHostADC.control(gHostADC.status() & c); return(*this); }
+CHostADC::Ctrl::operator uint8_t () const { gHostADC.spin(); return(gHostADC.status()); }
+
+void sleep_cpu (void) { gHostADC.sleep(); }
+
+#define ADCSRA gHostADC.ctrl
+#define ADCSRB gHostADC.srb
+#define ADMUX  gHostADC.admux
+#define ADCW   gHostADC.dr
+
+#endif // HS_ADC_HPP
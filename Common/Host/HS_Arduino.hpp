@@ -0,0 +1,353 @@
+// Duino/Common/Host/HS_Arduino.hpp - Minimal Arduino core emulation for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_ARDUINO_HPP
+#define HS_ARDUINO_HPP
+
+// Just enough of the Arduino API to let the portable parts of Duino/Common compile
+// under g++ on a PC, so that hot paths can be profiled & regression checked off-target.
+// The "sketch" includes this first, then any HS_SPI / HS_Wire transport, then the
+// Common headers of interest, and supplies setup() & loop() as usual.
+// Time is virtual: millis()/micros() report a nanosecond counter that only advances
+// through delay*(), simulated bus traffic or explicit calls to gHostClock.advance().
+// Wall clock (host CPU) time is available separately for throughput measurement.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#ifndef ASSERT
+#define ASSERT(x) ((void)0)
+#endif
+
+#ifndef RAM_BASE
+#define RAM_BASE  ((uintptr_t)0)
+#endif
+
+// Arduino style (macro) helpers, caveat multiple evaluation
+#ifndef min
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
+#define constrain(v,l,h) ((v)<(l)?(l):((v)>(h)?(h):(v)))
+
+void noInterrupts (void) { ; }
+void interrupts (void) { ; }
+
+/***/
+
+// Virtual time base (ns resolution, 64bit so never wraps in practice)
+class CHostClock
+{
+   uint64_t tV;   // virtual
+   uint64_t tW0;  // wall clock reference
+
+public:
+   CHostClock (void) : tV{0} { tW0= wallNs(); }
+
+   uint64_t wallNs (void) const
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+   } // wallNs
+
+   uint64_t nowNs (void) const { return(tV); }
+   void advance (const uint64_t dtNs) { tV+= dtNs; }
+   void advanceTo (const uint64_t tNs) { if (tNs > tV) { tV= tNs; } }
+
+   // Elapsed host CPU time since construction (or last resetWall)
+   uint64_t wallElapsedNs (void) const { return(wallNs() - tW0); }
+   void resetWall (void) { tW0= wallNs(); }
+}; // CHostClock
+
+CHostClock gHostClock;
+
+uint32_t millis (void) { return(gHostClock.nowNs() / 1000000); }
+uint32_t micros (void) { return(gHostClock.nowNs() / 1000); }
+void delay (uint32_t ms) { gHostClock.advance((uint64_t)ms * 1000000); }
+void delayMicroseconds (uint32_t us) { gHostClock.advance((uint64_t)us * 1000); }
+void yield (void) { ; }
+
+/***/
+
+// Pin state with optional change listener (e.g. SPI chip select of a device model)
+#ifndef HS_NUM_PINS
+#define HS_NUM_PINS 64
+#endif
+#ifndef SS
+#define SS 10
+#endif
+
+class CHostPinListener
+{
+public:
+   virtual void pinChange (const uint8_t pin, const uint8_t v) = 0;
+}; // CHostPinListener
+
+class CHostPins
+{
+   uint8_t mode[HS_NUM_PINS], level[HS_NUM_PINS];
+   CHostPinListener *pL[HS_NUM_PINS];
+
+public:
+   CHostPins (void)
+   {
+      for (int i=0; i<HS_NUM_PINS; i++) { mode[i]= INPUT; level[i]= HIGH; pL[i]= NULL; }
+   }
+
+   void attach (const uint8_t pin, CHostPinListener *p) { if (pin < HS_NUM_PINS) { pL[pin]= p; } }
+
+   void setMode (const uint8_t pin, const uint8_t m) { if (pin < HS_NUM_PINS) { mode[pin]= m; } }
+
+   void set (const uint8_t pin, const uint8_t v)
+   {
+      if (pin < HS_NUM_PINS)
+      {
+         const uint8_t l= (v != LOW);
+         if (level[pin] != l)
+         {
+            level[pin]= l;
+            if (pL[pin]) { pL[pin]->pinChange(pin,l); }
+         }
+      }
+   } // set
+
+   uint8_t get (const uint8_t pin) const { if (pin < HS_NUM_PINS) { return(level[pin]); } return(LOW); }
+}; // CHostPins
+
+CHostPins gHostPins;
+
+void pinMode (uint8_t pin, uint8_t m) { gHostPins.setMode(pin,m); }
+void digitalWrite (uint8_t pin, uint8_t v) { gHostPins.set(pin,v); }
+int digitalRead (uint8_t pin) { return gHostPins.get(pin); }
+
+/***/
+
+class Print
+{
+protected:
+   size_t printU (uint64_t u, int base)
+   {
+      char b[66];
+      int i= sizeof(b);
+      if ((base < 2) || (base > 36)) { base= 10; }
+      b[--i]= 0x00;
+      do
+      {
+         const uint8_t d= u % base;
+         b[--i]= (d < 10) ? ('0' + d) : ('A' + d - 10);
+         u/= base;
+      } while (u > 0);
+      return write(b+i);
+   } // printU
+
+   size_t printS (int64_t v, int base)
+   {
+      if ((v < 0) && (DEC == base)) { return write('-') + printU(-v, base); }
+      return printU(v, base);
+   } // printS
+
+public:
+   virtual size_t write (uint8_t b) = 0;
+   virtual size_t write (const uint8_t b[], size_t n)
+   {
+      size_t i= 0;
+      while ((i < n) && write(b[i])) { ++i; }
+      return(i);
+   } // write
+   size_t write (const char *s) { return(s ? write((const uint8_t*)s, strlen(s)) : 0); }
+   size_t write (const char *s, size_t n) { return write((const uint8_t*)s, n); }
+   virtual void flush (void) { ; }
+
+   size_t print (const char s[]) { return write(s); }
+   size_t print (char c) { return write((uint8_t)c); }
+   size_t print (unsigned char u, int base=DEC) { return printU(u, base); }
+   size_t print (int i, int base=DEC) { return printS(i, base); }
+   size_t print (unsigned int u, int base=DEC) { return printU(u, base); }
+   size_t print (long i, int base=DEC) { return printS(i, base); }
+   size_t print (unsigned long u, int base=DEC) { return printU(u, base); }
+   size_t print (long long i, int base=DEC) { return printS(i, base); }
+   size_t print (unsigned long long u, int base=DEC) { return printU(u, base); }
+   size_t print (double f, int dp=2)
+   {
+      char b[48];
+      snprintf(b, sizeof(b), "%.*f", dp, f);
+      return write(b);
+   } // print (double
+
+   size_t println (void) { return write("\r\n"); }
+   template<typename T> size_t println (T v) { size_t n= print(v); return(n + println()); }
+   template<typename T> size_t println (T v, int f) { size_t n= print(v,f); return(n + println()); }
+}; // Print
+
+class Stream : public Print
+{
+protected:
+   uint32_t timeout;
+
+public:
+   Stream (void) : timeout{1000} { ; }
+
+   virtual int available (void) = 0;
+   virtual int read (void) = 0;
+   virtual int peek (void) = 0;
+
+   void setTimeout (uint32_t ms) { timeout= ms; }
+
+   // NB: no blocking on host, returns what is available
+   size_t readBytes (uint8_t b[], size_t n)
+   {
+      size_t i= 0;
+      while (i < n)
+      {
+         int c= read();
+         if (c < 0) { break; }
+         b[i++]= c;
+      }
+      return(i);
+   } // readBytes
+   size_t readBytes (char b[], size_t n) { return readBytes((uint8_t*)b, n); }
+}; // Stream
+
+// Stream over a pair of memory ring buffers: what is written goes to the tx ring,
+// what is read comes from the rx ring. Host code injects/collects via the "far side"
+// methods. When constructed with loop=true the two rings are one (echo).
+#ifndef HS_STREAM_BYTES
+#define HS_STREAM_BYTES 4096
+#endif
+
+class CMemStream : public Stream
+{
+   struct Ring
+   {
+      uint8_t b[HS_STREAM_BYTES];
+      uint32_t iW, iR, lost;
+
+      Ring (void) : iW{0}, iR{0}, lost{0} { ; }
+
+      int count (void) const { return(iW - iR); }
+      bool put (const uint8_t v)
+      {
+         if (count() >= HS_STREAM_BYTES) { ++lost; return(false); }
+         b[iW++ % HS_STREAM_BYTES]= v;
+         return(true);
+      }
+      int get (void) { if (count() > 0) { return b[iR++ % HS_STREAM_BYTES]; } return(-1); }
+      int peek (void) const { if (count() > 0) { return b[iR % HS_STREAM_BYTES]; } return(-1); }
+   }; // Ring
+
+   Ring r[2];
+   Ring *pT, *pR;
+
+public:
+   CMemStream (bool loop=false) { pT= r+0; pR= r + !loop; }
+
+   size_t write (uint8_t v) { return pT->put(v); }
+   using Print::write;
+
+   int available (void) { return pR->count(); }
+   int read (void) { return pR->get(); }
+   int peek (void) { return pR->peek(); }
+
+   // far side
+   int inject (const uint8_t b[], const int n) { int i=0; while ((i < n) && pR->put(b[i])) { ++i; } return(i); }
+   int inject (const char *s) { return inject((const uint8_t*)s, strlen(s)); }
+   int pending (void) const { return pT->count(); }
+   int collect (uint8_t b[], const int n) { int i=0, c; while ((i < n) && ((c= pT->get()) >= 0)) { b[i++]= c; } return(i); }
+   uint32_t lost (void) const { return(pT->lost + pR->lost); }
+}; // CMemStream
+
+// Console serial port: output to stdout, input from a memory ring (inject() for scripted input)
+class HardwareSerial : public Stream
+{
+   CMemStream in;
+   FILE *pF;
+
+public:
+   HardwareSerial (FILE *f=stdout) : pF{f} { ; }
+
+   void begin (uint32_t baud, uint8_t cfg=0) { ; }
+   void end (void) { ; }
+   operator bool () const { return(true); }
+
+   size_t write (uint8_t v) { return(EOF != fputc(v,pF)); }
+   size_t write (const uint8_t b[], size_t n) { return fwrite(b,1,n,pF); }
+   using Print::write;
+   void flush (void) { fflush(pF); }
+
+   int available (void) { return in.available(); }
+   int read (void) { return in.read(); }
+   int peek (void) { return in.peek(); }
+
+   int inject (const char *s) { return in.inject(s); }
+}; // HardwareSerial
+
+HardwareSerial Serial, Serial1;
+
+#ifndef SERIAL_TYPE
+#define SERIAL_TYPE HardwareSerial
+#endif
+
+/***/
+
+// Sketch entry points and run control: loop() is called until hostStop()
+void setup (void);
+void loop (void);
+
+class CHostRun
+{
+public:
+   uint32_t nLoop, maxLoop;
+   int code;
+
+   CHostRun (void) : nLoop{0}, maxLoop{0}, code{-1} { ; }
+
+   bool running (void) const { return((code < 0) && ((0 == maxLoop) || (nLoop < maxLoop))); }
+}; // CHostRun
+
+CHostRun gHostRun;
+
+void hostStop (int code=0) { gHostRun.code= code; }
+
+#ifndef HS_NO_MAIN
+int main (int argc, char *argv[])
+{
+   if (argc > 1) { gHostRun.maxLoop= atoi(argv[1]); }
+   setup();
+   while (gHostRun.running()) { loop(); gHostRun.nLoop++; }
+   Serial.flush();
+   return(gHostRun.code > 0 ? gHostRun.code : 0);
+} // main
+#endif // HS_NO_MAIN
+
+#endif // HS_ARDUINO_HPP
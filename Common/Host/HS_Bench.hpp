@@ -0,0 +1,49 @@
+// Duino/Common/Host/HS_Bench.hpp - Throughput measurement helper for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_BENCH_HPP
+#define HS_BENCH_HPP
+
+#include "HS_Arduino.hpp"
+
+// Measures both host CPU (wall) time and virtual (simulated device/bus) time over
+// an interval, then reports throughput. Wall time indicates code efficiency, virtual
+// time indicates what the target would see given the modelled bus & device timing.
+class CHostBench
+{
+   uint64_t w0, v0;
+
+public:
+   uint64_t wallNs, virtNs, bytes;
+
+   CHostBench (void) : wallNs{0}, virtNs{0}, bytes{0} { start(); }
+
+   void start (void) { w0= gHostClock.wallNs(); v0= gHostClock.nowNs(); }
+
+   void stop (const uint64_t nB)
+   {
+      wallNs= gHostClock.wallNs() - w0;
+      virtNs= gHostClock.nowNs() - v0;
+      bytes= nB;
+   } // stop
+
+   // Bytes per second over an interval, 0 where undefined
+   static double rate (const uint64_t nB, const uint64_t ns) { if (ns > 0) { return((1E9 * nB) / ns); } return(0); }
+
+   void report (Stream& s, const char *label)
+   {
+      s.print(label); s.print(": "); s.print((unsigned long long)bytes); s.print("B wall=");
+      s.print(wallNs * 1E-6, 3); s.print("ms ");
+      s.print(rate(bytes,wallNs) * 1E-6, 2); s.print("MB/s");
+      if (virtNs > 0)
+      {
+         s.print(" virt="); s.print(virtNs * 1E-6, 3); s.print("ms ");
+         s.print(rate(bytes,virtNs) * 1E-3, 1); s.print("kB/s");
+      }
+      s.println();
+   } // report
+}; // CHostBench
+
+#endif // HS_BENCH_HPP
@@ -0,0 +1,47 @@
+// Duino/Common/Host/HS_CRC.hpp - STM32 (F1/F4) CRC peripheral model for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_CRC_HPP
+#define HS_CRC_HPP
+
+#include "HS_Arduino.hpp"
+
+#ifndef HOST_CRC_WORD_NS
+#define HOST_CRC_WORD_NS 48 // 4 AHB clocks at 84MHz
+#endif
+
+// Same interface as HWCRC (ST_Util.hpp): 32bit words MSB first, polynomial
+// 0x04C11DB7, reset to 0xFFFFFFFF, no reflection or inversion.
+class CHostCRC
+{
+   uint32_t dr;
+
+public:
+   uint32_t nWords;
+
+   CHostCRC (bool on=true) : dr{0xFFFFFFFF}, nWords{0} { ; }
+
+   void power (uint8_t state=1) { ; }
+   void reset (void) { dr= 0xFFFFFFFF; }
+   uint32_t idr (void) { return(0); }
+
+   uint32_t add (const uint32_t w)
+   {
+      dr^= w;
+      for (int i= 0; i < 32; i++) { dr= (dr & 0x80000000) ? (dr << 1) ^ 0x04C11DB7 : (dr << 1); }
+      gHostClock.advance(HOST_CRC_WORD_NS);
+      nWords++;
+      return(0);
+   } // add
+
+   uint32_t get (bool rst=true)
+   {
+      const uint32_t r= dr;
+      if (rst) { reset(); }
+      return(r);
+   } // get
+}; // CHostCRC
+
+#endif // HS_CRC_HPP
@@ -0,0 +1,252 @@
+// Duino/Common/Host/HS_I2CDev.hpp - Scripted I2C slave models for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_I2CDEV_HPP
+#define HS_I2CDEV_HPP
+
+#include "HS_Wire.hpp"
+
+// Serial EEPROM (24Cxx / CAT24C): big endian word address, writes wrap within the
+// page and start a write cycle at stop, during which the device does not
+// acknowledge its address (ACK polling).
+class CHostEEPROM : public CHostI2CDev
+{
+protected:
+   uint8_t *pM;
+   uint32_t nM, a;
+   uint64_t tBusy;
+   uint16_t page;
+   uint8_t nA, iA, nW;
+
+public:
+   uint32_t tWRNs, nCycle, nPoll;
+
+   CHostEEPROM (uint8_t m[], const uint32_t n, const uint16_t pg=32, const uint8_t devAddr=0x50, const uint8_t addrBytes=2) :
+      CHostI2CDev(devAddr), pM{m}, nM{n}, a{0}, tBusy{0}, page{pg}, nA{addrBytes}, iA{0}, nW{0},
+      tWRNs{5000000}, nCycle{0}, nPoll{0} { memset(pM, 0xFF, nM); }
+
+   bool busy (void) const { return(gHostClock.nowNs() < tBusy); }
+
+   bool start (const bool rd)
+   {
+      if (busy()) { nPoll++; return(false); }
+      iA= rd ? nA : 0; nW= 0;
+      return(true);
+   } // start
+
+   bool write (const uint8_t b)
+   {
+      if (iA < nA) { a= (iA > 0) ? (a << 8) | b : b; iA++; return(true); }
+      pM[a % nM]= b;
+      a= (a & ~(uint32_t)(page-1)) | ((a + 1) & (page-1)); // page roll over
+      nW++;
+      return(true);
+   } // write
+
+   uint8_t read (const bool ack) { const uint8_t b= pM[a % nM]; a= (a + 1) % nM; return(b); }
+
+   void stop (void)
+   {
+      if (nW > 0) { tBusy= gHostClock.nowNs() + tWRNs; nCycle++; nW= 0; }
+   } // stop
+}; // CHostEEPROM
+
+// DS1307 style RTC: 64 byte register file (8 BCD time registers, battery backed RAM)
+// with auto-increment pointer. Seconds, minutes & hours (24h) advance with virtual
+// time (scaled by crystal error ppm) from the last write of the time registers,
+// which resets the divider chain (no date roll over). The 1Hz square wave output
+// (SQWE) falls as seconds increment.
+class CHostRTC : public CHostI2CDev
+{
+protected:
+   uint64_t t0;
+   uint32_t s0;
+   uint8_t r[64], p;
+   bool first, setT;
+
+   static uint8_t bcd (const uint8_t v) { return(((v / 10) << 4) | (v % 10)); }
+   static uint8_t bin (const uint8_t b) { return((b >> 4) * 10 + (b & 0xF)); }
+
+   // Elapsed RTC time (ns) since base
+   uint64_t el (void) const { return((gHostClock.nowNs() - t0) + (int64_t)(gHostClock.nowNs() - t0) * ppm / 1000000); }
+
+   void tick (void)
+   {
+      if (r[0] & 0x80) { return; } // clock halt
+      const uint32_t s= (s0 + el() / 1000000000) % 86400;
+      r[0]= bcd(s % 60);
+      r[1]= bcd((s / 60) % 60);
+      r[2]= bcd(s / 3600);
+   } // tick
+
+public:
+   int32_t ppm;
+
+   CHostRTC (const uint8_t devAddr=0x68) : CHostI2CDev(devAddr), t0{0}, s0{0}, p{0}, first{false}, setT{false}, ppm{0}
+   {
+      memset(r, 0, sizeof(r));
+      r[3]= r[4]= r[5]= 1; // day, date, month
+   }
+
+   uint8_t *reg (void) { return(r); }
+
+   // Exact time of day (ms) for comparison
+   uint32_t msOfDay (void) const { return((s0 * 1000 + el() / 1000000) % 86400000); }
+
+   uint8_t sqw (void) const
+   {
+      if (0 == (r[7] & 0x10)) { return(r[7] >> 7); } // OUT level
+      return((el() % 1000000000) < 500000000 ? 0 : 1);
+   } // sqw
+
+   bool start (const bool rd) { if (rd) { tick(); } first= !rd; return(true); }
+
+   bool write (const uint8_t b)
+   {
+      if (first) { p= b & 0x3F; first= false; return(true); }
+      r[p]= b;
+      setT|= (p < 3);
+      p= (p + 1) & 0x3F;
+      return(true);
+   } // write
+
+   uint8_t read (const bool ack) { const uint8_t b= r[p]; p= (p + 1) & 0x3F; return(b); }
+
+   void stop (void)
+   {
+      if (setT)
+      {
+         s0= bin(r[0] & 0x7F) + 60 * bin(r[1]) + 3600 * bin(r[2] & 0x3F);
+         t0= gHostClock.nowNs();
+         setT= false;
+      }
+   } // stop
+}; // CHostRTC
+
+// MAX30102 style pulse oximeter replaying a recorded FIFO dump (raw FIFO bytes, 3
+// per LED, cycled) at the configured sample rate in virtual time: 32 sample FIFO
+// with pointer & overflow registers (roll over optional), almost full & sample
+// ready interrupts (status cleared on read, almost full also by FIFO read),
+// register auto-increment except at the FIFO data register.
+class CHostMAX30102 : public CHostI2CDev
+{
+protected:
+   enum Reg : uint8_t { INTS1, INTS2, INTE1, INTE2, FWRI, FOVC, FRDI, FDAT, FCON, MCON, SCON };
+   const uint8_t *pR;
+   uint32_t nR, iR;
+   uint64_t tS;
+   uint8_t r[0x22], f[32][6];
+   uint8_t p, wr, rd, n, iB;
+   bool first;
+
+   uint8_t bytes (void) const { return(((r[MCON] & 0x7) == 0x2) ? 3 : 6); } // HR: red only
+   bool active (void) const { const uint8_t m= r[MCON] & 0x7; return((0 == (r[MCON] & 0x80)) && ((0x2 == m) || (0x3 == m))); }
+   uint64_t periodNs (void) const
+   {
+      static const uint16_t sr[]= {50, 100, 200, 400, 800, 1000, 1600, 3200};
+      return(((uint64_t)1000000000 << min(r[FCON] >> 5, 5)) / sr[(r[SCON] >> 2) & 0x7]);
+   } // periodNs
+
+   void push (void)
+   {
+      nSample++;
+      if (n >= 32)
+      {
+         if (0 == (r[FCON] & 0x10)) { if (r[FOVC] < 0x1F) { r[FOVC]++; } nLost++; return; }
+         rd= (rd + 1) & 31; n--; nLost++; // roll over
+      }
+      for (uint8_t i= 0; i < bytes(); i++) { f[wr][i]= pR[iR]; iR= (iR + 1) % nR; }
+      wr= (wr + 1) & 31; n++;
+      r[INTS1]|= 0x40; // PPG_RDY
+      if (n >= (32 - (r[FCON] & 0xF))) { r[INTS1]|= 0x80; } // A_FULL
+   } // push
+
+   void restart (void) { tS= gHostClock.nowNs() + periodNs(); }
+
+public:
+   uint32_t nSample, nLost;
+
+   CHostMAX30102 (const uint8_t rec[], const uint32_t nRec, const uint8_t devAddr=0x57) :
+      CHostI2CDev(devAddr), pR{rec}, nR{nRec}, iR{0}, tS{0}, p{0}, wr{0}, rd{0}, n{0}, iB{0}, first{false}, nSample{0}, nLost{0}
+   {
+      memset(r, 0, sizeof(r));
+      r[INTS1]= 0x01; // PWR_RDY
+   }
+
+   // Sample production up to now
+   void update (void)
+   {
+      if (!active()) { return; }
+      const uint64_t t= gHostClock.nowNs(), d= periodNs();
+      while (t >= tS) { push(); tS+= d; }
+   } // update
+
+   // INT pin (active low)
+   uint8_t intPin (void) { update(); return(0 == (r[INTS1] & (r[INTE1] | 0x01))); }
+
+   uint8_t held (void) const { return(n); }
+
+   bool start (const bool rd) { update(); first= !rd; return(true); }
+
+   bool write (const uint8_t b)
+   {
+      if (first) { p= b; first= false; return(true); }
+      if (p >= sizeof(r)) { return(false); }
+      switch(p)
+      {
+         case FWRI : wr= b & 31; n= (wr - rd) & 31; break;
+         case FRDI : rd= b & 31; n= (wr - rd) & 31; iB= 0; break;
+         case FOVC : r[FOVC]= b & 0x1F; break;
+         case MCON :
+            if (b & 0x40) { memset(r, 0, sizeof(r)); wr= rd= n= iB= 0; } // reset
+            r[MCON]= b & ~0x40;
+            break;
+         default : r[p]= b; break;
+      }
+      if ((p >= FCON) && (p <= SCON)) { restart(); }
+      if (FDAT != p) { p++; }
+      return(true);
+   } // write
+
+   uint8_t read (const bool ack)
+   {
+      uint8_t b= 0;
+      switch(p)
+      {
+         case FWRI : b= wr; break;
+         case FRDI : b= rd; break;
+         case FDAT :
+            if (0 == n) { return(0); } // empty
+            b= f[rd][iB];
+            if (++iB >= bytes()) { iB= 0; rd= (rd + 1) & 31; n--; r[INTS1]&= ~0x80; r[FOVC]= 0; }
+            return(b);
+         case 0xFE : return(0x03); // REV
+         case 0xFF : return(0x15); // ID
+         default : if (p < sizeof(r)) { b= r[p]; } break;
+      }
+      if ((INTS1 == p) || (INTS2 == p)) { r[p]= 0; } // clear on read
+      p++;
+      return(b);
+   } // read
+}; // CHostMAX30102
+
+// Misbehaving device: acknowledges nAck data bytes after its address (negative ->
+// address not acknowledged), reads return fill.
+class CHostNackDev : public CHostI2CDev
+{
+protected:
+   int16_t nAck, iW;
+
+public:
+   uint8_t fill;
+
+   CHostNackDev (const uint8_t devAddr, const int16_t n=0, const uint8_t f=0xFF) : CHostI2CDev(devAddr), nAck{n}, iW{0}, fill{f} { ; }
+
+   bool start (const bool rd) { iW= 0; return(nAck >= 0); }
+   bool write (const uint8_t b) { return(iW++ < nAck); }
+   uint8_t read (const bool ack) { return(fill); }
+}; // CHostNackDev
+
+#endif // HS_I2CDEV_HPP
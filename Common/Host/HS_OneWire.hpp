@@ -0,0 +1,289 @@
+// Duino/Common/Host/HS_OneWire.hpp - Pluggable one wire (OneWire library) bus for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_ONEWIRE_HPP
+#define HS_ONEWIRE_HPP
+
+#define OneWire_h // NB: suppresses #include <OneWire.h> in CDS18.hpp
+
+#include "HS_Arduino.hpp"
+
+// Byte level slave model: the bus resolves ROM commands (match, skip, search) and
+// passes function command & data bytes to selected devices only. Reads from several
+// selected devices are wired-AND, unselected devices leave the bus high.
+class CHostOneWireDev
+{
+public:
+   uint8_t rom[8]; // family, serial (6), CRC8
+   bool sel;
+
+   CHostOneWireDev (void) : sel{false} { memset(rom, 0, sizeof(rom)); }
+
+   bool romBit (const uint8_t i) const { return((rom[i >> 3] >> (i & 0x7)) & 0x1); }
+
+   virtual void reset (void) { ; }
+   virtual void write (const uint8_t b) = 0;
+   virtual uint8_t read (void) { return(0xFF); }
+   virtual uint8_t readBit (void) { return(read() & 0x1); }
+}; // CHostOneWireDev
+
+#ifndef HS_OW_MAX_DEV
+#define HS_OW_MAX_DEV 32
+#endif
+
+// Mimics the OneWire library (standard speed): reset ~960us, time slots ~65us, charged
+// to the virtual clock.
+class OneWire
+{
+protected:
+   CHostOneWireDev *pD[HS_OW_MAX_DEV];
+   uint8_t rom[8], iM, phase; // match ROM buffer & index
+   uint8_t sRom[8], lastDisc;   // search state
+   bool lastDev, power;
+
+   enum Phase : uint8_t { ROM_CMD, MATCH, FUNC };
+
+   void slots (const uint16_t n) { gHostClock.advance((uint64_t)n * 65000); }
+
+   // wired-AND of (selected) devices: bit i of ROM or its complement
+   uint8_t searchBit (const uint8_t i, const bool cmp) const
+   {
+      uint8_t v= 1;
+      for (int j=0; j<HS_OW_MAX_DEV; j++) { if (pD[j] && pD[j]->sel) { v&= pD[j]->romBit(i) ^ cmp; } }
+      return(v);
+   } // searchBit
+
+public:
+   uint32_t nReset, nByte;
+
+   OneWire (const uint8_t pin=0) : iM{0}, phase{ROM_CMD}, lastDisc{0}, lastDev{false}, power{false}, nReset{0}, nByte{0}
+   {
+      for (int i=0; i<HS_OW_MAX_DEV; i++) { pD[i]= NULL; }
+   }
+
+   bool attach (CHostOneWireDev *p)
+   {
+      for (int i=0; i<HS_OW_MAX_DEV; i++)
+      {
+         if (NULL == pD[i]) { pD[i]= p; return(true); }
+      }
+      return(false);
+   } // attach
+
+   void detach (CHostOneWireDev *p) { for (int i=0; i<HS_OW_MAX_DEV; i++) { if (p == pD[i]) { pD[i]= NULL; } } }
+
+   void begin (const uint8_t pin) { ; }
+
+   // Presence pulse from any device
+   uint8_t reset (void)
+   {
+      uint8_t r= 0;
+      gHostClock.advance(960000);
+      nReset++;
+      phase= ROM_CMD; power= false;
+      for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i]) { pD[i]->sel= false; pD[i]->reset(); r= 1; } }
+      return(r);
+   } // reset
+
+   void write (const uint8_t v, const uint8_t p=0)
+   {
+      slots(8);
+      nByte++;
+      power= p;
+      switch(phase)
+      {
+         case ROM_CMD :
+            if (0x55 == v) { phase= MATCH; iM= 0; }
+            else
+            {
+               const bool skip= (0xCC == v);
+               for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i]) { pD[i]->sel= skip; } }
+               phase= FUNC;
+            }
+            break;
+         case MATCH :
+            rom[iM++]= v;
+            if (iM >= 8)
+            {
+               for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i]) { pD[i]->sel= (0 == memcmp(rom, pD[i]->rom, 8)); } }
+               phase= FUNC;
+            }
+            break;
+         default :
+            for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i] && pD[i]->sel) { pD[i]->write(v); } }
+            break;
+      }
+   } // write
+
+   void write_bytes (const uint8_t *b, const uint16_t n, const bool p=0) { for (uint16_t i=0; i<n; i++) { write(b[i], p); } }
+
+   uint8_t read (void)
+   {
+      uint8_t v= 0xFF;
+      slots(8);
+      nByte++;
+      for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i] && pD[i]->sel) { v&= pD[i]->read(); } }
+      return(v);
+   } // read
+
+   void read_bytes (uint8_t *b, const uint16_t n) { for (uint16_t i=0; i<n; i++) { b[i]= read(); } }
+
+   uint8_t read_bit (void)
+   {
+      uint8_t v= 1;
+      slots(1);
+      for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i] && pD[i]->sel) { v&= pD[i]->readBit(); } }
+      return(v);
+   } // read_bit
+
+   void write_bit (const uint8_t v) { slots(1); }
+
+   void select (const uint8_t r[8]) { write(0x55); for (int i=0; i<8; i++) { write(r[i]); } }
+
+   void skip (void) { write(0xCC); }
+
+   void depower (void) { power= false; }
+
+   bool powered (void) const { return(power); }
+
+   void reset_search (void) { lastDisc= 0; lastDev= false; memset(sRom, 0, sizeof(sRom)); }
+
+   // Maxim search algorithm (as the library) over the devices' ROM bits
+   bool search (uint8_t *newAddr, const bool searchMode=true)
+   {
+      uint8_t lastZero= 0;
+      if (lastDev || !reset()) { reset_search(); return(false); }
+      write(searchMode ? 0xF0 : 0xEC);
+      for (int i=0; i<HS_OW_MAX_DEV; i++) { if (pD[i]) { pD[i]->sel= true; } } // all participate
+      for (uint8_t i= 0; i < 64; i++)
+      {
+         const uint8_t b= searchBit(i, false), c= searchBit(i, true);
+         uint8_t d;
+         slots(3);
+         if (b && c) { reset_search(); return(false); } // no devices
+         if (b != c) { d= b; }
+         else
+         {
+            if ((i+1) < lastDisc) { d= (sRom[i >> 3] >> (i & 0x7)) & 0x1; }
+            else { d= ((i+1) == lastDisc); }
+            if (0 == d) { lastZero= i+1; }
+         }
+         if (d) { sRom[i >> 3]|= 1 << (i & 0x7); } else { sRom[i >> 3]&= ~(1 << (i & 0x7)); }
+         for (int j=0; j<HS_OW_MAX_DEV; j++) { if (pD[j] && pD[j]->sel) { pD[j]->sel= (pD[j]->romBit(i) == d); } }
+      }
+      lastDisc= lastZero;
+      lastDev= (0 == lastDisc);
+      if (0 == sRom[0]) { reset_search(); return(false); }
+      memcpy(newAddr, sRom, 8);
+      phase= ROM_CMD;
+      return(true);
+   } // search
+
+   // Dallas/Maxim (reflected 0x8C)
+   static uint8_t crc8 (const uint8_t *b, uint8_t n)
+   {
+      uint8_t c= 0;
+      while (n-- > 0)
+      {
+         uint8_t v= *b++;
+         for (uint8_t i= 0; i < 8; i++)
+         {
+            const uint8_t m= (c ^ v) & 0x01;
+            c>>= 1;
+            if (m) { c^= 0x8C; }
+            v>>= 1;
+         }
+      }
+      return(c);
+   } // crc8
+}; // OneWire
+
+// DS18B20 temperature probe: scratchpad (temperature, TH, TL, configuration, CRC),
+// resolution dependent conversion time (93.75ms << (R - 9)), conversion status by
+// read time slot, power supply query. Temperature is set in 1/16 C; corrupt > 0
+// damages that many subsequent scratchpad reads (one bit). Family 0x10 (DS18S20):
+// half degree reading with count remain (exact for (t16 & 0xF) <= 12), fixed
+// 750ms conversion, scratchpad write of TH & TL only.
+class CHostDS18B20 : public CHostOneWireDev
+{
+protected:
+   uint64_t tDone;
+   uint8_t sp[9], cmd, i;
+   bool conv;
+
+   void update (void)
+   {
+      if (conv && (gHostClock.nowNs() >= tDone))
+      {
+         int16_t v;
+         if (s20()) { v= t16 >> 3; sp[6]= 12 - (t16 & 0xF); }
+         else { v= t16 & ~((1 << (3 - ((sp[4] >> 5) & 0x3))) - 1); } // undefined low bits -> 0
+         sp[0]= v; sp[1]= v >> 8;
+         sp[8]= OneWire::crc8(sp, 8);
+         conv= false;
+      }
+   } // update
+
+   bool s20 (void) const { return(0x10 == rom[0]); }
+
+public:
+   int16_t t16;
+   uint8_t corrupt;
+   bool parasite;
+
+   CHostDS18B20 (const uint8_t family=0x28, const uint32_t serial=0) : tDone{0}, cmd{0}, i{0}, conv{false}, t16{0}, corrupt{0}, parasite{false}
+   {
+      rom[0]= family;
+      for (int j=1; j<7; j++) { rom[j]= (j < 5) ? serial >> (8 * (j-1)) : 0; }
+      rom[7]= OneWire::crc8(rom, 7);
+      const uint8_t s[2][8]= {
+         {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10},  // power on: 85C, 12 bit
+         {0xAA, 0x00, 0x4B, 0x46, 0xFF, 0xFF, 0x0C, 0x10} }; // S20: 85C
+      memcpy(sp, s[s20()], 8);
+      sp[8]= OneWire::crc8(sp, 8);
+   }
+
+   void reset (void) { update(); cmd= 0; }
+
+   void write (const uint8_t b)
+   {
+      update();
+      const uint8_t nW= s20() ? 2 : 3;
+      if ((0x4E == cmd) && (i < nW))
+      {
+         sp[2+i]= (2 == i) ? ((b & 0x60) | 0x1F) : b;
+         if (++i >= nW) { sp[8]= OneWire::crc8(sp, 8); }
+         return;
+      }
+      cmd= b; i= 0;
+      if (0x44 == cmd) { conv= true; tDone= gHostClock.nowNs() + (93750000ULL << (s20() ? 3 : ((sp[4] >> 5) & 0x3))); }
+   } // write
+
+   uint8_t read (void)
+   {
+      update();
+      if ((0xBE == cmd) && (i < 9))
+      {
+         uint8_t b= sp[i];
+         if ((0 == i) && (corrupt > 0)) { b^= 0x04; corrupt--; }
+         i++;
+         return(b);
+      }
+      return(0xFF);
+   } // read
+
+   uint8_t readBit (void)
+   {
+      update();
+      switch(cmd)
+      {
+         case 0x44 : return(!conv);
+         case 0xB4 : return(!parasite);
+      }
+      return(read() & 0x1);
+   } // readBit
+}; // CHostDS18B20
+
+#endif // HS_ONEWIRE_HPP
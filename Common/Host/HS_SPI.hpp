@@ -0,0 +1,183 @@
+// Duino/Common/Host/HS_SPI.hpp - Pluggable SPI transport for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_SPI_HPP
+#define HS_SPI_HPP
+
+#include "HS_Arduino.hpp"
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+// Model supports two line (dual output) reads via transferDual()
+#define SPI_DUAL_READ
+
+class SPISettings
+{
+public:
+   uint32_t clock;
+   uint8_t order, mode;
+
+   SPISettings (uint32_t c=4000000, uint8_t o=MSBFIRST, uint8_t m=SPI_MODE0) : clock{c}, order{o}, mode{m} { ; }
+}; // SPISettings
+
+// Device model base: attach to a chip select pin, then see every byte clocked
+// while selected. Models may call gHostClock.advance() to emulate latency.
+class CHostSPIDev : public CHostPinListener
+{
+protected:
+   uint8_t ncs;
+
+public:
+   bool sel;
+
+   CHostSPIDev (void) : ncs{0xFF}, sel{false} { ; }
+
+   virtual void select (const bool active) { ; }
+   virtual uint8_t exchange (const uint8_t mosi) = 0;
+
+   void pinChange (const uint8_t pin, const uint8_t v)
+   {
+      if (pin == ncs) { sel= (LOW == v); select(sel); }
+   } // pinChange
+
+   void setPin (const uint8_t pin) { ncs= pin; }
+   uint8_t getPin (void) const { return(ncs); }
+}; // CHostSPIDev
+
+#ifndef HS_SPI_MAX_DEV
+#define HS_SPI_MAX_DEV 4
+#endif
+
+// Statistics for the bus: bytes moved, calls made and virtual time charged
+struct HostSPIStat
+{
+   uint64_t bytes, calls, wireNs;
+
+   HostSPIStat (void) { clear(); }
+   void clear (void) { bytes= calls= wireNs= 0; }
+}; // HostSPIStat
+
+class SPIClass
+{
+protected:
+   CHostSPIDev *pD[HS_SPI_MAX_DEV];
+   SPISettings set;
+   uint32_t bitNs100;   // 1/100 ns per bit, keeps sub-ns precision at high clock rates
+   uint32_t callNs;     // modelled fixed cost per transfer() call
+   uint64_t deferNs;    // time accumulated (rather than charged) for background transfers
+   bool defer;
+
+   uint8_t xfer1 (const uint8_t w)
+   {
+      uint8_t r= 0xFF;
+      for (int i=0; i<HS_SPI_MAX_DEV; i++)
+      {
+         if (pD[i] && pD[i]->sel) { r&= pD[i]->exchange(w); } // open drain style merge
+      }
+      return(r);
+   } // xfer1
+
+   void charge (const size_t n, const uint8_t bitsPerClk=1)
+   {
+      const uint64_t dt= ((uint64_t)n * (8 / bitsPerClk) * bitNs100) / 100;
+      stat.bytes+= n;
+      stat.calls++;
+      stat.wireNs+= dt;
+      if (defer) { deferNs+= dt + callNs; } else { gHostClock.advance(dt + callNs); }
+   } // charge
+
+public:
+   HostSPIStat stat;
+
+   SPIClass (void) : callNs{0}, deferNs{0}, defer{false}
+   {
+      for (int i=0; i<HS_SPI_MAX_DEV; i++) { pD[i]= NULL; }
+      beginTransaction(set);
+      endTransaction();
+   }
+
+   bool attach (CHostSPIDev *p, const uint8_t pinNCS)
+   {
+      for (int i=0; i<HS_SPI_MAX_DEV; i++)
+      {
+         if (NULL == pD[i])
+         {
+            pD[i]= p;
+            p->setPin(pinNCS);
+            gHostPins.attach(pinNCS, p);
+            return(true);
+         }
+      }
+      return(false);
+   } // attach
+
+   void detach (CHostSPIDev *p)
+   {
+      for (int i=0; i<HS_SPI_MAX_DEV; i++)
+      {
+         if (p == pD[i])
+         {
+            pD[i]= NULL;
+            gHostPins.attach(p->getPin(), NULL);
+         }
+      }
+   } // detach
+
+   // Background (e.g. DMA) transfers: accumulate wire time for the engine
+   // to schedule completion instead of advancing the clock immediately.
+   void setDefer (const bool d) { defer= d; }
+   uint64_t takeDeferred (void) { uint64_t t= deferNs; deferNs= 0; return(t); }
+
+   void setCallOverheadNs (const uint32_t ns) { callNs= ns; }
+   uint32_t getClock (void) const { return(set.clock); }
+
+   void begin (void) { ; }
+   void end (void) { ; }
+
+   void beginTransaction (const SPISettings& s)
+   {
+      set= s;
+      if (set.clock < 1000) { set.clock= 1000; }
+      bitNs100= 100000000000ULL / set.clock;
+   } // beginTransaction
+   void endTransaction (void) { ; }
+
+   uint8_t transfer (const uint8_t w)
+   {
+      charge(1);
+      return xfer1(w);
+   } // transfer
+
+   uint16_t transfer16 (const uint16_t w)
+   {
+      uint16_t r= xfer1(w >> 8) << 8;
+      r|= xfer1(w);
+      charge(2);
+      return(r);
+   } // transfer16
+
+   // In place read-write
+   void transfer (void *p, size_t n)
+   {
+      uint8_t *b= (uint8_t*)p;
+      for (size_t i=0; i<n; i++) { b[i]= xfer1(b[i]); }
+      charge(n);
+   } // transfer
+
+   // Receive only, two bits per clock (device drives IO0 & IO1)
+   void transferDual (void *p, size_t n)
+   {
+      uint8_t *b= (uint8_t*)p;
+      for (size_t i=0; i<n; i++) { b[i]= xfer1(0xFF); }
+      charge(n,2);
+   } // transferDual
+}; // SPIClass
+
+SPIClass SPI;
+
+#endif // HS_SPI_HPP
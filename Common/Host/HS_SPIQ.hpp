@@ -0,0 +1,52 @@
+// Duino/Common/Host/HS_SPIQ.hpp - Simulated background engine for SPI transaction queue
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_SPIQ_HPP
+#define HS_SPIQ_HPP
+
+#include "HS_SPI.hpp"
+#include "../SPITransQ.hpp"
+
+// Emulates a DMA engine: bytes are exchanged with the device model immediately
+// but completion is signalled only when virtual time reaches the end of the
+// wire transfer, so the main loop may run (and advance time) meanwhile.
+class CHostSPIQ : public SPIQ::SyncEngine
+{
+protected:
+   uint64_t tDone;
+   bool pend;
+
+   bool xfer (const uint8_t *pT, uint8_t *pR, const uint16_t n, const uint8_t fill)
+   {
+      SPI.setDefer(true);
+      SyncEngine::xfer(pT, pR, n, fill);
+      SPI.setDefer(false);
+      tDone= gHostClock.nowNs() + SPI.takeDeferred();
+      pend= true;
+      nXfer++;
+      return(false);
+   } // xfer
+
+public:
+   uint32_t nXfer;
+
+   CHostSPIQ (void) : tDone{0}, pend{false}, nXfer{0} { ; }
+
+   // Call from loop(): stands in for the DMA completion interrupt
+   void poll (void)
+   {
+      if (pend && (gHostClock.nowNs() >= tDone)) { pend= false; event(); }
+   } // poll
+
+   // Block until queue empty
+   void sync (void)
+   {
+      while (pend) { gHostClock.advanceTo(tDone); poll(); }
+   } // sync
+
+   uint64_t pendingUntil (void) const { return(pend ? tDone : 0); }
+}; // CHostSPIQ
+
+#endif // HS_SPIQ_HPP
@@ -0,0 +1,234 @@
+// Duino/Common/Host/HS_TWM.hpp - AVR TWI (master mode) hardware model for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_TWM_HPP
+#define HS_TWM_HPP
+
+#include "HS_Wire.hpp"
+
+// Stands in for the ATmega TWI peripheral so that the interrupt driven master of
+// AVR/DA_TWMISR.hpp runs unmodified against CHostI2CDev slave models. Register
+// names map onto the model: a write to TWCR (with TWINT set) performs the bus
+// action immediately, the resulting status becomes visible (and TWI_vect is
+// called) once virtual time reaches the end of the action on the wire. poll()
+// from the main loop stands in for the interrupt. Bit time follows TWBR & the
+// TWSR prescaler as on the target; slaves may stretch the clock per byte.
+
+// <util/twi.h>
+#define TW_START           0x08
+#define TW_REP_START       0x10
+#define TW_MT_SLA_ACK      0x18
+#define TW_MT_SLA_NACK     0x20
+#define TW_MT_DATA_ACK     0x28
+#define TW_MT_DATA_NACK    0x30
+#define TW_MT_ARB_LOST     0x38
+#define TW_MR_SLA_ACK      0x40
+#define TW_MR_SLA_NACK     0x48
+#define TW_MR_DATA_ACK     0x50
+#define TW_MR_DATA_NACK    0x58
+#define TW_NO_INFO         0xF8
+#define TW_BUS_ERROR       0x00
+#define TW_STATUS_MASK     0xF8
+
+// TWCR bits
+#define TWIE   0
+#define TWEN   2
+#define TWWC   3
+#define TWSTO  4
+#define TWSTA  5
+#define TWEA   6
+#define TWINT  7
+
+#ifndef _BV
+#define _BV(b) (1 << (b))
+#endif
+
+#ifndef HS_TWI_CORE_CLK
+#define HS_TWI_CORE_CLK 16000000UL
+#endif
+
+#ifndef HS_AVR_SREG
+#define HS_AVR_SREG
+uint8_t SREG; // NB: no interrupt nesting on host
+void cli (void) { ; }
+void sei (void) { ; }
+#endif
+
+// Interrupt vectors become plain functions
+#define SIGNAL(v) void v (void)
+void TWI_vect (void);
+
+class CHostTWI
+{
+protected:
+   CHostI2CDev *pD[HS_I2C_MAX_DEV];
+   CHostI2CDev *pA; // addressed slave
+   uint64_t tDone, tE0;
+   uint8_t st;
+   bool own, pend;
+
+   CHostI2CDev *find (const uint8_t a)
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++) { if (pD[i] && (a == pD[i]->addr)) { return(pD[i]); } }
+      return(NULL);
+   } // find
+
+   // SCL period from bit rate register & prescaler
+   uint32_t bitNs (void) const { return(((uint64_t)(16 + 2 * br * (1 << (2 * (ps & 0x3)))) * 1000000000) / HS_TWI_CORE_CLK); }
+
+   void schedule (const uint8_t s, const uint8_t nBit, const bool ie, const uint32_t xNs=0)
+   {
+      st= s;
+      tDone= gHostClock.nowNs() + nBit * bitNs() + xNs;
+      pend= ie;
+   } // schedule
+
+   // Byte transfer following address or data phase
+   void data (const uint8_t c)
+   {
+      const bool ie= c & _BV(TWIE);
+      switch(st)
+      {
+         case TW_START :
+         case TW_REP_START :
+         {
+            const bool rd= dr & 0x1;
+            pA= find(dr >> 1);
+            const bool ack= pA && pA->start(rd);
+            if (!ack) { pA= NULL; nNack++; }
+            nByte++;
+            schedule(rd ? (ack ? TW_MR_SLA_ACK : TW_MR_SLA_NACK) : (ack ? TW_MT_SLA_ACK : TW_MT_SLA_NACK), 9, ie);
+            break;
+         }
+         case TW_MT_SLA_ACK :
+         case TW_MT_DATA_ACK :
+         {
+            const bool ack= pA->write(dr);
+            nNack+= !ack;
+            nByte++;
+            schedule(ack ? TW_MT_DATA_ACK : TW_MT_DATA_NACK, 9, ie, pA->stretchNs);
+            break;
+         }
+         case TW_MR_SLA_ACK :
+         case TW_MR_DATA_ACK :
+         {
+            const bool ack= c & _BV(TWEA);
+            dr= pA->read(ack);
+            nByte++;
+            schedule(ack ? TW_MR_DATA_ACK : TW_MR_DATA_NACK, 9, ie, pA->stretchNs);
+            break;
+         }
+         default : // no transfer possible after NACK (master should stop or restart)
+            nErr++;
+            schedule(TW_BUS_ERROR, 0, ie);
+            break;
+      }
+   } // data
+
+public:
+   class Ctrl // TWCR
+   {
+      uint8_t v;
+   public:
+      Ctrl& operator= (const uint8_t c);
+      operator uint8_t () const { return(v); }
+   } cr;
+   class Status // TWSR: status read only, prescaler read/write
+   {
+   public:
+      Status& operator= (const uint8_t s);
+      operator uint8_t () const;
+   } sr;
+   uint8_t dr, br, ps;
+   uint32_t nEvent, nByte, nStart, nStop, nNack, nErr;
+   uint64_t tEventWall; // host time spent in TWI_vect
+
+   CHostTWI (void) : pA{NULL}, tDone{0}, st{TW_NO_INFO}, own{false}, pend{false},
+      dr{0xFF}, br{0}, ps{0}, nEvent{0}, nByte{0}, nStart{0}, nStop{0}, nNack{0}, nErr{0}, tEventWall{0}
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++) { pD[i]= NULL; }
+   }
+
+   bool attach (CHostI2CDev *p)
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++)
+      {
+         if (NULL == pD[i]) { pD[i]= p; return(true); }
+      }
+      return(false);
+   } // attach
+
+   void detach (CHostI2CDev *p) { for (int i=0; i<HS_I2C_MAX_DEV; i++) { if (p == pD[i]) { pD[i]= NULL; } } }
+
+   uint8_t status (void) const { return(st); }
+
+   // Bus action on TWCR write
+   void control (const uint8_t c)
+   {
+      if (0 == (c & _BV(TWEN))) { own= pend= false; pA= NULL; st= TW_NO_INFO; return; } // disabled
+      if (0 == (c & _BV(TWINT))) { return; } // flag not cleared, no action
+      if (c & _BV(TWSTO))
+      {
+         if (own)
+         {
+            if (pA) { pA->stop(); pA= NULL; }
+            own= false;
+            nStop++;
+            gHostClock.advanceTo(gHostClock.nowNs() + bitNs()); // NB: master waits for stop
+         }
+         st= TW_NO_INFO;
+         pend= false;
+      }
+      if (c & _BV(TWSTA))
+      {
+         pA= NULL;
+         nStart++;
+         schedule(own ? TW_REP_START : TW_START, 1, c & _BV(TWIE));
+         own= true;
+      }
+      else if (0 == (c & _BV(TWSTO))) { data(c); }
+   } // control
+
+   bool pending (void) const { return(pend); }
+   uint64_t pendingUntil (void) const { return(pend ? tDone : 0); }
+
+   // Call from loop(): stands in for the TWI interrupt
+   bool poll (void)
+   {
+      if (pend && (gHostClock.nowNs() >= tDone))
+      {
+         const uint64_t w0= gHostClock.wallNs();
+         pend= false;
+         nEvent++;
+         TWI_vect();
+         tEventWall+= gHostClock.wallNs() - w0;
+         return(true);
+      }
+      return(false);
+   } // poll
+
+   // Run bus until no interrupt pending (or limit events), returns events
+   uint32_t sync (uint32_t maxEv=10000)
+   {
+      uint32_t n= 0;
+      while (pend && (n < maxEv)) { gHostClock.advanceTo(tDone); n+= poll(); }
+      return(n);
+   } // sync
+
+   void resetStats (void) { nEvent= nByte= nStart= nStop= nNack= nErr= 0; tEventWall= 0; }
+}; // CHostTWI
+
+CHostTWI gHostTWI;
+
+CHostTWI::Ctrl& CHostTWI::Ctrl::operator= (const uint8_t c) { v= c & ~_BV(TWINT); gHostTWI.control(c); return(*this); }
+CHostTWI::Status& CHostTWI::Status::operator= (const uint8_t s) { gHostTWI.ps= s & 0x3; return(*this); }
+CHostTWI::Status::operator uint8_t () const { return(gHostTWI.status() | gHostTWI.ps); }
+
+#define TWCR gHostTWI.cr
+#define TWSR gHostTWI.sr
+#define TWDR gHostTWI.dr
+#define TWBR gHostTWI.br
+
+#endif // HS_TWM_HPP
@@ -0,0 +1,44 @@
+// Duino/Common/Host/HS_Timing.hpp - Calendar clock for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_TIMING_HPP
+#define HS_TIMING_HPP
+
+#include "HS_Arduino.hpp"
+#include "../dateTimeUtil.hpp"
+
+// Minimal stand-in for the platform CClock (as used by MFDAsm::create): date & time
+// set from build strings then advanced by the virtual clock (day rollover ignored).
+class CClock
+{
+protected:
+   uint8_t ymd[3], hms[3];
+   uint32_t s0;   // virtual seconds at set
+
+public:
+   CClock (void) : s0{0} { memset(ymd, 0, 3); memset(hms, 0, 3); }
+
+   void setA (const char amdy[], const char ahms[])
+   {
+      u8FromDateA(ymd, amdy);
+      u8FromTimeA(hms, ahms);
+      s0= millis() / 1000;
+   } // setA
+
+   int bytesBCD4 (void) { return(6); } // yy/mm/dd,hh:mm:ss 12digits = 6bytes
+
+   // yymmddhhmmss
+   int getBCD4 (uint8_t bcd[6])
+   {
+      uint32_t s= hms[2] + 60 * (hms[1] + 60 * (uint32_t)hms[0]) + (millis() / 1000) - s0;
+      for (int i=0; i<3; i++) { bcd4FromU8(bcd+i, ymd[i]); }
+      bcd4FromU8(bcd+5, s % 60); s/= 60;
+      bcd4FromU8(bcd+4, s % 60); s/= 60;
+      bcd4FromU8(bcd+3, s % 24);
+      return(6);
+   } // getBCD4
+}; // CClock
+
+#endif // HS_TIMING_HPP
@@ -0,0 +1,363 @@
+// Duino/Common/Host/HS_W25Q.hpp - Winbond W25Q SPI NOR flash device model for host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_W25Q_HPP
+#define HS_W25Q_HPP
+
+#include "HS_SPI.hpp"
+#include "../CW25Q.hpp" // W25Q command & flag definitions
+
+// Approximate datasheet timing (W25Q32/64/128 "typical" column) in microseconds.
+// Program time for a page is modelled as first byte + per additional byte, capped at tPP.
+namespace W25QSim
+{
+   struct Timing
+   {
+      uint32_t tBP1, tBP2, tPP, tSE, tBE1, tBE2, tCE; // us
+      uint32_t tRES1, tSUS;
+   }; // Timing
+   const Timing TYPICAL= { 30, 3, 700, 45000, 120000, 150000, 40000000, 3, 20 };
+   const Timing MAXIMUM= { 50, 12, 3000, 400000, 1600000, 2000000, 200000000, 3, 20 };
+
+   struct Stat
+   {
+      uint64_t rdBytes, wrBytes, nProg, nErase, eraseBytes;
+      uint64_t nPoll, nPollBusy, busyPollNs; // status polling while busy
+      uint64_t nBitConflict; // attempts to program 0->1 (i.e. missing erase)
+      uint64_t nIgnored;     // commands rejected (busy, write not enabled)
+      uint64_t nOverClk;     // RD_PG issued above its clock limit (data unreliable on hardware)
+      uint64_t nSuspend;     // erase suspensions
+      uint64_t nWornProg;    // page programs with bits lost to wear
+      uint64_t progBytes;    // bytes programmed (i.e. not 0xFF in page buffer)
+
+      Stat (void) { clear(); }
+      void clear (void) { memset(this, 0, sizeof(*this)); }
+   }; // Stat
+}; // namespace W25QSim
+
+class CHostW25Q : public CHostSPIDev
+{
+protected:
+   uint8_t *pM;      // memory array
+   uint32_t mask;    // address wrap
+   uint32_t *pE, *pL;// per 4K sector: erase count & endurance (0 -> unlimited)
+   uint32_t rng;     // wear failure pattern
+   uint8_t jid[3], mid[2], st[3];
+   uint8_t pg[W25Q::PAGE_BYTES];
+   UU32 addr;
+   uint32_t iB;      // byte index within current command
+   uint64_t busyUntil, lastPollNs, susRemain;
+   int64_t cutB;     // bytes to program before power loss, <0 -> never
+   W25QSim::Timing tm;
+   uint8_t cmd;
+   bool sleep, pgDirty, erasing, off;
+
+   bool busy (void) const { return(gHostClock.nowNs() < busyUntil); }
+   void setBusy (const uint32_t us) { busyUntil= gHostClock.nowNs() + (uint64_t)us * 1000; }
+
+   // Bytes following command before data phase
+   uint8_t addrBytes (const uint8_t c) const
+   {
+      switch(c)
+      {
+         case W25Q::RD_PG : case W25Q::RF_PG : case W25Q::RD_DO : case W25Q::WR_PG :
+         case W25Q::EE_4K : case W25Q::EE_32K : case W25Q::EE_64K : return(3);
+      }
+      return(0);
+   } // addrBytes
+
+   bool suspended (void) const { return(st[1] & W25Q::SUS); }
+
+   // Completion of program/erase (or suspension) clears WEL
+   void settle (void)
+   {
+      if ((busyUntil > 0) && !busy())
+      {
+         st[0]&= ~W25Q::WEL;
+         if (!suspended()) { erasing= false; }
+         busyUntil= 0;
+      }
+   } // settle
+
+   // Commands accepted while busy
+   bool busyCmd (const uint8_t c) const
+   {
+      switch(c)
+      {
+         case W25Q::RD_ST1 : case W25Q::RD_ST2 : case W25Q::RD_ST3 : return(true);
+         case W25Q::SUSPEND : return(erasing && !suspended());
+      }
+      return(false);
+   } // busyCmd
+
+   uint8_t status1 (void)
+   {
+      settle();
+      if (busy()) { return(st[0] | W25Q::BUSY); }
+      return(st[0]);
+   } // status1
+
+   void poll (void)
+   {
+      const uint64_t t= gHostClock.nowNs();
+      stat.nPoll++;
+      if (busy())
+      {
+         if (stat.nPollBusy++ > 0) { stat.busyPollNs+= t - lastPollNs; }
+         lastPollNs= t;
+      }
+   } // poll
+
+   uint8_t dataOut (void)
+   {
+      uint8_t r= pM[addr.u32 & mask];
+      addr.u32++;
+      stat.rdBytes++;
+      return(r);
+   } // dataOut
+
+   void eraseRegion (const uint32_t a, const uint32_t n, const uint32_t us)
+   {
+      if (suspended()) { stat.nIgnored++; return; } // no erase while one is suspended
+      erasing= true;
+      memset(pM + (a & mask & ~(n-1)), 0xFF, n);
+      for (uint32_t s= (a & mask & ~(n-1)) >> 12, e= s + (n >> 12); s < e; s++) { pE[s]++; }
+      stat.nErase++;
+      stat.eraseBytes+= n;
+      setBusy(us);
+   } // eraseRegion
+
+   void commitPage (void)
+   {
+      const uint32_t base= addr.u32 & mask & ~(W25Q::PAGE_BYTES-1);
+      const uint32_t s= base >> 12;
+      const bool worn= (pL[s] > 0) && (pE[s] > pL[s]);
+      uint32_t n= 0, nW= 0;
+      for (int i=0; i<W25Q::PAGE_BYTES; i++)
+      {
+         uint8_t *p= pM + base + i;
+         if (0xFF != pg[i])
+         {
+            uint8_t m= 0;
+            if (0 == cutB) { off= true; break; } // power lost mid program
+            if (cutB > 0) { --cutB; }
+            if (worn)
+            {  // worn out cells: some bits fail to program
+               rng= rng * 1103515245 + 12345;
+               if (0 == ((rng >> 16) & 0x3)) { m= 1 << ((rng >> 20) & 0x7); nW++; }
+            }
+            stat.nBitConflict+= (0 != (pg[i] & ~*p));
+            *p&= pg[i] | m;
+            ++n;
+         }
+      }
+      stat.progBytes+= n;
+      stat.nWornProg+= (nW > 0);
+      stat.nProg++;
+      uint32_t us= tm.tBP1 + n * tm.tBP2;
+      setBusy(min(us, tm.tPP));
+   } // commitPage
+
+   bool writeEnabled (void)
+   {
+      if (st[0] & W25Q::WEL) { return(true); }
+      stat.nIgnored++;
+      return(false);
+   } // writeEnabled
+
+   // Command completes on rising chip select
+   void execute (void)
+   {
+      const uint8_t nA= addrBytes(cmd);
+      switch(cmd)
+      {
+         case W25Q::WR_EN : st[0]|= W25Q::WEL; break;
+         case W25Q::WR_DIS : st[0]&= ~W25Q::WEL; break;
+         case W25Q::WR_PG :
+            if (pgDirty && writeEnabled()) { commitPage(); }
+            break;
+         case W25Q::EE_4K :
+            if ((iB > nA) && writeEnabled()) { eraseRegion(addr.u32, 0x1000, tm.tSE); }
+            break;
+         case W25Q::EE_32K :
+            if ((iB > nA) && writeEnabled()) { eraseRegion(addr.u32, 0x8000, tm.tBE1); }
+            break;
+         case W25Q::EE_64K :
+            if ((iB > nA) && writeEnabled()) { eraseRegion(addr.u32, 0x10000, tm.tBE2); }
+            break;
+         case W25Q::EE_DV :
+            if (writeEnabled()) { eraseRegion(0, mask+1, tm.tCE); }
+            break;
+         case W25Q::GL_UN : st[0]&= ~(W25Q::BPM|W25Q::WEL); break;
+         case W25Q::SLEEP : sleep= true; break;
+         case W25Q::SUSPEND :
+            if (erasing && busy() && !suspended())
+            {
+               susRemain= busyUntil - gHostClock.nowNs();
+               st[1]|= W25Q::SUS;
+               setBusy(tm.tSUS);
+               stat.nSuspend++;
+            }
+            break;
+         case W25Q::RESUME :
+            if (suspended() && !busy())
+            {
+               st[1]&= ~W25Q::SUS;
+               busyUntil= gHostClock.nowNs() + susRemain;
+            }
+            break;
+      }
+   } // execute
+
+public:
+   W25QSim::Stat stat;
+
+   // Capacity in Mbit (power of 2, 1..128)
+   CHostW25Q (const uint8_t capMb=32, const W25QSim::Timing& t=W25QSim::TYPICAL) : tm(t)
+   {
+      uint8_t c= 0x10; // Winbond device ID encoding, 1<<(c-0x10) Mbit
+      while ((1 << (c - 0x10)) < capMb) { ++c; }
+      mask= (1 << (c - 0x10 + 17)) - 1;
+      pM= (uint8_t*)malloc(mask+1);
+      memset(pM, 0xFF, mask+1);
+      pE= (uint32_t*)calloc(sectors(), sizeof(uint32_t));
+      pL= (uint32_t*)calloc(sectors(), sizeof(uint32_t));
+      rng= 1;
+      mid[0]= 0xEF; mid[1]= c;
+      jid[0]= 0xEF; jid[1]= 0x40; jid[2]= c + 1; // JEDEC capacity code is one greater
+      st[0]= st[1]= st[2]= 0;
+      busyUntil= lastPollNs= susRemain= 0;
+      sleep= erasing= off= false;
+      cutB= -1;
+      cmd= 0; iB= 0;
+   } // CHostW25Q
+
+   ~CHostW25Q () { free(pM); free(pE); free(pL); }
+
+   uint32_t bytes (void) const { return(mask+1); }
+   uint32_t sectors (void) const { return((mask+1) >> 12); }
+
+   // Erase cycles after which programming becomes unreliable, spread 0.5 to 1.5
+   // times nominal over sectors (0 -> unlimited)
+   void setEndurance (const uint32_t cycles, uint32_t seed=1)
+   {
+      for (uint32_t s= 0; s < sectors(); s++)
+      {
+         seed= seed * 1103515245 + 12345;
+         pL[s]= cycles ? (cycles / 2) + ((seed >> 8) % (cycles + 1)) : 0;
+      }
+   } // setEndurance
+
+   uint32_t eraseCount (const uint32_t s) const { return(pE[s % sectors()]); }
+
+   // Erase count range over sectors [s0, s0+n)
+   void eraseRange (uint32_t& lo, uint32_t& hi, const uint32_t s0, const uint32_t n) const
+   {
+      lo= -1; hi= 0;
+      for (uint32_t s= s0; s < (s0 + n); s++) { lo= min(lo, eraseCount(s)); hi= max(hi, eraseCount(s)); }
+   } // eraseRange
+   uint8_t *image (void) { return(pM); }
+   const W25QSim::Timing& timing (void) const { return(tm); }
+   bool isBusy (void) const { return busy(); }
+
+   // Fault injection: power fails after n more bytes are programmed (page
+   // programs are torn at that byte). While off the device ignores commands
+   // and returns zero, so host code runs to completion as if writes succeeded.
+   void setPowerCut (const int64_t n) { cutB= n; off= false; }
+   bool powerLost (void) const { return(off); }
+   void powerOn (void)
+   {
+      off= sleep= erasing= false;
+      cutB= -1;
+      busyUntil= susRemain= 0;
+      st[0]= st[1]= 0;
+   } // powerOn
+
+   // File backed image: persist between runs (e.g. to test mount of an existing volume)
+   bool load (const char *path)
+   {
+      FILE *f= fopen(path, "rb");
+      size_t n= 0;
+      if (f) { n= fread(pM, 1, mask+1, f); fclose(f); }
+      return(n == (mask+1));
+   } // load
+
+   bool save (const char *path) const
+   {
+      FILE *f= fopen(path, "wb");
+      size_t n= 0;
+      if (f) { n= fwrite(pM, 1, mask+1, f); fclose(f); }
+      return(n == (mask+1));
+   } // save
+
+   void select (const bool active)
+   {
+      if (off) { iB= 0; cmd= 0; }
+      else if (active) { iB= 0; cmd= 0; settle(); }
+      else if ((iB > 0) && !sleep) { execute(); }
+   } // select
+
+   uint8_t exchange (const uint8_t mosi)
+   {
+      uint8_t r= 0xFF;
+      const uint32_t i= iB++;
+
+      if (off) { return(0); }
+      if (0 == i)
+      {
+         cmd= mosi;
+         if (sleep) { if (W25Q::WAKE == cmd) { sleep= false; } return(r); }
+         if (W25Q::RD_ST1 == cmd) { poll(); }
+         if (busy() && !busyCmd(cmd)) { cmd= 0; stat.nIgnored++; }
+         else if ((W25Q::RD_PG == cmd) && (SPI.getClock() > W25Q::RD_PG_MAX_MHZ * 1000000UL)) { stat.nOverClk++; }
+         addr.u32= 0;
+         if (W25Q::WR_PG == cmd) { memset(pg, 0xFF, sizeof(pg)); pgDirty= false; }
+         return(r);
+      }
+      const uint8_t nA= addrBytes(cmd);
+      if (i <= nA)
+      {  // big endian address
+         addr.u32= (addr.u32 << 8) | mosi;
+         return(r);
+      }
+      const uint32_t j= i - 1 - nA; // data phase byte index
+      switch(cmd)
+      {
+         case W25Q::RD_ST1 : r= status1(); break;
+         case W25Q::RD_ST2 : settle(); r= st[1]; break;
+         case W25Q::RD_ST3 : r= st[2]; break;
+         case W25Q::RD_JID : if (j < 3) { r= jid[j]; } break;
+         case W25Q::RD_MID : if ((j >= 3) && (j < 5)) { r= mid[j-3]; } break; // after 3 dummy address bytes
+         case W25Q::RD_UID : if (j >= 4) { r= 0xD0 + (j-4); } break;
+         case W25Q::RD_PG : r= dataOut(); break;
+         case W25Q::RF_PG : case W25Q::RD_DO : if (j > 0) { r= dataOut(); } break; // dummy byte first
+         case W25Q::WR_PG :
+            pg[(addr.u32 + j) & (W25Q::PAGE_BYTES-1)]= mosi; // circular page buffer
+            pgDirty= true;
+            stat.wrBytes++;
+            break;
+         case W25Q::WR_ST1 : case W25Q::WR_ST2 : case W25Q::WR_ST3 : break; // not modelled
+      }
+      return(r);
+   } // exchange
+
+   void dumpStat (Stream& s)
+   {
+      s.print("W25QSim: rd="); s.print((unsigned long long)stat.rdBytes);
+      s.print(" wr="); s.print((unsigned long long)stat.wrBytes);
+      s.print(" prog="); s.print((unsigned long long)stat.nProg);
+      s.print(" erase="); s.print((unsigned long long)stat.nErase);
+      s.print(" poll="); s.print((unsigned long long)stat.nPollBusy); s.print('/'); s.print((unsigned long long)stat.nPoll);
+      s.print(" busyWait="); s.print(stat.busyPollNs * 1E-6, 3); s.print("ms");
+      if (stat.nBitConflict > 0) { s.print(" conflict="); s.print((unsigned long long)stat.nBitConflict); }
+      if (stat.nIgnored > 0) { s.print(" ignored="); s.print((unsigned long long)stat.nIgnored); }
+      if (stat.nSuspend > 0) { s.print(" suspend="); s.print((unsigned long long)stat.nSuspend); }
+      if (stat.nOverClk > 0) { s.print(" overclk="); s.print((unsigned long long)stat.nOverClk); }
+      if (stat.nWornProg > 0) { s.print(" worn="); s.print((unsigned long long)stat.nWornProg); }
+      s.println();
+   } // dumpStat
+}; // CHostW25Q
+
+#endif // HS_W25Q_HPP
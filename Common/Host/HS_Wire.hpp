@@ -0,0 +1,140 @@
+// Duino/Common/Host/HS_Wire.hpp - Pluggable I2C (Wire library) transport for Linux host builds
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef HS_WIRE_HPP
+#define HS_WIRE_HPP
+
+#include "HS_Arduino.hpp"
+
+// Byte level slave model: the bus calls start() for each (repeated) start condition
+// with the R/W direction, then write()/read() per byte, then stop(). Return false
+// from start() or write() to NACK. A slave may stretch the clock by a fixed time
+// per data byte.
+class CHostI2CDev
+{
+public:
+   uint32_t stretchNs;
+   uint8_t addr; // 7bit
+
+   CHostI2CDev (const uint8_t a=0x00) : stretchNs{0}, addr{a} { ; }
+
+   virtual bool start (const bool rd) { return(true); }
+   virtual bool write (const uint8_t b) = 0;
+   virtual uint8_t read (const bool ack) = 0;
+   virtual void stop (void) { ; }
+}; // CHostI2CDev
+
+#ifndef HS_I2C_MAX_DEV
+#define HS_I2C_MAX_DEV 8
+#endif
+#ifndef BUFFER_LENGTH
+#define BUFFER_LENGTH 32
+#endif
+#define I2C_FAST_MODE 400000
+
+// Mimics the AVR Wire library: transmit is buffered until endTransmission(),
+// receive is completed by requestFrom() and then drained by read().
+class TwoWire : public Stream
+{
+protected:
+   CHostI2CDev *pD[HS_I2C_MAX_DEV];
+   uint32_t clk;
+   uint8_t tb[BUFFER_LENGTH], rb[BUFFER_LENGTH];
+   uint8_t nT, nR, iR, txAddr;
+   bool hold; // previous transaction ended without stop
+
+   CHostI2CDev *find (const uint8_t a)
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++) { if (pD[i] && (a == pD[i]->addr)) { return(pD[i]); } }
+      return(NULL);
+   } // find
+
+   // start/stop conditions ~1 bit each, bytes 9 bits inc. ack
+   void charge (const int nB) { gHostClock.advance(((uint64_t)(9 * nB + 2) * 1000000000) / clk); }
+
+public:
+   uint32_t nTrans, nNack;
+
+   TwoWire (void) : clk{100000}, nT{0}, nR{0}, iR{0}, hold{false}, nTrans{0}, nNack{0}
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++) { pD[i]= NULL; }
+   }
+
+   bool attach (CHostI2CDev *p)
+   {
+      for (int i=0; i<HS_I2C_MAX_DEV; i++)
+      {
+         if (NULL == pD[i]) { pD[i]= p; return(true); }
+      }
+      return(false);
+   } // attach
+
+   void detach (CHostI2CDev *p) { for (int i=0; i<HS_I2C_MAX_DEV; i++) { if (p == pD[i]) { pD[i]= NULL; } } }
+
+   void begin (void) { ; }
+   void begin (uint32_t c) { setClock(c); } // NB: STM32 core style (master clock)
+   void end (void) { ; }
+   void setClock (uint32_t c) { if (c > 0) { clk= c; } }
+
+   void beginTransmission (const uint8_t a) { txAddr= a; nT= 0; }
+   void beginTransmission (const int a) { beginTransmission((uint8_t)a); }
+
+   size_t write (uint8_t b) { if (nT < BUFFER_LENGTH) { tb[nT++]= b; return(1); } return(0); }
+   size_t write (const uint8_t b[], size_t n) { size_t i=0; while ((i < n) && write(b[i])) { ++i; } return(i); }
+   using Print::write;
+
+   // 0: success, 2: address NACK, 3: data NACK
+   uint8_t endTransmission (const bool sendStop=true)
+   {
+      CHostI2CDev *p= find(txAddr);
+      uint8_t r= 0;
+      int i= 0;
+      nTrans++;
+      if ((NULL == p) || !p->start(false)) { r= 2; }
+      else
+      {
+         while ((i < nT) && p->write(tb[i])) { ++i; }
+         if (i < nT) { r= 3; }
+      }
+      if (p && (sendStop || r)) { p->stop(); }
+      hold= !sendStop;
+      nNack+= (r > 0);
+      charge(1+i);
+      if (p) { gHostClock.advance((uint64_t)i * p->stretchNs); }
+      nT= 0;
+      return(r);
+   } // endTransmission
+
+   uint8_t requestFrom (const uint8_t a, uint8_t n, const bool sendStop=true)
+   {
+      CHostI2CDev *p= find(a);
+      if (n > BUFFER_LENGTH) { n= BUFFER_LENGTH; }
+      nR= iR= 0;
+      nTrans++;
+      if (p && p->start(true))
+      {
+         while (nR < n) { rb[nR]= p->read(nR+1 < n); ++nR; } // master NACKs the last
+         if (sendStop) { p->stop(); }
+      }
+      else { nNack++; }
+      hold= !sendStop;
+      charge(1+nR);
+      if (p) { gHostClock.advance((uint64_t)nR * p->stretchNs); }
+      return(nR);
+   } // requestFrom
+   uint8_t requestFrom (const int a, const int n) { return requestFrom((uint8_t)a, (uint8_t)n); }
+
+   int available (void) { return(nR - iR); }
+   int read (void) { if (iR < nR) { return rb[iR++]; } return(-1); }
+   int peek (void) { if (iR < nR) { return rb[iR]; } return(-1); }
+}; // TwoWire
+
+TwoWire Wire;
+
+#ifndef I2C
+#define I2C Wire // NB: suppresses #include <Wire.h> in CCommonI2C.hpp
+#endif
+
+#endif // HS_WIRE_HPP
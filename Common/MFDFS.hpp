@@ -0,0 +1,1130 @@
+// Duino/Common/MFDFS.hpp - Compact File Chunk (CFC) file system engine
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef MFD_FS_HPP
+#define MFD_FS_HPP
+
+#include "MFDHacks.hpp"
+
+// Storage device class, e.g. CW25QWear for wear levelling (include CW25QWear.hpp first)
+#ifndef MFD_DEV
+#define MFD_DEV CW25QUtil
+#endif
+typedef MFD_DEV MFDDev;
+
+// File system on a W25Q volume using the CFC format of MFDHacks.hpp. Chunks are
+// allocated sequentially (page aligned, fixed reservation) from the start of the
+// volume, so that the end of used storage ("head") is the first erased chunk.
+// Every append is two phase: [HdrD:Fn][data] as a single gathered commit, then
+// the new end-of-file redirect [HdrR:Fn+1->F0] as commit marker, after which the
+// previous redirect is deleted. With a journal (see CFC::Intent) each append is
+// preceded by an intent record so that mount completes or undoes an interrupted
+// append from the last record alone, without a scan. Reading follows fragment IDs,
+// searching from the record after the current fragment and resolving redirects.
+// Open without an index requires a scan of all chunk headers. An index (see
+// MFDIndex) built at mount from one sequential pass makes open & seek RAM
+// searches; it is checkpointed to reserved sectors at the end of the volume so
+// that a warm mount skips the scan. Chunk slots erased by garbage collection
+// (see MFDGC.hpp) below the head are reused once the head reaches the end.
+
+namespace CFC
+{
+   enum Type : uint8_t { NONE=0x0, BAD=0x1, REDIR=0xD, FRAG=0xE, OBJ=0xF };
+
+   const uint8_t X_LIVE= 0x80;   // extension bit, programmed to zero on deletion
+   const uint8_t HDR_J= sizeof(CFCHdrJ0), HDR_D= sizeof(CFCHdrD0), HDR_R= sizeof(CFCHdrR0);
+
+   // Decoded record (micro header & payload)
+   struct Rec
+   {
+      uint32_t a;       // flash address
+      uint16_t id, v;   // ID (object or fragment); reservation pages, payload bytes or redirect target
+      uint8_t t;        // Type
+      bool live;        // valid CRC & not deleted
+
+      Rec (void) : a{0}, id{0}, v{0}, t{NONE}, live{false} { ; }
+   }; // struct Rec
+
+   const uint16_t EOF_N= 0xFFFF; // index entry length denoting end-of-file redirect
+
+   // Index entry: live fragment (or EOF redirect) record of object j, with end page of enclosing chunk
+   struct IdxEnt
+   {
+      uint32_t a;       // record address
+      uint16_t j, f;    // object & fragment ID (sort key)
+      uint16_t n, e;    // payload bytes, chunk end page
+   }; // struct IdxEnt
+
+   // Index checkpoint header, followed by entries. Live byte programmed to zero
+   // when volume is modified after the checkpoint.
+   struct CkHdr
+   {
+      uint8_t m[3], live;
+      uint16_t nE, hP, lastObj, nC;
+      uint8_t crc, rsv[3];
+   }; // struct CkHdr
+
+   // Journal slot: intent to append (or create) fragment f of object j at a.
+   // Headers are regenerated from it at recovery: if any byte of the commit
+   // marker (redirect following the data) was programmed then the append rolls
+   // forward, otherwise the fragment is deleted. Sequence (first, so that a torn
+   // slot is never taken as free) is the journal sector generation.
+   struct Intent
+   {
+      uint8_t seq, a[3];   // generation, J or D record address (LE)
+      uint8_t r[3], rv;    // previous EOF redirect address (0 -> none), J reservation (0 -> no J)
+      uint16_t j, f, m;    // object & fragment ID, data bytes
+      uint8_t crc, done;   // CRC8 of preceding bytes, programmed to zero on completion
+   }; // struct Intent
+
+   const uint16_t INTENT_GC= 0xFFFF; // Intent.f of chunk relocation: a= first copy, r= victim chunk
+   const uint8_t JOURNAL_PAGES= 32; // two (ping-pong) sectors
+   const uint16_t INTENT_SLOTS= 0x1000 / sizeof(Intent);
+}; // namespace CFC
+
+#ifndef CFC_CHUNK_PAGES
+#define CFC_CHUNK_PAGES 16 // default reservation = 4K sector
+#endif
+#define CFC_FRAG_MAX ((MAX_FRAG-2) * 255) // data bytes per commit, FragAsm pieces are uint8_t sized
+#define CFC_FRAG_MIN 16 // smaller space left in a chunk is abandoned
+#ifndef CFC_INDEX_MAX
+#define CFC_INDEX_MAX 512 // entries (12 bytes each)
+#endif
+#define CFC_SKIP_MAX 64 // sequential scan: gap clocked through rather than reissuing read command
+
+// Open file state, 0 == id when closed
+class MFDFile
+{
+public:
+   uint16_t id;      // object ID
+   uint16_t nF;      // next fragment ID (append)
+   uint32_t size;    // data bytes (fragments 1..)
+   uint32_t wA, eA;  // write address & end of reservation in tail chunk
+   uint32_t rA;      // live end-of-file redirect, 0 -> none
+   // read cursor: current fragment ID, payload address & length, offset within,
+   // bounds (pages) of enclosing chunk
+   uint32_t hA, pos;
+   uint16_t fR, lR, oR, rP, rE;
+
+   MFDFile (void) { clear(); }
+
+   void clear (void) { memset(this, 0, sizeof(*this)); }
+   bool isOpen (void) const { return(id > 0); }
+   void rewind (void) { hA= 0; pos= 0; fR= lR= oR= rP= rE= 0; }
+}; // MFDFile
+
+// Live records sorted by (object, fragment) ID. Invalid after overflow, in which
+// case the volume falls back to scanning.
+class MFDIndex
+{
+public:
+   CFC::IdxEnt e[CFC_INDEX_MAX];
+   uint16_t n;
+   bool valid;
+
+   MFDIndex (void) { clear(); }
+
+   void clear (void) { n= 0; valid= true; }
+
+   static uint32_t key (const uint16_t j, const uint16_t f) { return(((uint32_t)j << 16) | f); }
+   static uint32_t key (const CFC::IdxEnt& x) { return key(x.j, x.f); }
+
+   static int cmp (const void *pA, const void *pB)
+   {
+      const uint32_t a= key(*(const CFC::IdxEnt*)pA), b= key(*(const CFC::IdxEnt*)pB);
+      return((a > b) - (a < b));
+   } // cmp
+
+   bool add (const CFC::IdxEnt& x)
+   {
+      if (n >= CFC_INDEX_MAX) { valid= false; return(false); }
+      e[n++]= x;
+      return(true);
+   } // add
+
+   void sort (void) { qsort(e, n, sizeof(e[0]), cmp); }
+
+   // First entry with key not less than (j,f)
+   uint16_t find (const uint16_t j, const uint16_t f) const
+   {
+      const uint32_t k= key(j,f);
+      uint16_t l= 0, h= n;
+      while (l < h)
+      {
+         const uint16_t m= (l + h) >> 1;
+         if (key(e[m]) < k) { l= m + 1; } else { h= m; }
+      }
+      return(l);
+   } // find
+
+   bool match (const uint16_t i, const uint16_t j) const { return((i < n) && (e[i].j == j)); }
+
+   // Replace entry with same key or insert in order
+   bool put (const CFC::IdxEnt& x)
+   {
+      const uint16_t i= find(x.j, x.f);
+      if ((i < n) && (key(e[i]) == key(x))) { e[i]= x; return(true); }
+      if (n >= CFC_INDEX_MAX) { valid= false; return(false); }
+      memmove(e+i+1, e+i, (n - i) * sizeof(e[0]));
+      e[i]= x;
+      n++;
+      return(true);
+   } // put
+
+   // Remove entry with key (j,f) if present
+   bool remove (const uint16_t j, const uint16_t f)
+   {
+      const uint16_t i= find(j, f);
+      if ((i >= n) || (key(e[i]) != key(j,f))) { return(false); }
+      memmove(e+i, e+i+1, (n - i - 1) * sizeof(e[0]));
+      n--;
+      return(true);
+   } // remove
+}; // MFDIndex
+
+// Record access common to volume & ring engines
+class MFDRec : public MFDAsm
+{
+protected:
+   MFDDev& dev;
+   uint32_t sA;         // sequential scan: next streamed address
+   bool sOn;            // scan stream open
+
+   MFDRec (MFDDev& d) : dev(d), sA{0}, sOn{false} { ; }
+
+   uint32_t pageAddr (const uint16_t p) const { return((uint32_t)p << 8); }
+
+   // Decode record at a, returns bytes occupied (0 at erased or unframed storage)
+   uint32_t getRec (CFC::Rec& r, const uint32_t a)
+   {
+      uint8_t b[CFC::HDR_D];
+      UU32 u={a};
+      dev.dataRead(b, sizeof(b), u);
+      return decodeRec(r, a, b);
+   } // getRec
+
+   // Sequential variant of getRec: continues the open read stream, clocking
+   // through short gaps rather than issuing a new command. Addresses must be
+   // ascending until scanEnd().
+   uint32_t getRecS (CFC::Rec& r, const uint32_t a)
+   {
+      uint8_t b[CFC::HDR_D];
+      if (sOn && (a >= sA) && ((a - sA) <= CFC_SKIP_MAX)) { dev.streamSkip(a - sA); }
+      else
+      {
+         UU32 u={a};
+         scanEnd();
+         dev.streamOpen(u);
+         sOn= true;
+      }
+      dev.streamRead(b, sizeof(b));
+      sA= a + sizeof(b);
+      return decodeRec(r, a, b);
+   } // getRecS
+
+   void scanEnd (void) { if (sOn) { dev.streamClose(); sOn= false; } }
+
+   uint32_t decodeRec (CFC::Rec& r, const uint32_t a, const uint8_t b[CFC::HDR_D])
+   {
+      r.a= a; r.t= CFC::NONE; r.live= false;
+      if (0xFF == b[0]) { return(0); }
+      int s= validate(b, CFC::HDR_D);
+      r.t= CFC::BAD;
+      if (0 == s) { return(0); }
+      r.live= (s > 0) && (b[1] & CFC::X_LIVE);
+      if (s < 0) { s= -s; }
+      uint32_t n= s + HDR_UHF_BYTES;
+      r.t= b[1] & 0x0F;
+      r.id= b[2] | (b[3] << 8);
+      switch(r.t)
+      {
+         case CFC::OBJ : if (3 == s) { r.v= decodeRV(b[4]) >> 8; return(n); } break;
+         case CFC::FRAG : if (5 == s) { r.v= b[4] | (b[5] << 8); return(n + r.v); } break;
+         case CFC::REDIR : if (4 == s) { r.v= b[4] | (b[5] << 8); return(n); } break;
+      }
+      r.t= CFC::BAD; r.live= false;
+      return(n);
+   } // decodeRec
+
+   // Pages to next chunk candidate from decoded chunk header (0 -> erased)
+   uint16_t chunkPages (CFC::Rec& j, const uint32_t n)
+   {
+      if ((n > 0) && (CFC::OBJ == j.t) && (j.v > 0)) { return(j.v); }
+      if (CFC::NONE == j.t) { return(0); }
+      j.t= CFC::BAD;
+      return(1);
+   } // chunkPages
+
+   // Object chunk starting at page p
+   uint16_t getChunk (CFC::Rec& j, const uint16_t p) { return chunkPages(j, getRec(j, pageAddr(p))); }
+
+   // Program deleted flag of record at a
+   void kill (const uint32_t a, const uint8_t t)
+   {
+      const uint8_t x= 0x70 | t;
+      UU32 u={a+1};
+      dev.dataWrite(&x, 1, u);
+   } // kill
+
+   // End of used storage in chunk, from record at a
+   uint32_t usedEnd (uint32_t a, const uint16_t e)
+   {
+      CFC::Rec r;
+      uint32_t n;
+      while ((a < pageAddr(e)) && ((n= getRec(r, a)) > 0)) { a+= n; }
+      return(a);
+   } // usedEnd
+
+   // Program span of any length, page by page
+   void writeSpan (uint32_t a, const uint8_t *b, uint32_t n)
+   {
+      while (n > 0)
+      {
+         const uint32_t m= min(n, (uint32_t)(0x100 - (a & 0xFF)));
+         UU32 u={a};
+         dev.dataWrite(b, m, u);
+         a+= m; b+= m; n-= m;
+      }
+   } // writeSpan
+}; // MFDRec
+
+class MFDVol : public MFDRec
+{
+protected:
+   MFDIndex *pX;        // optional index
+   uint16_t bP, nP;     // volume: base page & page count
+   uint16_t hP;         // head: next free chunk page
+   uint16_t fP;         // search position for erased slots below head
+   uint16_t zP;         // slot with erase in progress (not to be reused), 0 -> none
+   uint16_t lastObj;    // highest object ID in use
+   uint16_t nC;         // chunks in use
+   uint16_t xP, xN;     // index checkpoint pages (at end of volume), 0 == xN -> none
+   uint16_t jN, jO;     // journal pages (preceding checkpoint, 0 -> none) & next slot
+   uint8_t jS, jG;      // journal sector & generation
+   uint8_t cP;          // chunk reservation pages
+   bool xLive;          // checkpoint valid on flash
+   bool jE;             // previous journal sector awaiting erase
+
+   uint16_t lim (void) const { return(bP + nP - xN - jN); } // end of chunk storage
+   bool indexed (void) const { return(pX && pX->valid); }
+
+   // Start of chunk slot following page p (chunks are allocated at multiples of cP)
+   uint16_t nextSlot (const uint16_t p) const { return(p + cP - ((p - bP) % cP)); }
+
+   // Search state over the records of one object, visiting its chunks circularly
+   struct Walk
+   {
+      uint32_t a;       // next record
+      uint16_t p, e;    // current chunk page & end page
+      uint16_t sP;      // starting chunk page
+      uint8_t lap;
+   }; // struct Walk
+
+   // Start walk at chunk of object containing address a
+   void walkFrom (Walk& w, const uint32_t a, const uint16_t p, const uint16_t e)
+   {
+      w.a= a; w.p= w.sP= p; w.e= e; w.lap= 0;
+   } // walkFrom
+
+   // Advance to next chunk of object (in address order, wrapping at head)
+   bool walkChunk (Walk& w, const uint16_t id)
+   {
+      CFC::Rec j;
+      uint16_t p= w.e;
+      do
+      {
+         if (p >= hP) { p= bP; if (++w.lap > 1) { return(false); } }
+         const uint16_t n= getChunk(j, p);
+         if (0 == n) { p= nextSlot(p); continue; }
+         if ((CFC::OBJ == j.t) && (id == j.id) && j.live)
+         {
+            w.p= p; w.e= p + n; w.a= pageAddr(p) + CFC::HDR_J;
+            if ((p == w.sP) && (w.lap > 0)) { w.lap++; } // second visit of start chunk is the last
+            return(true);
+         }
+         p+= n;
+      } while (w.lap < 2);
+      return(false);
+   } // walkChunk
+
+   // Next record of object, false when all chunks visited
+   bool walkNext (Walk& w, const uint16_t id, CFC::Rec& r)
+   {
+      for (;;)
+      {
+         if (w.a < pageAddr(w.e))
+         {
+            const uint32_t n= getRec(r, w.a);
+            if ((n > 0) && (CFC::BAD != r.t)) { w.a+= n; return(true); }
+         }
+         if ((w.lap > 1) || !walkChunk(w, id)) { return(false); }
+      }
+   } // walkNext
+
+   // Find fragment by ID (following redirects), searching on from the current
+   // fragment. Sets read cursor.
+   bool locate (MFDFile& f, uint16_t id)
+   {
+      Walk w;
+      CFC::Rec r;
+      uint8_t hop= 0;
+
+      if (indexed())
+      {  // first live fragment from id: redirected-over fragments are simply absent
+         const uint16_t i= pX->find(f.id, id);
+         if (!pX->match(i, f.id) || (CFC::EOF_N == pX->e[i].n)) { return(false); }
+         const CFC::IdxEnt& x= pX->e[i];
+         f.fR= x.f; f.hA= x.a + CFC::HDR_D; f.lR= x.n; f.oR= 0;
+         f.rP= 0; f.rE= x.e;
+         return(true);
+      }
+      if (f.hA > 0) { walkFrom(w, f.hA + f.lR, f.rP, f.rE); }
+      else { walkFrom(w, pageAddr(hP), hP, hP); } // all chunks from base
+      while ((id > 0) && (id < f.nF) && walkNext(w, f.id, r))
+      {
+         if (!r.live) { continue; }
+         if ((CFC::FRAG == r.t) && (r.id == id))
+         {
+            f.fR= id; f.hA= r.a + CFC::HDR_D; f.lR= r.v; f.oR= 0;
+            f.rP= w.p; f.rE= w.e;
+            return(true);
+         }
+         if ((CFC::REDIR == r.t) && (r.id == id))
+         {
+            if ((0 == r.v) || (++hop > 16)) { return(false); }
+            id= r.v;
+            walkFrom(w, w.a, w.p, w.e);
+         }
+      }
+      return(false);
+   } // locate
+
+   // Reserve pages for a new chunk: at head until the end of chunk storage, then
+   // the next erased slot below head (verified blank, as an erase may have been
+   // interrupted). Returns pages (0 -> volume full).
+   uint8_t alloc (uint32_t& wA, uint32_t& eA)
+   {
+      uint16_t p= hP, n= min((uint16_t)cP, (uint16_t)(lim() - hP));
+      if ((hP >= lim()) || (n < 1))
+      {
+         CFC::Rec j;
+         uint16_t i= 0;
+         p= fP;
+         dev.sync();
+         while ((p == zP) || (getChunk(j, p) > 0))
+         {
+            p= nextSlot(p);
+            if (p >= hP) { p= bP; }
+            if (++i > (nP / cP)) { return(0); }
+         }
+         n= min((uint16_t)cP, (uint16_t)(hP - p));
+         UU32 a={pageAddr(p)};
+         if ((dev.dataScan(a, n << 8) < (n << 8)) && (erase(p, n) < n)) { return(0); } // not erasable
+         fP= nextSlot(p);
+         if (fP >= hP) { fP= bP; }
+      }
+      else { hP+= n; }
+      wA= pageAddr(p);
+      eA= pageAddr(p + n);
+      nC++;
+      return(n);
+   } // alloc
+
+   // Reserve a new chunk for f, returns pages (0 -> volume full)
+   uint8_t allocChunk (MFDFile& f) { return alloc(f.wA, f.eA); }
+
+   // Summary of the live records of an object
+   struct Tally
+   {
+      uint32_t tA;      // tail record
+      uint16_t tE, mF, mR;
+      bool any;
+
+      Tally (void) : tA{0}, tE{0}, mF{0}, mR{0}, any{false} { ; }
+
+      void add (MFDFile& f, const CFC::Rec& r, const uint16_t e)
+      {
+         if (CFC::FRAG == r.t)
+         {
+            any= true;
+            if (r.id > 0) { f.size+= r.v; }
+            if ((r.id >= mF) && (0 == mR)) { tA= r.a; tE= e; }
+            if (r.id > mF) { mF= r.id; }
+         }
+         else if ((CFC::REDIR == r.t) && (0 == r.v) && (r.id > mR))
+         {
+            mR= r.id;
+            f.rA= tA= r.a; tE= e;
+         }
+      } // add
+   }; // struct Tally
+
+   // Scan all records of object: size, next fragment ID and append position
+   // (after the live end-of-file redirect, else after the last fragment).
+   bool scanObj (MFDFile& f, const uint16_t id)
+   {
+      Tally t;
+      CFC::Rec r;
+
+      f.clear();
+      if (indexed())
+      {
+         r.live= true;
+         for (uint16_t i= pX->find(id, 0); pX->match(i, id); i++)
+         {
+            const CFC::IdxEnt& x= pX->e[i];
+            r.a= x.a; r.id= x.f;
+            if (CFC::EOF_N == x.n) { r.t= CFC::REDIR; r.v= 0; } else { r.t= CFC::FRAG; r.v= x.n; }
+            t.add(f, r, x.e);
+         }
+      }
+      else
+      {
+         Walk w;
+         walkFrom(w, pageAddr(hP), hP, hP);
+         while (walkNext(w, id, r))
+         {
+            if (r.live) { t.add(f, r, w.e); }
+         }
+      }
+      if (!t.any) { f.clear(); return(false); }
+      f.id= id;
+      f.nF= max(t.mF + 1, (int)t.mR);
+      f.wA= usedEnd(t.tA, t.tE);
+      f.eA= pageAddr(t.tE);
+      return(true);
+   } // scanObj
+
+   // Single sequential pass over all chunks, collecting live fragments & EOF
+   // redirects into the index. Returns chunks found.
+   uint16_t scanVol (void)
+   {
+      CFC::Rec j, r;
+      uint16_t p= bP;
+
+      pX->clear();
+      nC= 0; lastObj= 0; hP= bP;
+      while (p < lim())
+      {
+         const uint16_t n= chunkPages(j, getRecS(j, pageAddr(p)));
+         if (0 == n) { p= nextSlot(p); continue; }
+         if ((CFC::OBJ == j.t) && j.live)
+         {
+            const uint16_t e= min((uint16_t)(p + n), lim());
+            uint32_t a= pageAddr(p) + CFC::HDR_J, m;
+            nC++;
+            if (j.id > lastObj) { lastObj= j.id; }
+            while ((a < pageAddr(e)) && ((m= getRecS(r, a)) > 0))
+            {
+               if (r.live)
+               {
+                  if (CFC::FRAG == r.t) { CFC::IdxEnt x={a, j.id, r.id, r.v, e}; pX->add(x); }
+                  else if ((CFC::REDIR == r.t) && (0 == r.v)) { CFC::IdxEnt x={a, j.id, r.id, CFC::EOF_N, e}; pX->add(x); }
+               }
+               a+= m;
+            }
+         }
+         p+= n;
+         hP= min(p, lim());
+      }
+      scanEnd();
+      pX->sort();
+      return(nC);
+   } // scanVol
+
+   uint8_t ckCRC (const CFC::CkHdr& h)
+   {
+      const uint8_t *pE= (const uint8_t*)(pX->e);
+      const uint32_t nB= (uint32_t)h.nE * sizeof(CFC::IdxEnt);
+      uint8_t c= CRC8::compute((const uint8_t*)&(h.nE), 8);
+      for (uint32_t i= 0; i < nB; i+= 120) { c= CRC8::compute(pE+i, min((uint32_t)120, nB-i), c); }
+      return(c);
+   } // ckCRC
+
+   // Warm mount from checkpoint, false if absent or stale
+   bool loadIndex (void)
+   {
+      CFC::CkHdr h;
+      UU32 a={pageAddr(xP)};
+      if ((0 == xN) || (dev.dataRead((uint8_t*)&h, sizeof(h), a) != sizeof(h))) { return(false); }
+      if ((0 != memcmp(h.m, "CFX", 3)) || (0xFF != h.live) || (h.nE > CFC_INDEX_MAX) ||
+          (h.hP < bP) || (h.hP > lim())) { return(false); }
+      a.u32+= sizeof(h);
+      dev.dataRead((uint8_t*)(pX->e), h.nE * sizeof(CFC::IdxEnt), a);
+      pX->n= h.nE; pX->valid= true;
+      if (ckCRC(h) != h.crc) { pX->clear(); return(false); }
+      hP= h.hP; lastObj= h.lastObj; nC= h.nC;
+      return(true);
+   } // loadIndex
+
+   // Invalidate checkpoint ahead of modification
+   void touch (void)
+   {
+      if (xLive)
+      {
+         const uint8_t z= 0;
+         UU32 a={pageAddr(xP) + 3};
+         dev.dataWrite(&z, 1, a);
+         xLive= false;
+      }
+   } // touch
+
+   // Erase is not accepted while another is suspended: complete that first
+   // Issue erase of pages (sector aligned), returns pages erased
+   int erase (const uint16_t p, const uint16_t n)
+   {
+      if (dev.opSuspended()) { dev.opResume(); }
+      return dev.dataErase(p, n);
+   } // erase
+
+   static void put24 (uint8_t b[3], const uint32_t v) { b[0]= v; b[1]= v >> 8; b[2]= v >> 16; }
+   static uint32_t get24 (const uint8_t b[3]) { return(b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16)); }
+
+   uint32_t slotAddr (const uint8_t s, const uint16_t o) const
+   {
+      return(pageAddr(lim() + (s << 4)) + o * sizeof(CFC::Intent));
+   } // slotAddr
+
+   uint8_t slotSeq (const uint8_t s, const uint16_t o)
+   {
+      uint8_t g= 0xFF;
+      UU32 a={slotAddr(s, o)};
+      dev.dataRead(&g, 1, a);
+      return(g);
+   } // slotSeq
+
+   // Read slot to i, returns 1 if valid, 0 if erased, -1 otherwise (torn or partly erased)
+   int8_t getSlot (CFC::Intent& i, const uint8_t s, const uint16_t o)
+   {
+      UU32 a={slotAddr(s, o)};
+      dev.dataRead((uint8_t*)&i, sizeof(i), a);
+      if ((0xFF != i.seq) && (CRC8::compute((const uint8_t*)&i, sizeof(i)-2) == i.crc)) { return(1); }
+      const uint8_t *b= (const uint8_t*)&i;
+      for (uint8_t k= 0; k < sizeof(i); k++) { if (0xFF != b[k]) { return(-1); } }
+      return(0);
+   } // getSlot
+
+   // Record intent ahead of phase 1 (switching sector when full)
+   void logIntent (const uint32_t a, const uint32_t r, const uint16_t j, const uint16_t f, const uint16_t m, const uint8_t rv)
+   {
+      CFC::Intent i;
+      if (0 == jN) { return; }
+      if (jO >= CFC::INTENT_SLOTS)
+      {  // previous sector holds only completed intents
+         if (jE) { erase(lim() + ((jS ^ 1) << 4), 16); } // not yet erased
+         jS^= 1; jO= 0;
+         if (0xFF == ++jG) { jG= 0; }
+         jE= true;
+      }
+      i.seq= jG; put24(i.a, a);
+      put24(i.r, r); i.rv= rv;
+      i.j= j; i.f= f; i.m= m;
+      i.crc= CRC8::compute((const uint8_t*)&i, sizeof(i)-2);
+      i.done= 0xFF;
+      writeSpan(slotAddr(jS, jO), (const uint8_t*)&i, sizeof(i));
+      jO++;
+   } // logIntent
+
+   // Complete intent, issuing erase of previous sector when no other erase is
+   // suspended (else deferred to a later intent)
+   void logDone (const bool defer=false)
+   {
+      const uint8_t z= 0;
+      if (0 == jN) { return; }
+      UU32 a={slotAddr(jS, jO-1) + (uint32_t)sizeof(CFC::Intent) - 1};
+      dev.dataWrite(&z, 1, a);
+      if (jE && !defer && !dev.opSuspended())
+      {  // erase proceeds while the application continues
+         erase(lim() + ((jS ^ 1) << 4), 16);
+         jE= false;
+      }
+   } // logDone
+
+   // Locate journal tail: valid sector of newer generation & next free slot (by
+   // bisection), reading last intent to i. False if no valid sector.
+   bool jFind (CFC::Intent& i)
+   {
+      CFC::Intent i0, i1;
+      const int8_t v0= getSlot(i0, 0, 0), v1= getSlot(i1, 1, 0);
+      uint16_t lo= 1, hi= CFC::INTENT_SLOTS;
+      jS= jO= jG= 0; jE= false;
+      if ((v0 < 1) && (v1 < 1))
+      {  // nothing complete: move on to a fresh sector at next intent
+         if ((v0 | v1) != 0) { jO= CFC::INTENT_SLOTS; jS= 1; jE= true; }
+         return(false);
+      }
+      if (v0 < 1) { jS= 1; }
+      else if (v1 > 0) { jS= ((int8_t)(i1.seq - i0.seq) > 0); }
+      jE= (0 != (jS ? v0 : v1));
+      jG= jS ? i1.seq : i0.seq;
+      while (lo < hi)
+      {
+         const uint16_t o= (lo + hi) >> 1;
+         if (0xFF == slotSeq(jS, o)) { hi= o; } else { lo= o + 1; }
+      }
+      jO= lo;
+      UU32 a={slotAddr(jS, jO-1)};
+      dev.dataRead((uint8_t*)&i, sizeof(i), a);
+      if (jO < CFC::INTENT_SLOTS)
+      {  // skip a slot torn ahead of its sequence byte
+         uint8_t b[sizeof(CFC::Intent)];
+         a.u32= slotAddr(jS, jO);
+         dev.dataRead(b, sizeof(b), a);
+         for (uint8_t k= 0; k < sizeof(b); k++) { if (0xFF != b[k]) { jO++; break; } }
+      }
+      return(true);
+   } // jFind
+
+   // Delete records copied from a (new chunk header regenerated if rv) up to the end of used storage
+   void undoCopy (uint32_t a, const uint16_t j, const uint8_t rv)
+   {
+      CFC::Rec r;
+      uint32_t n;
+      const uint32_t e= pageAddr(nextSlot(a >> 8));
+      if (rv)
+      {
+         uint8_t h[CFC::HDR_J];
+         genObjHdr(h, j, rv);
+         writeSpan(a, h, CFC::HDR_J);
+         a+= CFC::HDR_J;
+         dev.sync();
+      }
+      while ((a < e) && ((n= getRec(r, a)) > 0))
+      {
+         if (r.live) { kill(a, r.t); dev.sync(); }
+         a+= n;
+      }
+   } // undoCopy
+
+   // Complete or undo an append interrupted by power loss, true if action taken
+   bool recover (void)
+   {
+      CFC::Intent i;
+      uint8_t h[CFC::HDR_J + CFC::HDR_D];
+      if ((0 == jN) || !jFind(i) || (0xFF != i.done) ||
+          (CRC8::compute((const uint8_t*)&i, sizeof(i)-2) != i.crc)) { return(false); }
+      const uint32_t a= get24(i.a), r= get24(i.r);
+      const uint32_t aD= a + (i.rv ? CFC::HDR_J : 0), aR= aD + CFC::HDR_D + i.m;
+      UU32 u={aR};
+      bool fwd= false;
+      if (CFC::INTENT_GC == i.f)
+      {  // relocation complete once victim header deleted, else delete the copies
+         CFC::Rec v;
+         getRec(v, r);
+         if (v.live) { undoCopy(a, i.j, i.rv); nUndo++; } else { nFwd++; }
+         logDone();
+         dev.sync();
+         return(true);
+      }
+      dev.dataRead(h, CFC::HDR_R, u);
+      for (uint8_t k= 0; k < CFC::HDR_R; k++) { fwd|= (0xFF != h[k]); }
+      if (fwd)
+      {  // marker begun: data complete, reprogram marker & delete previous
+         genRedirHdr(h, i.f+1, 0);
+         writeSpan(aR, h, CFC::HDR_R);
+         if (r > 0) { kill(r, CFC::REDIR); }
+         nFwd++;
+      }
+      else
+      {  // restore framing over any torn header bytes, then delete
+         int n= 0;
+         if (i.rv) { n= genObjHdr(h, i.j, i.rv); }
+         n+= genFragHdr(h+n, i.f, i.m);
+         writeSpan(a, h, n);
+         kill(aD, CFC::FRAG);
+         nUndo++;
+      }
+      logDone();
+      dev.sync();
+      return(true);
+   } // recover
+
+   // Match name token of F0 payload at a
+   bool nameIs (const uint32_t a, const uint16_t v, const char *name)
+   {
+      uint8_t b[64];
+      const int8_t l= lentil(name);
+      const int nB= min((int)v, (int)sizeof(b));
+      UU32 u={a};
+      dev.dataRead(b, nB, u);
+      for (int i= 0; (i+1) < nB; i+= 2 + b[i+1])
+      {
+         if (0xE0 != (b[i] & 0xF0)) { break; }
+         if ((0xEA == b[i]) && (l == b[i+1]) && ((i + 2 + l) <= nB) && (0 == memcmp(b+i+2, name, l))) { return(true); }
+      }
+      return(false);
+   } // nameIs
+
+public:
+   uint16_t nFwd, nUndo; // interrupted appends completed & undone at mount
+
+   MFDVol (MFDDev& d) : MFDRec(d), pX{NULL}, bP{0}, nP{0}, hP{0}, zP{0}, lastObj{0}, nC{0}, xP{0}, xN{0},
+      jN{0}, jO{0}, jS{0}, jG{0}, cP{CFC_CHUNK_PAGES}, xLive{false}, jE{false}, nFwd{0}, nUndo{0} { ; }
+
+   // Volume in pages, must be 4K sector aligned for format(). The chunk reservation
+   // is rounded up to whole sectors, so that a slot may be erased for reuse.
+   void setVolume (const uint16_t baseP, const uint16_t numP, const uint8_t chunkP=CFC_CHUNK_PAGES)
+   {
+      bP= baseP; nP= numP; hP= fP= bP;
+      cP= (constrain(chunkP, 1, 0x70) + 0xF) & 0x70;
+      lastObj= 0; nC= 0;
+      xP= bP + nP; xN= 0; xLive= false;
+      jN= jO= 0;
+      if (pX) { pX->clear(); pX->valid= false; }
+   } // setVolume
+
+   // Attach index (after setVolume), optionally reserving sectors at the end of
+   // the volume for its checkpoint. Takes effect at mount() or format().
+   void setIndex (MFDIndex *pIdx, const bool ckpt=true)
+   {
+      pX= pIdx;
+      xN= 0;
+      if (pX)
+      {
+         const uint32_t nB= sizeof(CFC::CkHdr) + sizeof(pX->e);
+         const uint16_t n= ((nB + 0xFFF) >> 12) << 4;
+         if (ckpt && (n <= (nP / 2))) { xN= n; }
+         pX->clear(); pX->valid= false;
+      }
+      xP= bP + nP - xN;
+      xLive= false;
+   } // setIndex
+
+   // Reserve journal sectors (after setIndex) for power fail recovery at mount()
+   void setJournal (const bool on=true)
+   {
+      jN= 0;
+      if (on && ((CFC::JOURNAL_PAGES + xN) <= (nP / 2))) { jN= CFC::JOURNAL_PAGES; }
+      jS= jG= 0; jO= 0; jE= false;
+   } // setJournal
+
+   uint16_t head (void) const { return(hP); }
+   uint16_t freePages (void) const { return(lim() - hP); }
+   uint16_t objects (void) const { return(lastObj); }
+
+   void format (void)
+   {
+      dev.dataErase(bP, nP);
+      dev.sync();
+      hP= fP= bP;
+      lastObj= 0; nC= 0;
+      xLive= false;
+      jS= jG= 0; jO= 0; jE= false;
+      if (pX) { pX->clear(); }
+   } // format
+
+   // Find head & highest object ID, returns chunks found. With an index: load
+   // checkpoint if current, else build index by sequential scan of all records.
+   // Without: scan of chunk headers only. An interrupted append is first
+   // resolved from the journal.
+   uint16_t mount (void)
+   {
+      CFC::Rec j;
+      uint16_t p= bP;
+      dev.sync();
+      nFwd= nUndo= 0;
+      recover();
+      fP= bP;
+      if (pX)
+      {
+         xLive= loadIndex();
+         if (xLive) { return(nC); }
+         return scanVol();
+      }
+      lastObj= 0; nC= 0; hP= bP;
+      while (p < lim())
+      {
+         const uint16_t n= getChunk(j, p);
+         if (0 == n) { p= nextSlot(p); continue; }
+         if ((CFC::OBJ == j.t) && j.live)
+         {
+            nC++;
+            if (j.id > lastObj) { lastObj= j.id; }
+         }
+         p+= n;
+         hP= min(p, lim());
+      }
+      return(nC);
+   } // mount
+
+   // Save index to reserved sectors, returns entries saved (0 -> no index/space)
+   uint16_t checkpoint (void)
+   {
+      CFC::CkHdr h;
+      if (!indexed() || (0 == xN)) { return(0); }
+      if (xLive) { return(pX->n); }
+      memset(&h, 0, sizeof(h));
+      memcpy(h.m, "CFX", 3);
+      h.live= 0xFF;
+      h.nE= pX->n; h.hP= hP; h.lastObj= lastObj; h.nC= nC;
+      h.crc= ckCRC(h);
+      const uint32_t nB= (uint32_t)h.nE * sizeof(CFC::IdxEnt);
+      erase(xP, ((sizeof(h) + nB + 0xFFF) >> 12) << 4);
+      writeSpan(pageAddr(xP), (const uint8_t*)&h, sizeof(h));
+      writeSpan(pageAddr(xP) + sizeof(h), (const uint8_t*)(pX->e), nB);
+      dev.sync();
+      xLive= true;
+      return(h.nE);
+   } // checkpoint
+
+   // New object with attributes (name & creation time), open for append
+   bool create (MFDFile& f, const char *name, CClock *pC=NULL)
+   {
+      FragAsm fa;
+      f.clear();
+      touch();
+      const uint8_t n= allocChunk(f);
+      if (n > 0)
+      {  // reservation rounds up to n pages for F0 up to 255 bytes
+         const uint16_t id= lastObj + 1;
+         const uint32_t usx= (n > 1) ? ((uint32_t)(n-1) << 8) - (HDR_OJDF_BYTES-1) : 0;
+         int b= MFDAsm::create(fa, name, pC, id, usx);
+         if (b > 0)
+         {
+            uint8_t hR[CFC::HDR_R];
+            UU32 a={f.wA};
+            logIntent(f.wA, 0, id, 0, b - HDR_OJDF_BYTES, encodeRV(b + usx));
+            if (fa.commit(a, dev) == b)
+            {
+               genRedirHdr(hR, 1, 0);
+               writeSpan(f.wA + b, hR, CFC::HDR_R); // commit marker
+               logDone();
+               b+= CFC::HDR_R;
+               lastObj= id;
+               f.id= id; f.nF= 1;
+               if (pX)
+               {
+                  const uint16_t e= f.eA >> 8;
+                  CFC::IdxEnt x0={f.wA + CFC::HDR_J, id, 0, (uint16_t)(b - HDR_OJDF_BYTES - CFC::HDR_R), e};
+                  CFC::IdxEnt xR={f.wA + b - CFC::HDR_R, id, 1, CFC::EOF_N, e};
+                  pX->put(x0); pX->put(xR);
+               }
+               f.wA+= b;
+               f.rA= f.wA - CFC::HDR_R;
+               return(true);
+            }
+         }
+      }
+      f.clear();
+      return(false);
+   } // create
+
+   bool open (MFDFile& f, const uint16_t id)
+   {
+      dev.sync(); // reads are ignored while programming
+      if ((id > 0) && (id <= lastObj)) { return scanObj(f, id); }
+      f.clear();
+      return(false);
+   } // open
+
+   // Match name attribute of each object descriptor (F0)
+   bool open (MFDFile& f, const char *name)
+   {
+      CFC::Rec j, r;
+      uint16_t p= bP;
+      dev.sync();
+      if (indexed())
+      {
+         for (uint16_t i= 0; i < pX->n; i++)
+         {
+            const CFC::IdxEnt& x= pX->e[i];
+            if ((0 == x.f) && nameIs(x.a + CFC::HDR_D, x.n, name)) { return open(f, x.j); }
+         }
+         f.clear();
+         return(false);
+      }
+      while (p < hP)
+      {
+         const uint16_t n= getChunk(j, p);
+         if (0 == n) { p= nextSlot(p); continue; }
+         if ((CFC::OBJ == j.t) && j.live &&
+             (getRec(r, pageAddr(p) + CFC::HDR_J) > 0) && r.live && (CFC::FRAG == r.t) && (0 == r.id) &&
+             nameIs(r.a + CFC::HDR_D, r.v, name))
+         {
+            return open(f, j.id);
+         }
+         p+= n;
+      }
+      f.clear();
+      return(false);
+   } // open
+
+   void close (MFDFile& f) { f.clear(); }
+
+   // Append data as one or more fragments, returns bytes written
+   int append (MFDFile& f, const uint8_t b[], int n)
+   {
+      FragAsm fa;
+      int t= 0;
+      if (f.isOpen()) { touch(); }
+      while (f.isOpen() && (n > 0))
+      {
+         uint8_t *pJ= NULL, rv= 0, hR[CFC::HDR_R];
+         fa.reset();
+         if ((int)(f.eA - f.wA) < (CFC::HDR_D + CFC::HDR_R + CFC_FRAG_MIN))
+         {
+            const uint8_t p= allocChunk(f);
+            if (0 == p) { break; }
+            pJ= fa.claim(CFC::HDR_J);
+            rv= encodeRV((uint32_t)p << 8);
+            genObjHdr(pJ, f.id, rv);
+         }
+         const int room= (f.eA - f.wA) - (pJ ? CFC::HDR_J : 0) - CFC::HDR_D - CFC::HDR_R;
+         const int m= min(min(n, room), CFC_FRAG_MAX);
+         genFragHdr(fa.claim(CFC::HDR_D), f.nF, m);
+         for (int i= 0; i < m; i+= 255) { fa.append(b+i, min(255, m-i)); }
+
+         int w= fa.sumFragBytesFI();
+         UU32 a={f.wA};
+         logIntent(f.wA, f.rA, f.id, f.nF, m, rv);
+         if (fa.commit(a, dev) != w) { break; }
+         genRedirHdr(hR, f.nF+1, 0);
+         writeSpan(f.wA + w, hR, CFC::HDR_R); // commit marker
+         w+= CFC::HDR_R;
+         if (f.rA > 0) { kill(f.rA, CFC::REDIR); }
+         logDone();
+         if (pX)
+         {  // fragment replaces EOF entry with same key
+            const uint16_t e= f.eA >> 8;
+            CFC::IdxEnt xD={f.wA + (pJ ? CFC::HDR_J : 0), f.id, f.nF, (uint16_t)m, e};
+            CFC::IdxEnt xR={f.wA + w - CFC::HDR_R, f.id, (uint16_t)(f.nF+1), CFC::EOF_N, e};
+            pX->put(xD); pX->put(xR);
+         }
+         f.wA+= w;
+         f.rA= f.wA - CFC::HDR_R;
+         f.nF++;
+         f.size+= m;
+         b+= m; n-= m; t+= m;
+      }
+      return(t);
+   } // append
+
+   // Release leading fragments holding at most n bytes (log retention): a redirect
+   // from F1 to the first fragment retained is added at the tail, then the previous
+   // such redirect & the fragments released are deleted. Returns bytes released.
+   uint32_t trim (MFDFile& f, const uint32_t n)
+   {
+      FragAsm fa;
+      Walk w;
+      CFC::Rec r;
+      uint32_t t= 0, rF= 0;
+      uint16_t k;
+      if (!f.isOpen()) { return(0); }
+      dev.sync();
+      f.rewind();
+      if (!locate(f, 1)) { return(0); }
+      for (k= f.fR; (t + f.lR) <= n; )
+      {
+         t+= f.lR;
+         k= f.fR + 1;
+         if (!locate(f, k)) { break; }
+      }
+      f.rewind();
+      if (0 == t) { return(0); }
+      touch();
+      walkFrom(w, pageAddr(hP), hP, hP);
+      while (walkNext(w, f.id, r))
+      {
+         if (r.live && (CFC::REDIR == r.t) && (1 == r.id) && (r.v > 0)) { rF= r.a; break; }
+      }
+      // redirect, moving end-of-file to a new chunk when no room remains
+      const bool mv= ((int)(f.eA - f.wA) < CFC::HDR_R);
+      uint32_t wA= f.wA, eA= f.eA;
+      if (mv)
+      {
+         const uint8_t p= alloc(wA, eA);
+         if (0 == p) { return(0); }
+         genObjHdr(fa.claim(CFC::HDR_J), f.id, encodeRV((uint32_t)p << 8));
+      }
+      genRedirHdr(fa.claim(CFC::HDR_R), 1, k);
+      if (mv) { genRedirHdr(fa.claim(CFC::HDR_R), f.nF, 0); }
+      const int m= fa.sumFragBytesFI();
+      UU32 a={wA};
+      if (fa.commit(a, dev) != m) { return(0); }
+      if (mv)
+      {
+         if (f.rA > 0) { kill(f.rA, CFC::REDIR); }
+         f.eA= eA;
+         f.rA= wA + m - CFC::HDR_R;
+         if (pX) { CFC::IdxEnt xR={f.rA, f.id, f.nF, CFC::EOF_N, (uint16_t)(eA >> 8)}; pX->put(xR); }
+      }
+      f.wA= wA + m;
+      if (rF > 0) { kill(rF, CFC::REDIR); }
+      dev.sync();
+      walkFrom(w, pageAddr(hP), hP, hP);
+      while (walkNext(w, f.id, r))
+      {
+         if (r.live && (CFC::FRAG == r.t) && (r.id > 0) && (r.id < k))
+         {
+            kill(r.a, CFC::FRAG);
+            dev.sync();
+            if (pX) { pX->remove(f.id, r.id); }
+         }
+      }
+      f.size-= t;
+      return(t);
+   } // trim
+
+   // Sequential read in fragment ID order
+   int read (MFDFile& f, uint8_t b[], int n)
+   {
+      int t= 0;
+      dev.sync();
+      while (f.isOpen() && (n > 0))
+      {
+         if (f.oR >= f.lR)
+         {
+            if (!locate(f, f.fR+1)) { break; }
+            if (0 == f.lR) { continue; }
+         }
+         const int m= min(n, (int)(f.lR - f.oR));
+         UU32 a={f.hA + f.oR};
+         dev.dataRead(b, m, a);
+         f.oR+= m; f.pos+= m;
+         b+= m; n-= m; t+= m;
+      }
+      return(t);
+   } // read
+
+   // Set read position, returns false beyond end of file
+   bool seek (MFDFile& f, uint32_t pos)
+   {
+      if (!f.isOpen()) { return(false); }
+      f.rewind();
+      dev.sync();
+      f.pos= pos;
+      while (pos > 0)
+      {
+         if (!locate(f, f.fR+1)) { f.pos-= pos; return(false); }
+         if (pos < f.lR) { f.oR= pos; return(true); }
+         pos-= f.lR; f.oR= f.lR;
+      }
+      return(true);
+   } // seek
+
+   void list (Stream& s)
+   {
+      CFC::Rec j;
+      uint16_t p= bP, nC= 0;
+      s.print("MFDVol: pages="); s.print(nP); s.print(" head="); s.print(hP - bP);
+      s.print(" obj="); s.println(lastObj);
+      dev.sync();
+      while (p < hP)
+      {
+         const uint16_t n= getChunk(j, p);
+         if (0 == n) { p= nextSlot(p); continue; }
+         if (CFC::OBJ == j.t)
+         {
+            if (++nC > 16) { s.print(" ..."); break; }
+            s.print(" J"); s.print(j.id); s.print('@'); s.print(p - bP);
+         }
+         p+= n;
+      }
+      s.println();
+   } // list
+
+}; // MFDVol
+
+#endif // MFD_FS_HPP
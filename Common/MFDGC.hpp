@@ -0,0 +1,363 @@
+// Duino/Common/MFDGC.hpp - Incremental garbage collection for CFC volumes
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef MFD_GC_HPP
+#define MFD_GC_HPP
+
+#include "MFDFS.hpp"
+
+// Chunks accumulate dead storage: fragments released by trim(), superseded
+// end-of-file redirects, undone appends and the unused end of chunks no longer
+// appended to. Collection proceeds in short steps from the main loop, collect()
+// bounding the time spent per call:
+//    survey - record headers of one chunk per step, electing the chunk with the
+//       most dead bytes (the tail chunk of an object, holding its end-of-file
+//       redirect, is never moved);
+//    copy - live records (fragments & redirects) of the victim are copied, up to
+//       CFC_GC_STEP bytes per step, by gather write into a destination chunk of
+//       the same object (shared by successive victims while room remains);
+//    erase - the victim header is deleted and its sector erase issued.
+// Foreground operations suspend an erase in flight rather than wait for it.
+// Relocation of each victim is journaled (CFC::INTENT_GC) so that after power
+// loss either the victim or its copies are live. Requires a sector aligned volume.
+// NB: relocation invalidates read cursors within the victim, seek() to resume.
+
+#ifndef CFC_GC_MIN_DEAD
+#define CFC_GC_MIN_DEAD 1024 // dead bytes below which a chunk is not worth copying
+#endif
+#define CFC_GC_STEP 256 // bytes copied per step
+
+namespace CFC
+{
+   enum GCPhase : uint8_t { GC_IDLE, GC_SURVEY, GC_COPY, GC_ERASE };
+}; // namespace CFC
+
+class MFDCompact : public MFDVol
+{
+protected:
+   uint32_t vA;         // copy: next victim record
+   uint32_t rA, rE;     // copy: current record position & end
+   uint32_t dA, dE;     // destination write address & end of chunk (0 == dE -> none)
+   uint32_t uA;         // start of copies in destination (journaled)
+   uint32_t cD;         // destination of record being copied
+   uint32_t tR;         // time of last resume (us)
+   uint16_t sP;         // survey position
+   uint16_t vP, vE;     // victim chunk (0 == vE -> none)
+   uint16_t vJ, vD, vL; // victim object, dead & live bytes
+   uint16_t dJ, dP;     // destination object & chunk
+   uint16_t cF, cN;     // record being copied: fragment ID & payload bytes (0xFFFF -> redirect)
+   uint8_t rv;          // reservation of new destination chunk (header not yet written), else 0
+   uint8_t uV;          // journaled reservation (0 -> copies appended to existing destination)
+   uint8_t phase;
+   bool logged, sus;
+
+   // Dead & live bytes of chunk, false if tail of object (or current destination)
+   bool measure (uint16_t& d, uint16_t& l, const CFC::Rec& j, const uint16_t p, const uint16_t e)
+   {
+      CFC::Rec r;
+      uint32_t a= pageAddr(p) + CFC::HDR_J, m;
+      const bool live= j.live && (CFC::OBJ == j.t);
+      d= l= 0;
+      if (live && (p == dP) && (dE > 0)) { return(false); }
+      while (live && (a < pageAddr(e)) && ((m= getRec(r, a)) > 0))
+      {
+         if (r.live)
+         {
+            if ((CFC::REDIR == r.t) && (0 == r.v)) { return(false); }
+            l+= m;
+         }
+         a+= m;
+      }
+      d= ((e - p) << 8) - l - (live ? CFC::HDR_J : 0);
+      return(true);
+   } // measure
+
+   void survey (void)
+   {
+      CFC::Rec j;
+      uint16_t d, l, n= getChunk(j, sP);
+      if (n > 0)
+      {
+         const uint16_t e= min((uint16_t)nextSlot(sP), hP);
+         if (measure(d, l, j, sP, e) && (d > vD))
+         {
+            vP= sP; vE= e; vD= d; vL= l;
+            vJ= j.live ? j.id : 0;
+         }
+      }
+      sP= nextSlot(sP);
+   } // survey
+
+   // Next live record of victim from vA, setting copy range; false at end
+   bool nextLive (void)
+   {
+      CFC::Rec r;
+      uint32_t m;
+      while (vJ && (vA < pageAddr(vE)) && ((m= getRec(r, vA)) > 0))
+      {
+         const uint32_t a= vA;
+         vA+= m;
+         if (r.live)
+         {
+            rA= a; rE= a + m;
+            cF= r.id; cN= (CFC::FRAG == r.t) ? r.v : 0xFFFF;
+            return(true);
+         }
+      }
+      return(false);
+   } // nextLive
+
+   // Destination for the live records of the victim, false if volume full
+   bool openDest (const bool f0)
+   {
+      if ((dJ == vJ) && (dE > 0) && ((dE - dA) >= vL) && !f0) { return(true); }
+      dJ= vJ; rv= 0;
+      const uint8_t p= alloc(dA, dE);
+      if (0 == p) { dE= 0; return(false); }
+      dP= dA >> 8;
+      rv= encodeRV((uint32_t)p << 8);
+      return(true);
+   } // openDest
+
+   // Copy up to one step of the current record
+   bool copyStep (void)
+   {
+      FragAsm fa;
+      uint8_t b[CFC_GC_STEP];
+      const int n= min((uint32_t)CFC_GC_STEP, rE - rA);
+      UU32 a={rA};
+      dev.dataRead(b, n, a);
+      if (rv) { genObjHdr(fa.claim(CFC::HDR_J), dJ, rv); }
+      for (int i= 0; i < n; i+= 255) { fa.append(b+i, min(255, n-i)); }
+      const int w= fa.sumFragBytesFI();
+      a.u32= dA;
+      if (fa.commit(a, dev) != w) { return(false); }
+      if (rv) { dA+= CFC::HDR_J; rv= 0; }
+      if (rA + (CFC::HDR_D + cN) == rE) { cD= dA; } // first step of fragment
+      dA+= n; rA+= n;
+      nCopy+= n;
+      if ((0xFFFF != cN) && (rA == rE) && pX)
+      {  // last step of fragment: index entry follows complete copy
+         CFC::IdxEnt x={cD, dJ, cF, cN, (uint16_t)(dE >> 8)};
+         pX->put(x);
+      }
+      return(true);
+   } // copyStep
+
+   // Delete victim (copies complete) & issue its erase
+   void release (void)
+   {
+      CFC::Rec j;
+      if (vJ && (getRec(j, pageAddr(vP)) > 0) && j.live) { kill(pageAddr(vP), CFC::OBJ); }
+      if (logged) { logDone(true); logged= false; } // no wait on journal erase
+      erase(vP, vE - vP);
+      zP= vP;
+      nC-= (vJ > 0);
+      nFree++;
+      phase= CFC::GC_ERASE;
+   } // release
+
+   // Index entries of victim fragments copied so far revert to the victim
+   void restoreIdx (void)
+   {
+      CFC::Rec r;
+      uint32_t a= pageAddr(vP) + CFC::HDR_J, m;
+      while ((a < vA) && ((m= getRec(r, a)) > 0))
+      {
+         if (r.live && (CFC::FRAG == r.t)) { CFC::IdxEnt x={a, vJ, r.id, r.v, vE}; pX->put(x); }
+         a+= m;
+      }
+   } // restoreIdx
+
+   // Undo relocation in progress (victim object modified by foreground)
+   void abandon (void)
+   {
+      if (CFC::GC_COPY == phase)
+      {
+         dev.sync();
+         if (logged)
+         {
+            undoCopy(uA, dJ, uV);
+            if (pX) { restoreIdx(); }
+            logDone();
+            logged= false;
+         }
+         dE= 0;
+         phase= CFC::GC_IDLE;
+      }
+   } // abandon
+
+   // One bounded step, false when nothing (more) can be done now
+   bool step (void)
+   {
+      if (CFC::GC_ERASE == phase)
+      {
+         if (sus || !dev.sync(1)) { return(false); }
+         phase= CFC::GC_IDLE; zP= 0;
+         return(true);
+      }
+      if (!dev.sync(1)) { return(true); } // program in progress
+      switch(phase)
+      {
+         case CFC::GC_IDLE :
+            sP= bP; vE= 0; vD= 0;
+            phase= CFC::GC_SURVEY;
+            return(true);
+         case CFC::GC_SURVEY :
+            if (sP < hP) { survey(); return(true); }
+            if ((vE > 0) && (vD >= CFC_GC_MIN_DEAD))
+            {
+               nVictim++;
+               vA= pageAddr(vP) + CFC::HDR_J; rA= rE= 0;
+               phase= CFC::GC_COPY;
+               return(true);
+            }
+            phase= CFC::GC_IDLE;
+            return(false);
+         case CFC::GC_COPY :
+            if (rA >= rE)
+            {
+               if (!nextLive()) { release(); return(true); }
+               if (!logged)
+               {
+                  if (!openDest(0 == cF && 0xFFFF != cN)) { rA= rE= 0; phase= CFC::GC_IDLE; return(false); }
+                  uA= dA; uV= rv;
+                  touch();
+                  logIntent(uA, pageAddr(vP), vJ, CFC::INTENT_GC, 0, rv);
+                  logged= true;
+                  return(true); // copy follows intent program
+               }
+            }
+            if (!copyStep()) { abandon(); return(false); }
+            return(true);
+      }
+      return(false);
+   } // step
+
+   // Any erase in flight (collection, journal or reuse of a slot) is suspended:
+   // none implies collection erase complete (the foreground leaves a program in
+   // flight, so step() may not observe the device idle)
+   void suspend (void)
+   {
+      if (!sus)
+      {
+         const uint32_t dt= micros() - tR;
+         if (dt < W25Q::SUSPEND_INTERVAL_US) { delayMicroseconds(W25Q::SUSPEND_INTERVAL_US - dt); }
+         sus= dev.opSuspend();
+         nSuspend+= sus;
+         if (!sus && (CFC::GC_ERASE == phase)) { phase= CFC::GC_IDLE; zP= 0; }
+      }
+   } // suspend
+
+   void resume (void)
+   {
+      if (sus)
+      {
+         dev.opResume();
+         tR= micros();
+         sus= false;
+      }
+   } // resume
+
+public:
+   uint32_t nCopy;      // bytes relocated
+   uint16_t nVictim, nFree, nSuspend; // chunks relocated, erased & erase suspensions
+
+   MFDCompact (MFDDev& d) : MFDVol(d), dE{0}, cD{0}, tR{0}, vE{0}, vJ{0}, dJ{0}, dP{0}, rv{0}, uV{0},
+      phase{CFC::GC_IDLE}, logged{false}, sus{false}, nCopy{0}, nVictim{0}, nFree{0}, nSuspend{0} { ; }
+
+   // Run collection steps for up to us microseconds (at least one step), returns phase
+   uint8_t collect (const uint32_t us)
+   {
+      const uint32_t t0= micros();
+      if ((0 != (cP & 0xF)) || (0 != (bP & 0xF))) { return(phase); }
+      while (step() && ((micros() - t0) < us)) { ; }
+      return(phase);
+   } // collect
+
+   uint8_t gcPhase (void) const { return(phase); }
+
+   // Foreground operations: suspend collection erase in flight, restart collection
+   // of an object modified under it
+   uint16_t mount (void) { abandon(); phase= CFC::GC_IDLE; dE= 0; zP= 0; dev.sync(); return MFDVol::mount(); }
+   void format (void) { phase= CFC::GC_IDLE; dE= 0; zP= 0; MFDVol::format(); }
+
+   bool create (MFDFile& f, const char *name, CClock *pC=NULL)
+   {
+      suspend();
+      const bool r= MFDVol::create(f, name, pC);
+      resume();
+      return(r);
+   } // create
+
+   int append (MFDFile& f, const uint8_t b[], int n)
+   {
+      suspend();
+      const int r= MFDVol::append(f, b, n);
+      resume();
+      return(r);
+   } // append
+
+   uint32_t trim (MFDFile& f, const uint32_t n)
+   {
+      if (vJ == f.id) { abandon(); }
+      suspend();
+      const uint32_t r= MFDVol::trim(f, n);
+      resume();
+      return(r);
+   } // trim
+
+   int read (MFDFile& f, uint8_t b[], int n)
+   {
+      suspend();
+      const int r= MFDVol::read(f, b, n);
+      resume();
+      return(r);
+   } // read
+
+   bool open (MFDFile& f, const uint16_t id)
+   {
+      suspend();
+      const bool r= MFDVol::open(f, id);
+      resume();
+      return(r);
+   } // open
+
+   bool open (MFDFile& f, const char *name)
+   {
+      suspend();
+      const bool r= MFDVol::open(f, name);
+      resume();
+      return(r);
+   } // open
+
+   bool seek (MFDFile& f, const uint32_t pos)
+   {
+      if (vJ == f.id) { abandon(); }
+      suspend();
+      const bool r= MFDVol::seek(f, pos);
+      resume();
+      return(r);
+   } // seek
+
+   // NB: when an index must be rewritten, its erase first completes the collection erase
+   uint16_t checkpoint (void)
+   {
+      suspend();
+      const uint16_t r= MFDVol::checkpoint();
+      resume();
+      return(r);
+   } // checkpoint
+
+   void list (Stream& s)
+   {
+      suspend();
+      MFDVol::list(s);
+      resume();
+   } // list
+
+}; // MFDCompact
+
+#endif // MFD_GC_HPP
@@ -6,7 +6,7 @@
 #ifndef MFD_HACKS_HPP
 #define MFD_HACKS_HPP
 
-#include "SWCRC.hpp"
+#include "CRC.hpp"
 
 
 // Compact File Chunk declarations: a "simple" DIY approach to reliable, flexible and
@@ -40,6 +40,8 @@ extern "C" {
 // 1011ssss xxxxiiii [micro-payload] rrrrrrrr ssss1101 = 0xBSIX ... RRSD
 // "s" bits give number of bytes to skip between end of header to start of footer, coding TBD.
 // "x" are extension bits (reserved, default to 0xF) CONSIDER: sequence number?
+//    x bit 3 (0x80 of second byte) programmed to zero marks a deleted record: CRC then
+//    fails but framing remains intact, so that a scan can skip over it.
 // "i" bits are chunk id code
 // "r" are CRC8 computed over the header (?) & payload bytes (footer is excluded)
 // header & size bits are repeated (swapped) at end of footer to further help identify errors
@@ -275,6 +277,18 @@ protected:
       return genMicroFtr(hb,i);
     } // genFragHdr
 
+   int genRedirHdr (uint8_t hb[8], const uint16_t id, const uint16_t t)
+   {
+      int i= genMicroHdr(hb,0xD);
+
+      hb[i++]= id; // & 0xFF;
+      hb[i++]= id >> 8;
+      hb[i++]= t; // & 0xFF;
+      hb[i++]= t >> 8;
+
+      return genMicroFtr(hb,i);
+   } // genRedirHdr
+
 public:
    MFDHeader (void) { ; }
 
@@ -330,7 +344,9 @@ public:
 
 }; // class MFDHeader
 
-#define MAX_BB 32 // KISS
+#ifndef MAX_BB
+#define MAX_BB 40 // KISS, enough for object create with clock & end-of-file redirect
+#endif
 class BBuff
 {
 protected:
@@ -455,16 +471,25 @@ public:
 
    uint8_t crc8FromIdx (const uint8_t i0=0) const
    {
-      CRC8 crc8;
-      uint8_t c= 0xFF;
+      CRCU<8> crc8;
+      const uint8_t c= crc8.computeF(pF+i0, lF+i0, iF-i0);
       // deduct 1 from length of last
-      for (uint8_t i= i0; i<=iF; i++) { c= crc8.compute(pF[i], lF[i]-(i==iF), c); }
-      return(c);
+      return crc8.compute(pF[iF], lF[iF]-(lF[iF] > 0), c);
    } // crc8FromIdx
 
+   // As above, CRC32 variant of token 0xEC (peripheral where available)
+   uint32_t crc32FromIdx (const uint8_t i0=0) const
+   {
+      CRCU<32> crc32;
+      const uint32_t c= crc32.computeF(pF+i0, lF+i0, iF-i0);
+      return crc32.compute(pF[iF], lF[iF]-(lF[iF] > 0), c);
+   } // crc32FromIdx
+
    uint8_t count (void) const { return(iF + nonEmpty(iF)); }
 
-   int commit (UU32 addr, CW25QUtil& dev) const
+   // Any device providing dataWriteFrags() (e.g. CW25QUtil, CW25QWear)
+   template <class Dev>
+   int commit (UU32 addr, Dev& dev) const
    {
       return dev.dataWriteFrags(addr, pF, lF, count());
 /*    FragPos pos;
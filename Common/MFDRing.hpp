@@ -0,0 +1,276 @@
+// Duino/Common/MFDRing.hpp - Circular log (ring) storage mode for CFC
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef MFD_RING_HPP
+#define MFD_RING_HPP
+
+#include "MFDFS.hpp"
+
+// A region of 4K sectors dedicated to a single log. Each sector is one chunk,
+// whose object header ID carries a (wrapping) sector sequence number:
+//    [HdrJ:seq] [HdrR:Fa->Fb] [HdrD:Fn][data] [HdrD:Fn+1][data] ...
+// Appends always go to the head sector. On moving to a new head, the sector
+// after it is reclaimed: the new head records a redirect from the first
+// fragment of the victim (Fa) to the first fragment of the new tail (Fb), then
+// the victim erase is issued without waiting. The sector after the head is thus
+// always erased (or erasing). While that erase is in flight, appends suspend it
+// for their page program, so append cost is one page program plus suspend &
+// resume, independent of log age. Only an append that fills the head sector
+// before the erase is complete must wait for it. Mount examines sector headers
+// only, and the redirect makes an interrupted reclaim harmless.
+// Fragment IDs wrap (skipping 0, reserved for the object descriptor).
+
+namespace CFC
+{
+   const uint16_t RING_SECTOR_BYTES= 0x1000;
+}; // namespace CFC
+
+class MFDRing : public MFDRec
+{
+protected:
+   uint16_t bS, nS;     // region: base sector & count (at least 3)
+   uint16_t hS, tS;     // head & tail sector offsets
+   uint16_t seq;        // sequence of head sector
+   uint16_t nF, tF;     // next fragment ID & first live (tail) fragment ID
+   uint32_t wA;         // append address in head sector, 0 -> empty ring
+   uint32_t tR;         // time of last erase resume (us)
+   bool eR;             // reclaim erase (possibly) in flight
+
+   // Sector header summary
+   struct Sec
+   {
+      uint16_t seq, f0;       // sequence & first fragment ID
+      uint16_t ra, rb;        // redirect (rb==0 -> none)
+      uint32_t a;             // first fragment record
+      bool valid;
+   }; // struct Sec
+
+   uint16_t wrap (const uint16_t o) const { if (o >= nS) { return(o - nS); } return(o); }
+   uint16_t dist (const uint16_t a, const uint16_t b) const { return wrap(b + nS - a); } // a -> b
+   static uint16_t nextID (const uint16_t id) { return(id + 1 + (0xFFFF == id)); }
+
+   uint32_t secAddr (const uint16_t o) const { return((uint32_t)(bS + o) << 12); }
+   uint32_t secEnd (const uint16_t o) const { return(secAddr(o) + CFC::RING_SECTOR_BYTES); }
+
+   bool getSec (Sec& s, const uint16_t o)
+   {
+      CFC::Rec r;
+      uint32_t a= secAddr(o), n;
+
+      s.valid= false; s.rb= 0;
+      n= getRec(r, a);
+      if ((0 == n) || (CFC::OBJ != r.t) || !r.live) { return(false); }
+      s.seq= r.id;
+      a+= n;
+      n= getRec(r, a);
+      if ((n > 0) && (CFC::REDIR == r.t) && r.live)
+      {
+         s.ra= r.id; s.rb= r.v;
+         a+= n;
+         n= getRec(r, a);
+      }
+      if ((0 == n) || (CFC::FRAG != r.t)) { return(false); }
+      s.f0= r.id;
+      s.a= a;
+      s.valid= true;
+      return(true);
+   } // getSec
+
+   // Pause reclaim erase in flight (not on the head sector) for program,
+   // returns true if suspended.
+   bool suspend (void)
+   {
+      if (!eR) { return(false); }
+      const uint32_t dt= micros() - tR;
+      if (dt < W25Q::SUSPEND_INTERVAL_US) { delayMicroseconds(W25Q::SUSPEND_INTERVAL_US - dt); }
+      eR= dev.opSuspend(); // false -> erase already complete
+      nSuspend+= eR;
+      return(eR);
+   } // suspend
+
+   void resume (void) { dev.opResume(); tR= micros(); }
+
+   // Open next sector for append (erase completed), claiming its headers in fa
+   // and choosing the victim. Returns victim sector offset, or nS for none.
+   uint16_t advance (FragAsm& fa)
+   {
+      uint16_t v= nS;
+      if (eR) { dev.sync(); eR= false; nWait++; } // head caught up with reclaim
+      if (wA > 0) { hS= wrap(hS + 1); seq++; }
+      wA= secAddr(hS);
+      genObjHdr(fa.claim(CFC::HDR_J), seq, encodeRV(CFC::RING_SECTOR_BYTES));
+      const uint16_t o= wrap(hS + 1);
+      if ((o == tS) && (o != hS))
+      {  // full: reclaim tail
+         Sec s;
+         const uint16_t t= wrap(o + 1);
+         if (getSec(s, t))
+         {
+            genRedirHdr(fa.claim(CFC::HDR_R), tF, s.f0);
+            tF= s.f0;
+         }
+         tS= t;
+         v= o;
+         nReclaim++;
+      }
+      return(v);
+   } // advance
+
+public:
+   uint32_t nReclaim, nLost; // sectors reclaimed, read cursors overtaken
+   uint32_t nSuspend, nWait; // appends suspending reclaim erase & waiting on it
+
+   // Read position, must be reset by rewind() after mount()
+   struct Cursor
+   {
+      uint32_t a, hA;   // next record, payload of current fragment
+      uint16_t s, l, o; // sector, payload length & offset within
+   }; // struct Cursor
+
+   MFDRing (MFDDev& d) : MFDRec(d) { setRegion(0,0); }
+
+   void setRegion (const uint16_t baseS, const uint16_t numS)
+   {
+      bS= baseS; nS= numS;
+      hS= tS= seq= 0;
+      nF= tF= 1;
+      wA= 0; tR= 0; eR= false;
+      nReclaim= nLost= nSuspend= nWait= 0;
+   } // setRegion
+
+   uint16_t sectors (void) const { return(nS); }
+   uint16_t used (void) const { if (wA > 0) { return(dist(tS, hS) + 1); } return(0); }
+   uint16_t firstID (void) const { return(tF); }
+   uint16_t nextFragID (void) const { return(nF); }
+
+   void format (void)
+   {
+      dev.dataErase(bS << 4, nS << 4);
+      dev.sync();
+      setRegion(bS, nS);
+   } // format
+
+   // Recover head & tail from sector headers, returns sectors in use
+   uint16_t mount (void)
+   {
+      Sec s, n;
+      CFC::Rec r;
+      uint16_t o;
+
+      setRegion(bS, nS);
+      dev.sync();
+      if (nS < 3) { return(0); }
+      // head: valid sector not followed by its successor
+      getSec(n, 0);
+      for (o= 0; o < nS; o++)
+      {
+         s= n;
+         getSec(n, wrap(o + 1));
+         if (s.valid && !(n.valid && (n.seq == (uint16_t)(s.seq + 1)))) { break; }
+      }
+      if (o >= nS) { return(0); } // empty
+      hS= tS= o; seq= s.seq;
+      const uint16_t rb= s.rb;
+      uint32_t a= s.a, m;
+      tF= s.f0;
+      // tail: walk back over contiguous sequence
+      for (uint16_t i= 1; i < nS; i++)
+      {
+         const uint16_t p= wrap(hS + nS - i);
+         if (!getSec(n, p) || (n.seq != (uint16_t)(s.seq - 1))) { break; }
+         s= n;
+         tS= p; tF= s.f0;
+      }
+      // discard (partly erased) sectors preceding latest redirect target
+      while ((rb > 0) && (tS != hS) && (tF != rb) && getSec(n, wrap(tS + 1)))
+      {
+         tS= wrap(tS + 1); tF= n.f0;
+      }
+      // append position & next ID from records of head sector
+      while ((a < secEnd(hS)) && ((m= getRec(r, a)) > 0))
+      {
+         if (CFC::FRAG == r.t) { nF= nextID(r.id); }
+         a+= m;
+      }
+      wA= a;
+      return(used());
+   } // mount
+
+   // Append data as one or more fragments, returns bytes written
+   int append (const uint8_t b[], int n)
+   {
+      FragAsm fa;
+      int t= 0;
+      if (nS < 3) { return(0); }
+      while (n > 0)
+      {
+         uint16_t v= nS;
+         fa.reset();
+         if ((0 == wA) || ((int)(secEnd(hS) - wA) < (CFC::HDR_D + CFC_FRAG_MIN))) { v= advance(fa); }
+         const int room= (secEnd(hS) - wA) - fa.sumFragBytesFI() - CFC::HDR_D;
+         const int m= min(min(n, room), CFC_FRAG_MAX);
+         genFragHdr(fa.claim(CFC::HDR_D), nF, m);
+         for (int i= 0; i < m; i+= 255) { fa.append(b+i, min(255, m-i)); }
+
+         const int w= fa.sumFragBytesFI();
+         UU32 a={wA};
+         const bool s= suspend();
+         const int r= fa.commit(a, dev);
+         if (s) { resume(); }
+         if (r != w) { break; }
+         if (v < nS)
+         {  // reclaim: erase proceeds while the application continues
+            dev.dataErase((bS + v) << 4, 16);
+            eR= true; tR= micros();
+         }
+         wA+= w;
+         nF= nextID(nF);
+         b+= m; n-= m; t+= m;
+      }
+      return(t);
+   } // append
+
+   void rewind (Cursor& c) const
+   {
+      c.s= tS; c.a= secAddr(tS); c.hA= 0; c.l= c.o= 0;
+   } // rewind
+
+   // Sequential read from tail to head. A cursor overtaken by reclaim resumes at the tail.
+   int read (Cursor& c, uint8_t b[], int n)
+   {
+      CFC::Rec r;
+      int t= 0;
+      dev.sync();
+      if (0 == wA) { return(0); }
+      if (dist(tS, c.s) > dist(tS, hS)) { rewind(c); nLost++; }
+      while (n > 0)
+      {
+         if (c.o >= c.l)
+         {
+            uint32_t m= 0;
+            if ((c.s == hS) && (c.a >= wA)) { break; }
+            if (c.a < secEnd(c.s)) { m= getRec(r, c.a); }
+            if (0 == m)
+            {
+               if (c.s == hS) { break; }
+               c.s= wrap(c.s + 1); c.a= secAddr(c.s);
+               continue;
+            }
+            if ((CFC::FRAG == r.t) && r.live) { c.hA= r.a + CFC::HDR_D; c.l= r.v; c.o= 0; }
+            c.a+= m;
+            continue;
+         }
+         const int m= min(n, (int)(c.l - c.o));
+         UU32 a={c.hA + c.o};
+         dev.dataRead(b, m, a);
+         c.o+= m;
+         b+= m; n-= m; t+= m;
+      }
+      return(t);
+   } // read
+
+}; // MFDRing
+
+#endif // MFD_RING_HPP
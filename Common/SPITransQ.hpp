@@ -0,0 +1,258 @@
+// Duino/Common/SPITransQ.hpp - Asynchronous SPI transaction queue
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef SPI_TRANSQ_HPP
+#define SPI_TRANSQ_HPP
+
+#include "CCommonSPI.hpp"
+
+// Drivers describe each chip-select framed transaction with a descriptor
+// (select pin, command bytes, data TX/RX buffers, completion callback) and
+// submit it. A scheduler runs the queued descriptors back to back, toggling
+// chip select between them, so that (with a DMA engine) the CPU is free while
+// e.g. a flash page burst is in flight. Descriptors (and buffers) are owned by
+// the caller and must persist until completion. The scheduler is agnostic of
+// the transfer engine: an engine starts one phase (command or data) and either
+// completes it synchronously or calls event() later from its ISR.
+// Queued paths exist for CW25Q (dataReadAS) and CADS1256SPI (continuous mode
+// reads, register writes); other drivers (CMAX72SPI, CAPA102SPI, CMifareSPI)
+// remain blocking. DMAEngine requires libmaple (STM32F1, SPI_BLOCK_DMA): on other
+// cores, STM32F4 included, SyncEngine runs the queue but each phase blocks.
+
+namespace SPIQ {
+
+enum State : int8_t { FREE, QUEUED, ACTIVE, DONE };
+enum Phase : uint8_t { IDLE, CMD, DATA };
+
+#define SPIQ_CMD_MAX 6 // command, 24/32bit address, dummy/mode byte
+
+struct Trans;
+typedef void (*DoneFunc) (Trans&);
+
+struct Trans
+{
+   const SPISettings *pS;
+   const uint8_t *pT;   // data TX, NULL -> send fill byte
+   uint8_t *pR;         // data RX, NULL -> discard
+   uint16_t nD;
+   uint8_t cb[SPIQ_CMD_MAX], nC;
+   uint8_t pin, fill;
+   volatile int8_t state;
+   DoneFunc done;
+   void *ctx;           // for use by callback
+
+   Trans (void) : pS{NULL}, pT{NULL}, pR{NULL}, nD{0}, nC{0}, pin{PIN_NCS}, fill{0xFF}, state{FREE}, done{NULL}, ctx{NULL} { ; }
+
+   // Command bytes are copied, data buffers are referenced
+   bool cmd (const uint8_t c[], const uint8_t n)
+   {
+      if (n > SPIQ_CMD_MAX) { return(false); }
+      memcpy(cb, c, n); nC= n;
+      return(true);
+   } // cmd
+
+   // Convenience for command followed by big endian address
+   void cmdAddr (const uint8_t c, const uint32_t a, const uint8_t nA=3, const uint8_t nDummy=0)
+   {
+      uint8_t i= 0;
+      cb[i++]= c;
+      for (int8_t s= (nA-1) * 8; s >= 0; s-= 8) { cb[i++]= a >> s; }
+      for (uint8_t j=0; (j < nDummy) && (i < SPIQ_CMD_MAX); j++) { cb[i++]= 0x00; }
+      nC= i;
+   } // cmdAddr
+
+   void data (const uint8_t t[], uint8_t r[], const uint16_t n, const uint8_t f=0xFF) { pT= t; pR= r; nD= n; fill= f; }
+
+   bool busy (void) const { return((QUEUED == state) || (ACTIVE == state)); }
+}; // struct Trans
+
+#ifndef SPIQ_MAX
+#define SPIQ_MAX 8 // power of 2
+#endif
+
+// Single producer (main loop) single consumer (engine/ISR) ring of descriptor pointers
+class Ring
+{
+protected:
+   Trans *q[SPIQ_MAX];
+   volatile uint8_t iW, iR;
+
+   bool push (Trans *p)
+   {
+      if (count() >= SPIQ_MAX) { return(false); }
+      q[iW & (SPIQ_MAX-1)]= p;
+      iW++;
+      return(true);
+   } // push
+
+   Trans *front (void) const { if (count() > 0) { return q[iR & (SPIQ_MAX-1)]; } return(NULL); }
+
+   void pop (void) { if (count() > 0) { iR++; } }
+
+public:
+   Ring (void) : iW{0}, iR{0} { ; }
+
+   uint8_t count (void) const { return(iW - iR); }
+}; // class Ring
+
+class Sched : public Ring
+{
+protected:
+   Trans *pA;           // active
+   volatile uint8_t phase;
+
+   // Engine hooks: start transfer of n bytes, return true if already complete.
+   virtual bool xfer (const uint8_t *pT, uint8_t *pR, const uint16_t n, const uint8_t fill) = 0;
+   // Wait for last bits to clear the shift register (where TX completion is early)
+   virtual void flush (void) { ; }
+
+   void open (Trans& t)
+   {
+      t.state= ACTIVE;
+      if (t.pS) { HSPI.beginTransaction(*(t.pS)); }
+      digitalWrite(t.pin, 0);
+   } // open
+
+   void close (Trans& t)
+   {
+      flush();
+      digitalWrite(t.pin, 1);
+      if (t.pS) { HSPI.endTransaction(); }
+      t.state= DONE;
+   } // close
+
+   // Advance through phases until one is pending or the queue is empty
+   void run (void)
+   {
+      bool sync;
+      do
+      {
+         sync= false;
+         switch(phase)
+         {
+            case IDLE :
+               pA= front();
+               if (NULL == pA) { return; }
+               open(*pA);
+               phase= CMD;
+               if (pA->nC > 0) { sync= xfer(pA->cb, NULL, pA->nC, 0); break; }
+               // fall through
+            case CMD :
+               phase= DATA;
+               if (pA->nD > 0) { sync= xfer(pA->pT, pA->pR, pA->nD, pA->fill); break; }
+               // fall through
+            case DATA :
+            {
+               Trans *p= pA;
+               close(*p);
+               pA= NULL;
+               pop();
+               phase= IDLE;
+               nDone++;
+               if (p->done) { p->done(*p); } // may submit (and start) another
+               sync= (IDLE == phase);
+               break;
+            }
+         }
+      } while (sync);
+   } // run
+
+public:
+   uint32_t nDone;
+
+   Sched (void) : pA{NULL}, phase{IDLE}, nDone{0} { ; }
+
+   bool submit (Trans& t)
+   {
+      bool r, kick;
+      noInterrupts();
+      t.state= QUEUED;
+      r= push(&t);
+      if (!r) { t.state= FREE; }
+      kick= r && (IDLE == phase); // NB: engine idle so no ISR pending
+      interrupts();
+      if (kick) { run(); }
+      return(r);
+   } // submit
+
+   // Engine completion of current phase (ISR context)
+   void event (void) { if (IDLE != phase) { run(); } }
+
+   bool idle (void) const { return(IDLE == phase); }
+
+}; // class Sched
+
+// Blocking engine for any core: each phase completes within xfer()
+class SyncEngine : public Sched, protected CCommonSPI
+{
+protected:
+   bool xfer (const uint8_t *pT, uint8_t *pR, const uint16_t n, const uint8_t fill)
+   {
+      if (pR)
+      {
+         if (pT) { memcpy(pR, pT, n); xferBlock(pR, n); }
+         else { read(pR, n, fill); }
+      }
+      else if (pT) { write(pT, n); }
+      else { writeb(fill, n); }
+      return(true);
+   } // xfer
+
+public:
+   SyncEngine (void) { ; }
+
+   void begin (void) { HSPI.begin(); }
+}; // class SyncEngine
+
+#ifdef SPI_BLOCK_DMA
+// libmaple (STM32F1) DMA engine: setting a completion callback makes the core's
+// dmaTransferRepeat() / dmaSendRepeat() non-blocking.
+void spiqDMAHook (void);
+
+class DMAEngine : public Sched
+{
+protected:
+   bool xfer (const uint8_t *pT, uint8_t *pR, const uint16_t n, const uint8_t fill)
+   {
+      if (pR)
+      {
+         if (pT) { memcpy(pR, pT, n); }
+         else { memset(pR, fill, n); }
+         HSPI.dmaTransferSet(pR, pR); // TX leads RX so in-place is safe
+         HSPI.dmaTransferRepeat(n);
+      }
+      else
+      {
+         fb= fill;
+         if (pT) { HSPI.dmaSendSet((void*)pT, 1); } else { HSPI.dmaSendSet(&fb, 0); } // NB: libmaple only reads (non-const param)
+         HSPI.dmaSendRepeat(n);
+      }
+      return(false);
+   } // xfer
+
+   void flush (void) { while (spi_is_busy(HSPI.dev())); }
+
+   uint8_t fb;
+
+public:
+   DMAEngine (void) { ; }
+
+   void begin (void)
+   {
+      HSPI.begin();
+      HSPI.onReceive(spiqDMAHook);
+      HSPI.onTransmit(spiqDMAHook);
+   } // begin
+}; // class DMAEngine
+#endif // SPI_BLOCK_DMA
+
+}; // namespace SPIQ
+
+#ifdef SPI_BLOCK_DMA
+SPIQ::DMAEngine gSPIQ;
+void SPIQ::spiqDMAHook (void) { gSPIQ.event(); }
+#endif // SPI_BLOCK_DMA
+
+#endif // SPI_TRANSQ_HPP
@@ -10,10 +10,10 @@
 
 // Reset & Clock Control doodahs (temporarily dumped here)
 
-#ifdef ARDUUINO_ARCH_STM32F4
+#ifdef ARDUINO_ARCH_STM32F4
 #define ST_CORE_CLOCK  84000000  // STM32F401
 #endif
-#ifdef ARDUUINO_ARCH_STM32F1
+#ifdef ARDUINO_ARCH_STM32F1
 #define ST_CORE_CLOCK  72000000  // STM32F103
 #endif
 
@@ -100,10 +100,10 @@ public:
 
    void power (uint8_t state=1)
    {
-      #ifdef ARDUUINO_ARCH_STM32F4 // F4x1
+      #ifdef ARDUINO_ARCH_STM32F4 // F4x1
       *CMX::bbp((void*)&(RCC_BASE->AHB1ENR), 12)= state;
       #endif
-      #ifdef ARDUUINO_ARCH_STM32F1
+      #ifdef ARDUINO_ARCH_STM32F1
       *CMX::bbp((void*)&(RCC_BASE->AHBENR), 6)= state;
       #endif
    } // power
@@ -6,15 +6,57 @@
 #ifndef SWCRC_HPP
 #define SWCRC_HPP
 
+#include "TabGen.hpp"
+
+// Table size per CRC (compile time): 1 -> byte (CRC8) & nybble (CRC4/16/32)
+// tables, 4 or 8 -> slice-by-N, N tables of 256 entries (CRC8: 1K/2K, CRC16:
+// 2K/4K, CRC32: 4K/8K). All are generated at compile time into PROGMEM (flash).
+// Lengths are 32bit and each compute() continues from the result of the previous
+// (fragment lists).
+#ifndef SWCRC_SLICE
+#if defined(ARDUINO_ARCH_AVR)
+#define SWCRC_SLICE 1
+#elif defined(ARDUINO_ARCH_STM32F1)
+#define SWCRC_SLICE 4
+#else
+#define SWCRC_SLICE 8
+#endif
+#endif
+
+namespace SWCRC
+{
+   template <bool> struct Sel { }; // overload selection (slice tables or not)
+
+   inline uint8_t rd (const uint8_t *p) { return pgm_read_byte(p); }
+   inline uint16_t rd (const uint16_t *p) { return pgm_read_word(p); }
+   inline uint32_t rd (const uint32_t *p) { return pgm_read_dword(p); }
+
+   // Table set of CRC generator G: slices (256 entries each) or nybbles
+   template <class G, typename W, uint8_t N>
+   struct Tab : public TabGen::CRCTab< G, W, TabGen::CRC_SLICE, typename TabGen::Pow2Seq<N*256>::T > { };
+   template <class G, typename W>
+   struct Nyb : public TabGen::CRCTab< G, W, TabGen::CRC_NYBBLE, typename TabGen::Pow2Seq<16>::T > { };
+}; // namespace SWCRC
 
 /***/
 
+// Polynomial 0x7 (x^4+x^2+x+1), initial 0xF, MSB first
 class CRC4 // (2^4)-1 = 15bits reliably protected
 {
-static const uint8_t kPoly[16]; // inefficient
-
-   // MB: 0xF mask applied AFTER xor : this protects against error where input exceeds 0xF
-   uint8_t compute4bit (const uint8_t c4, const uint8_t i4) const { return kPoly[ (c4 ^ i4) & 0xF ]; }
+typedef TabGen::CRC<uint8_t, 0x7, 4, false> G;
+#if (SWCRC_SLICE > 1)
+typedef SWCRC::Nyb<G, uint8_t> T;
+   uint8_t compute4bit (const uint8_t c4, const uint8_t i4) const { return pgm_read_byte(T::t + ((c4 ^ i4) & 0xF)); }
+#else // pairs packed in 8 bytes
+typedef TabGen::CRCTab< G, uint8_t, TabGen::CRC_PAIR, TabGen::Pow2Seq<8>::T > T;
+   uint8_t compute4bit (const uint8_t c4, const uint8_t i4) const
+   {
+      const uint8_t j= (c4 ^ i4) & 0xF;
+      const uint8_t v= pgm_read_byte(T::t + (j >> 1));
+      return((j & 1) ? (v >> 4) : (v & 0xF));
+   } // compute4bit
+#endif
+   // NB: 0xF mask applied AFTER xor : this protects against error where input exceeds 0xF
 
 public:
    CRC4 (void) { ; }
@@ -31,47 +73,152 @@ public:
    } // compute
 
 }; // class CRC4
-// Polynomial lookup might be compacted 50%
-// NB: 'static' keyword appears only in declaration! 
-const uint8_t CRC4::kPoly[16]= {
-   0x0, 0x7, 0xe, 0x9, 0xb, 0xc, 0x5, 0x2,
-   0x1, 0x6, 0xf, 0x8, 0xa, 0xd, 0x4, 0x3
-}; // class CRC4
 
-class CRC8 // (2^8)-1 = 255 bits reliably protected
+// Polynomial 0x31, initial 0xFF, MSB first (as Sensirion)
+template <uint8_t N=SWCRC_SLICE>
+class CRC8T // (2^8)-1 = 255 bits reliably protected
+{
+protected:
+   static_assert((1 == N) || (4 == N) || (8 == N), "CRC8T: slice-by-N requires N of 1, 4 or 8");
+typedef SWCRC::Tab< TabGen::CRC<uint8_t, 0x31, 8, false>, uint8_t, N > T; // N == 1 -> byte table
+
+   uint8_t compute8bit (const uint8_t c8, const uint8_t i8) const { return pgm_read_byte(T::t + (uint8_t)(c8 ^ i8)); }
+
+   // Whole slices, leaving remainder
+   uint8_t slices (const uint8_t *&, uint32_t&, const uint8_t c, SWCRC::Sel<false>) const { return(c); }
+   uint8_t slices (const uint8_t *& b, uint32_t& n, uint8_t c, SWCRC::Sel<true>) const
+   {
+      for (; n >= N; n-= N, b+= N)
+      {
+         uint8_t r= SWCRC::rd(T::t + ((N-1) << 8) + (uint8_t)(c ^ b[0]));
+         for (uint8_t k= 1; k < N; k++) { r^= SWCRC::rd(T::t + ((N-1-k) << 8) + b[k]); }
+         c= r;
+      }
+      return(c);
+   } // slices
+
+public:
+   CRC8T (void) { ; }
+
+   uint8_t compute (const uint8_t b[], uint32_t n, uint8_t c= 0xFF) const
+   {
+      c= slices(b, n, c, SWCRC::Sel<(N > 1)>());
+      while (n-- > 0) { c= compute8bit(c, *b++); }
+      return(c);
+   } // compute
+
+   // Continue over fragment list
+   uint8_t computeF (const uint8_t * const pF[], const uint8_t lF[], const uint8_t nF, uint8_t c= 0xFF) const
+   {
+      for (uint8_t i= 0; i < nF; i++) { c= compute(pF[i], lF[i], c); }
+      return(c);
+   } // computeF
+
+}; // class CRC8T
+typedef CRC8T<> CRC8;
+
+// CCITT polynomial 0x1021, initial 0xFFFF, MSB first (CCITT-FALSE)
+template <uint8_t N=SWCRC_SLICE>
+class CRC16T
 {
-static const uint8_t kPoly[256];
+protected:
+   static_assert((1 == N) || (4 == N) || (8 == N), "CRC16T: slice-by-N requires N of 1, 4 or 8");
+typedef TabGen::CRC<uint16_t, 0x1021, 16, false> G;
+typedef SWCRC::Tab<G, uint16_t, N> T;
+typedef SWCRC::Nyb<G, uint16_t> T4;
 
-   // MB: 0xF mask applied AFTER xor : this protects against error where input exceeds 0xF
-   uint8_t compute8bit (const uint8_t c8, const uint8_t i8) const { return kPoly[ (c8 ^ i8) ]; }
+   uint16_t compute4bit (const uint16_t c, const uint8_t i4) const { return((c << 4) ^ pgm_read_word(T4::t + ((c >> 12) ^ i4))); }
+
+   uint16_t slices (const uint8_t *&, uint32_t&, const uint16_t c, SWCRC::Sel<false>) const { return(c); }
+   uint16_t slices (const uint8_t *& b, uint32_t& n, uint16_t c, SWCRC::Sel<true>) const
+   {
+      for (; n >= N; n-= N, b+= N)
+      {
+         uint16_t r= SWCRC::rd(T::t + ((N-1) << 8) + (uint8_t)((c >> 8) ^ b[0])) ^ SWCRC::rd(T::t + ((N-2) << 8) + (uint8_t)(c ^ b[1]));
+         for (uint8_t k= 2; k < N; k++) { r^= SWCRC::rd(T::t + ((N-1-k) << 8) + b[k]); }
+         c= r;
+      }
+      for (; n > 0; n--) { c= (c << 8) ^ SWCRC::rd(T::t + (uint8_t)((c >> 8) ^ *b++)); }
+      return(c);
+   } // slices
 
 public:
-   CRC8 (void) { ; }
+   CRC16T (void) { ; }
 
-   uint8_t compute (const uint8_t b[], const int8_t n, uint8_t c= 0xFF) const
+   uint16_t compute (const uint8_t b[], uint32_t n, uint16_t c= 0xFFFF) const
    {
-      for (int8_t i= 0; i<n; i++) { c= compute8bit(c, b[i]); }
+      c= slices(b, n, c, SWCRC::Sel<(N > 1)>());
+      for (; n > 0; n--, b++)
+      {  // nybbles msb first
+         c= compute4bit(c, *b >> 4);
+         c= compute4bit(c, *b & 0xF);
+      }
       return(c);
    } // compute
 
-}; // class CRC8
-const uint8_t PROGMEM CRC8::kPoly[256]= {
-    0x00, 0x31, 0x62, 0x53, 0xc4, 0xf5, 0xa6, 0x97, 0xb9, 0x88, 0xdb, 0xea, 0x7d, 0x4c, 0x1f, 0x2e,
-    0x43, 0x72, 0x21, 0x10, 0x87, 0xb6, 0xe5, 0xd4, 0xfa, 0xcb, 0x98, 0xa9, 0x3e, 0x0f, 0x5c, 0x6d,
-    0x86, 0xb7, 0xe4, 0xd5, 0x42, 0x73, 0x20, 0x11, 0x3f, 0x0e, 0x5d, 0x6c, 0xfb, 0xca, 0x99, 0xa8,
-    0xc5, 0xf4, 0xa7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7c, 0x4d, 0x1e, 0x2f, 0xb8, 0x89, 0xda, 0xeb,
-    0x3d, 0x0c, 0x5f, 0x6e, 0xf9, 0xc8, 0x9b, 0xaa, 0x84, 0xb5, 0xe6, 0xd7, 0x40, 0x71, 0x22, 0x13,
-    0x7e, 0x4f, 0x1c, 0x2d, 0xba, 0x8b, 0xd8, 0xe9, 0xc7, 0xf6, 0xa5, 0x94, 0x03, 0x32, 0x61, 0x50,
-    0xbb, 0x8a, 0xd9, 0xe8, 0x7f, 0x4e, 0x1d, 0x2c, 0x02, 0x33, 0x60, 0x51, 0xc6, 0xf7, 0xa4, 0x95,
-    0xf8, 0xc9, 0x9a, 0xab, 0x3c, 0x0d, 0x5e, 0x6f, 0x41, 0x70, 0x23, 0x12, 0x85, 0xb4, 0xe7, 0xd6,
-    0x7a, 0x4b, 0x18, 0x29, 0xbe, 0x8f, 0xdc, 0xed, 0xc3, 0xf2, 0xa1, 0x90, 0x07, 0x36, 0x65, 0x54,
-    0x39, 0x08, 0x5b, 0x6a, 0xfd, 0xcc, 0x9f, 0xae, 0x80, 0xb1, 0xe2, 0xd3, 0x44, 0x75, 0x26, 0x17,
-    0xfc, 0xcd, 0x9e, 0xaf, 0x38, 0x09, 0x5a, 0x6b, 0x45, 0x74, 0x27, 0x16, 0x81, 0xb0, 0xe3, 0xd2,
-    0xbf, 0x8e, 0xdd, 0xec, 0x7b, 0x4a, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xc2, 0xf3, 0xa0, 0x91,
-    0x47, 0x76, 0x25, 0x14, 0x83, 0xb2, 0xe1, 0xd0, 0xfe, 0xcf, 0x9c, 0xad, 0x3a, 0x0b, 0x58, 0x69,
-    0x04, 0x35, 0x66, 0x57, 0xc0, 0xf1, 0xa2, 0x93, 0xbd, 0x8c, 0xdf, 0xee, 0x79, 0x48, 0x1b, 0x2a,
-    0xc1, 0xf0, 0xa3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1a, 0x2b, 0xbc, 0x8d, 0xde, 0xef,
-    0x82, 0xb3, 0xe0, 0xd1, 0x46, 0x77, 0x24, 0x15, 0x3b, 0x0a, 0x59, 0x68, 0xff, 0xce, 0x9d, 0xac
-}; // CRC8::kPoly[]
+   uint16_t computeF (const uint8_t * const pF[], const uint8_t lF[], const uint8_t nF, uint16_t c= 0xFFFF) const
+   {
+      for (uint8_t i= 0; i < nF; i++) { c= compute(pF[i], lF[i], c); }
+      return(c);
+   } // computeF
+
+}; // class CRC16T
+typedef CRC16T<> CRC16;
+
+// IEEE 802.3 polynomial 0x04C11DB7 reflected, pre & post inverted: as zlib crc32()
+// compute() continues from a previous result (0 initially).
+template <uint8_t N=SWCRC_SLICE>
+class CRC32T
+{
+protected:
+   static_assert((1 == N) || (4 == N) || (8 == N), "CRC32T: slice-by-N requires N of 1, 4 or 8");
+typedef TabGen::CRC<uint32_t, 0xEDB88320, 32, true> G;
+typedef SWCRC::Tab<G, uint32_t, N> T;
+typedef SWCRC::Nyb<G, uint32_t> T4;
+
+   uint32_t compute4bit (const uint32_t c, const uint8_t i4) const { return((c >> 4) ^ pgm_read_dword(T4::t + ((c ^ i4) & 0xF))); }
+
+   uint32_t slices (const uint8_t *&, uint32_t&, const uint32_t c, SWCRC::Sel<false>) const { return(c); }
+   uint32_t slices (const uint8_t *& b, uint32_t& n, uint32_t c, SWCRC::Sel<true>) const
+   {
+      for (; n >= N; n-= N, b+= N)
+      {  // NB: assembled bytewise, no alignment or endian dependency
+         const uint32_t w= c ^ (b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24));
+         uint32_t r= SWCRC::rd(T::t + ((N-1) << 8) + (w & 0xFF)) ^ SWCRC::rd(T::t + ((N-2) << 8) + ((w >> 8) & 0xFF)) ^
+                     SWCRC::rd(T::t + ((N-3) << 8) + ((w >> 16) & 0xFF)) ^ SWCRC::rd(T::t + ((N-4) << 8) + (w >> 24));
+         if (N > 4)
+         {  // second word (N == 8)
+            const uint32_t u= b[4] | ((uint32_t)b[5] << 8) | ((uint32_t)b[6] << 16) | ((uint32_t)b[7] << 24);
+            r^= SWCRC::rd(T::t + (3 << 8) + (u & 0xFF)) ^ SWCRC::rd(T::t + (2 << 8) + ((u >> 8) & 0xFF)) ^
+                SWCRC::rd(T::t + (1 << 8) + ((u >> 16) & 0xFF)) ^ SWCRC::rd(T::t + (u >> 24));
+         }
+         c= r;
+      }
+      for (; n > 0; n--) { c= (c >> 8) ^ SWCRC::rd(T::t + ((c ^ *b++) & 0xFF)); }
+      return(c);
+   } // slices
+
+public:
+   CRC32T (void) { ; }
+
+   uint32_t compute (const uint8_t b[], uint32_t n, uint32_t c= 0) const
+   {
+      c= slices(b, n, ~c, SWCRC::Sel<(N > 1)>());
+      for (; n > 0; n--, b++)
+      {  // nybbles lsb first
+         c= compute4bit(c, *b & 0xF);
+         c= compute4bit(c, *b >> 4);
+      }
+      return(~c);
+   } // compute
+
+   uint32_t computeF (const uint8_t * const pF[], const uint8_t lF[], const uint8_t nF, uint32_t c= 0) const
+   {
+      for (uint8_t i= 0; i < nF; i++) { c= compute(pF[i], lF[i], c); }
+      return(c);
+   } // computeF
+
+}; // class CRC32T
+typedef CRC32T<> CRC32;
 
 #endif // SWCRC_HPP
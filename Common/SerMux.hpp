@@ -24,9 +24,10 @@ public:
       s.write(hdr);
       s.write(b,n);
       //for (int8_t i=0; i<n; i++) { s.write(b[i]); }
+      return(n);
    } // send
   
-   int8_t send (Stream& s, const uint8_t epid, const char txt[]) { send(s, epid, (uint8_t*)txt, lentil(txt)); }
+   int8_t send (Stream& s, const uint8_t epid, const char txt[]) { return send(s, epid, (uint8_t*)txt, lentil(txt)); }
 
    int8_t recv (uint8_t b[], const int8_t nMax, uint8_t& epid, Stream& s)
    {
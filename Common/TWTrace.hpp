@@ -0,0 +1,186 @@
+// Duino/Common/TWTrace.hpp - Compact binary event trace for two wire (I2C) interrupt code
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef TW_TRACE_HPP
+#define TW_TRACE_HPP
+
+#include "SerMux.hpp"
+
+// Each ISR event is recorded in 4 bytes: 16bit time stamp (fast poll timer ticks,
+// rolling over every ~4ms at 16MHz), status (TW_* code in bits 7..3, queue depth
+// in bits 2..0) & state flags. The ring is written by the ISR only, overwriting the
+// oldest records when full, and drained from the main loop without masking
+// interrupts: records overwritten before (or while) being read are counted and
+// reported by a LOST marker. Where >= 4ms elapsed since the previous event a TIME
+// marker (carrying elapsed milliseconds) precedes the record, allowing the decoder
+// to unwrap stamps across bus stalls. Drained records are sent as CSerMux frames
+// of up to 4 records; Decoder reconstructs a text log (e.g. on a host).
+
+#ifndef TWT_MAX
+#define TWT_MAX 16 // records, power of 2 <= 128
+#endif
+#ifndef TWT_TICK_PER_US
+#define TWT_TICK_PER_US 16
+#endif
+
+namespace TWT {
+
+enum Mark : uint8_t { DEPTH_MAX=5, TIME=0xFE, LOST=0xFF }; // NB: markers alias TW_NO_INFO with depth 6,7
+
+struct Rec { uint8_t t[2], code, state; };
+
+class Ring
+{
+protected:
+   Rec r[TWT_MAX];
+   volatile uint8_t iW; // written by ISR only
+   uint8_t iR;
+   uint16_t msLast, lost;
+
+   void put (const uint16_t t, const uint8_t c, const uint8_t s)
+   {
+      Rec& e= r[iW & (TWT_MAX-1)];
+      e.t[0]= t; e.t[1]= t >> 8;
+      e.code= c; e.state= s;
+      iW++;
+   } // put
+
+public:
+   Ring (void) : iW{0}, iR{0}, msLast{0}, lost{0} { ; }
+
+   // ISR context: status & queue depth, state flags
+   void event (const uint16_t t, const uint8_t status, const uint8_t depth, const uint8_t state)
+   {
+      const uint16_t ms= millis();
+      if ((uint16_t)(ms - msLast) >= 4) { put(ms - msLast, TIME, 0); }
+      msLast= ms;
+      put(t, (status & 0xF8) | min(depth, (uint8_t)DEPTH_MAX), state);
+   } // event
+
+   void clear (void) { iR= iW; lost= 0; }
+
+   uint8_t pending (void) const { return min((uint8_t)(iW - iR), (uint8_t)TWT_MAX); }
+
+   // Copy up to n (>= 2) records, preceded by a LOST marker where records were
+   // overwritten. NB: drain at least every 256 events for exact accounting.
+   uint8_t get (Rec d[], const uint8_t n)
+   {
+      uint8_t k= 0, w= iW;
+      if ((uint8_t)(w - iR) > TWT_MAX) { lost+= (uint8_t)(w - iR) - TWT_MAX; iR= w - TWT_MAX; }
+      while ((k < n) && (iR != w))
+      {
+         d[k]= r[iR & (TWT_MAX-1)];
+         w= iW;
+         if ((uint8_t)(w - iR) > TWT_MAX) { lost+= (uint8_t)(w - iR) - TWT_MAX; iR= w - TWT_MAX; continue; } // overwritten during copy
+         iR++;
+         if (lost > 0)
+         {
+            if (k+1 >= n) { iR--; break; } // no room for marker
+            d[k+1]= d[k];
+            d[k].t[0]= lost; d[k].t[1]= lost >> 8;
+            d[k].code= LOST; d[k].state= 0;
+            lost= 0;
+            k++;
+         }
+         k++;
+      }
+      return(k);
+   } // get
+
+   // Send pending records as CSerMux frames, returns records sent
+   uint8_t drain (Stream& s, CSerMux& mux, const uint8_t epid, uint8_t maxFrames=0xFF)
+   {
+      Rec d[4];
+      uint8_t n, nR= 0;
+      while ((maxFrames-- > 0) && ((n= get(d, 4)) > 0))
+      {
+         mux.send(s, epid, (const uint8_t*)d, n * sizeof(Rec));
+         nR+= n;
+      }
+      return(nR);
+   } // drain
+
+}; // class Ring
+
+// Reconstructs absolute time (ticks) & prints records
+class Decoder
+{
+protected:
+   uint32_t t;       // extended stamp of previous record
+   uint16_t t0;      // previous raw stamp
+   uint16_t gapMs;   // from TIME marker
+   bool first;
+
+   uint32_t unwrap (const uint16_t s)
+   {
+      uint32_t dt= (uint16_t)(s - t0);
+      if (gapMs > 0)
+      {  // whole rollovers nearest the elapsed time of the marker
+         const uint32_t g= (uint32_t)gapMs * 1000 * TWT_TICK_PER_US;
+         if (g > dt) { dt+= ((g - dt + 0x8000) >> 16) << 16; }
+         gapMs= 0;
+      }
+      if (first) { dt= 0; first= false; }
+      t0= s; t+= dt;
+      return(t);
+   } // unwrap
+
+public:
+   uint32_t nRec, nLost;
+
+   Decoder (void) : t{0}, t0{0}, gapMs{0}, first{true}, nRec{0}, nLost{0} { ; }
+
+   static const char *name (const uint8_t code)
+   {
+      static const char *n[]=
+      {
+         "BUS_ERR", "START", "REP_START", "MT_SLA_ACK", "MT_SLA_NACK", "MT_DATA_ACK",
+         "MT_DATA_NACK", "ARB_LOST", "MR_SLA_ACK", "MR_SLA_NACK", "MR_DATA_ACK", "MR_DATA_NACK"
+      };
+      const uint8_t i= code >> 3;
+      if (i < (sizeof(n) / sizeof(n[0]))) { return(n[i]); }
+      return("?");
+   } // name
+
+   // Decode one record, false for markers (state updated). Time in ticks.
+   bool decode (const Rec& r, uint32_t& tR)
+   {
+      const uint16_t v= r.t[0] | (r.t[1] << 8);
+      switch(r.code)
+      {
+         case LOST : nLost+= v; first= true; return(false); // time base lost
+         case TIME : gapMs= v; return(false);
+      }
+      tR= unwrap(v);
+      nRec++;
+      return(true);
+   } // decode
+
+   // Decode frame payload of n bytes to text lines, returns records
+   uint8_t print (Stream& s, const uint8_t b[], const uint8_t n)
+   {
+      const Rec *pR= (const Rec*)b;
+      uint8_t k= 0;
+      uint32_t tR;
+      for (uint8_t i= 0; i < (n / sizeof(Rec)); i++)
+      {
+         const Rec& r= pR[i];
+         if (decode(r, tR))
+         {
+            s.print((float)tR / TWT_TICK_PER_US, 2); s.print("us ");
+            s.print(name(r.code)); s.print(" q="); s.print(r.code & 0x7);
+            s.print(" st=0x"); s.println(r.state, HEX);
+            k++;
+         }
+         else if (LOST == r.code) { s.print("lost "); s.println(r.t[0] | (r.t[1] << 8)); }
+      }
+      return(k);
+   } // print
+
+}; // class Decoder
+
+}; // namespace TWT
+
+#endif // TW_TRACE_HPP
@@ -0,0 +1,92 @@
+// Duino/Common/TabGen.hpp - Compile time (constexpr) generation of lookup tables
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#ifndef TAB_GEN_HPP
+#define TAB_GEN_HPP
+
+// Tables are static const members of a class template, defined by expanding an
+// index sequence through a constexpr generator & placed in PROGMEM (read via
+// pgm_read_*() on AVR). Restricted to C++11 constexpr (single expression, by
+// recursion) to suit the AVR toolchain. Table lengths must be powers of 2.
+
+namespace TabGen
+{
+   // Index sequence, doubled per step so that depth of instantiation is log2(N)
+   template <int... I> struct Seq { typedef Seq<I..., (int)(sizeof...(I) + I)...> Dbl; };
+   template <int N> struct Pow2Seq { typedef typename Pow2Seq<N/2>::T::Dbl T; };
+   template <> struct Pow2Seq<1> { typedef Seq<0> T; };
+
+   // CRC register of B bits (B <= bits of W), polynomial P: MSB first or reflected (R)
+   template <typename W, W P, uint8_t B, bool R>
+   struct CRC
+   {
+      static constexpr W kTop= (W)((W)1 << (B-1));
+      static constexpr W kMask= (W)(kTop | (kTop - 1));
+
+      static constexpr W shift (const W r, const int k)
+      {
+         return (k <= 0) ? r : shift(R ? ((r & 1) ? (W)((r >> 1) ^ P) : (W)(r >> 1)) :
+                                   ((r & kTop) ? (W)(((r << 1) ^ P) & kMask) : (W)((r << 1) & kMask)), k-1);
+      } // shift
+
+      // Entry for index i of k bits (4 -> nybble, 8 -> byte table)
+      static constexpr W entry (const uint32_t i, const int k) { return shift(R ? (W)i : (W)(i << (B-k)), k); }
+
+      // Entry followed by s zero bytes (slice s of a slice-by-N table set)
+      static constexpr W extend (const W v, const int s)
+      {
+         return (s <= 0) ? v : extend(R ? (W)((v >> 8) ^ entry(v & 0xFF, 8)) :
+                                    (W)(((v << 8) & kMask) ^ entry(v >> ((B > 8) ? (B-8) : 0), 8)), s-1);
+      } // extend
+
+      // Flat index j: slice j/256, byte j%256
+      static constexpr W slice (const uint32_t j) { return extend(entry(j & 0xFF, 8), j >> 8); }
+
+      // Nybble table packed in pairs (low nybble even index)
+      static constexpr W pair (const uint32_t j) { return (W)(entry(2*j, 4) | (entry(2*j+1, 4) << 4)); }
+   }; // CRC
+
+   enum Form : uint8_t { CRC_SLICE, CRC_NYBBLE, CRC_PAIR };
+
+   template <class G, typename W, Form F, class S> struct CRCTab;
+   template <class G, typename W, Form F, int... I>
+   struct CRCTab<G, W, F, Seq<I...> > { static const W t[sizeof...(I)]; };
+
+   template <class G, typename W, Form F, int... I>
+   const W PROGMEM CRCTab<G, W, F, Seq<I...> >::t[sizeof...(I)]=
+      { ((CRC_SLICE == F) ? G::slice(I) : ((CRC_NYBBLE == F) ? G::entry(I, 4) : G::pair(I)))... };
+
+   // Sine by Taylor series (|x| <= pi/2)
+   constexpr double sinS (const double x2, const double t, const int k, const double s)
+   {
+      return (k > 9) ? s : sinS(x2, -t * x2 / ((2*k + 2) * (2*k + 3)), k+1, s + t);
+   } // sinS
+   constexpr double sinQ (const double x) { return sinS(x*x, x, 0, 0); }
+
+   enum Wave : uint8_t { QUARTER_SINE, QUARTER_TRIANGLE };
+
+   // First quadrant of N samples, zero to amplitude A inclusive (truncated)
+   template <typename T, Wave V, int N, long A>
+   struct Quarter
+   {
+      static constexpr T sample (const int i)
+      {
+         return (QUARTER_SINE == V) ? (T)(A * sinQ(1.5707963267948966 * i / (N-1))) : (T)((A * i) / (N-1));
+      } // sample
+   }; // Quarter
+
+   template <class G, typename T, class S> struct WaveTab;
+   template <class G, typename T, int... I>
+   struct WaveTab<G, T, Seq<I...> > { static const T t[sizeof...(I)]; };
+
+   template <class G, typename T, int... I>
+   const T PROGMEM WaveTab<G, T, Seq<I...> >::t[sizeof...(I)]= { G::sample(I)... };
+
+   template <typename T, Wave V, int N, long A>
+   struct QuarterTab : public WaveTab< Quarter<T,V,N,A>, T, typename Pow2Seq<N>::T > { };
+
+}; // namespace TabGen
+
+#endif // TAB_GEN_HPP
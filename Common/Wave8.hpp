@@ -7,6 +7,7 @@
 #define WAVE8_HPP
 
 #include "MBD/mbdDef.h"
+#include "TabGen.hpp"
 
 //#define PENTATONIC_ROOT 1.1487	// 5th root of 2
 //#define HEPTATONIC_ROOT 1.1041	// 7th root of 2
@@ -42,13 +43,7 @@ static const uint16_t evenTempScale[]=
 static const uint8_t majorSS[]={2,2,1,2,2,2,1,2};
 
 // Quarter sine table: 32 * 4 = 128 sample values generated
-static const int8_t qSinQ7M5[32]=
-{
-	0x00, 0x06, 0x0C, 0x13, 0x19, 0x1F, 0x26, 0x2C,
-	0x32, 0x37, 0x3D, 0x43, 0x48, 0x4D, 0x52, 0x57,
-	0x5C, 0x60, 0x64, 0x68, 0x6B, 0x6F, 0x72, 0x74,
-	0x77, 0x79, 0x7A, 0x7C, 0x7D, 0x7E, 0x7E, 0x7F
-};
+typedef TabGen::QuarterTab<int8_t, TabGen::QUARTER_SINE, 32, 0x7F> QSinQ7M5;
 
 class CMiniLUT8
 {
@@ -66,7 +61,7 @@ public:
 
    int8_t sampleMF (const uint8_t i)
    {
-      int8_t x= qSinQ7M5[ idxM(i) ];
+      int8_t x= pgm_read_byte(QSinQ7M5::t + idxM(i));
       if (i & 0x40) { x= -x; } // flip sign
       return(x);
    }
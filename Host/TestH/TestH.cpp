@@ -0,0 +1,1613 @@
+// Duino/Host/TestH/TestH.cpp - Linux host test & benchmark harness for Common code
+// https://github.com/DrAl-HFS/Duino.git
+// Licence: GPL V3A
+// (c) Project Contributors Oct 2026
+
+#include "Common/Host/HS_Arduino.hpp"
+#include "Common/Host/HS_SPI.hpp"
+#include "Common/Host/HS_Wire.hpp"
+#include "Common/Host/HS_TWM.hpp"
+#include "Common/Host/HS_ADC.hpp"
+#include "Common/Host/HS_I2CDev.hpp"
+#include "Common/Host/HS_OneWire.hpp"
+#include "Common/Host/HS_Bench.hpp"
+#include "Common/Host/HS_Timing.hpp"
+#include "Common/Host/HS_CRC.hpp"
+
+typedef union { uint32_t u32; uint16_t u16[2]; uint8_t u8[4]; } UU32;
+
+#include "Common/DN_Util.hpp"
+#include "Common/CMX_Util.hpp" // bitCount32 (normally via platform util)
+#include "Common/CRC.hpp"
+#include "Common/SerMux.hpp"
+#include "Common/Host/HS_SPIQ.hpp"
+#include "Common/Host/HS_W25Q.hpp"
+#include "Common/CW25QErase.hpp"
+#include "Common/CW25QWear.hpp"
+#define CFC_INDEX_MAX 4096
+#define MFD_DEV CW25QWear // pass-through outside any region set
+#include "Common/MFDFS.hpp"
+#include "Common/MFDRing.hpp"
+#include "Common/MFDGC.hpp"
+#include "Common/AVR/DA_TWMISR.hpp"
+#include "Common/CDS1307.hpp"
+#include "Common/CAT24C.hpp"
+#include "Common/CMAX30102.hpp"
+#include "Common/CDS18.hpp"
+#include "Common/AVR/DA_Analogue.hpp"
+
+
+#define DEBUG Serial
+
+/***/
+
+uint8_t gBuff[1<<17];
+CClock gClock;
+
+void bootMsg (Stream& s)
+{
+  s.println("\n---");
+  s.print("TestH " __DATE__ " ");
+  s.println(__TIME__);
+} // bootMsg
+
+void fillPattern (uint8_t b[], const uint32_t n, uint32_t seed=0x12345678)
+{
+  for (uint32_t i=0; i<n; i++) { seed= seed * 1664525 + 1013904223; b[i]= seed >> 24; }
+} // fillPattern
+
+// Throughput of a CRC class over gBuff, in fragments of up to 255 bytes (as
+// FragAsm) or whole, checking both agree with the reference result r.
+template <class C, typename W>
+bool benchCRC1 (Stream& s, const char *label, const W r)
+{
+  C crc;
+  CHostBench bm;
+  const uint8_t *pF[4];
+  uint8_t lF[4];
+  uint32_t t= 0;
+  W c= crc.compute(gBuff, 0); // initial value
+  W f= c;
+
+  do
+  {  // chained, so not loop invariant
+    c= crc.compute(gBuff, sizeof(gBuff), c);
+    t+= sizeof(gBuff);
+  } while (t < (16<<20));
+  bm.stop(t);
+  bm.report(s,label);
+  s.print(" chain="); s.print(c,HEX);
+  c= crc.compute(gBuff, sizeof(gBuff));
+  for (uint32_t i=0; i < sizeof(gBuff); )
+  {
+    uint8_t n= 0;
+    while ((n < 4) && (i < sizeof(gBuff))) { pF[n]= gBuff+i; lF[n]= min((uint32_t)(255-n), (uint32_t)sizeof(gBuff)-i); i+= lF[n++]; }
+    f= crc.computeF(pF, lF, n, f);
+  }
+  const bool ok= (c == r) && (f == r);
+  s.print(" crc="); s.print(c,HEX); s.println(ok ? " OK" : " FAIL");
+  return(ok);
+} // benchCRC1
+
+// Check values ("123456789") then throughput per table size
+bool benchCRC (Stream& s)
+{
+  const uint8_t *v= (const uint8_t*)"123456789";
+  bool ok= (0xF7 == CRC8T<1>().compute(v,9)) && (0xF7 == CRC8T<8>().compute(v,9)) &&
+            (0x29B1 == CRC16T<1>().compute(v,9)) && (0x29B1 == CRC16T<4>().compute(v,9)) &&
+            (0xCBF43926 == CRC32T<1>().compute(v,9)) && (0xCBF43926 == CRC32T<4>().compute(v,9));
+  s.print("CRC check:"); s.println(ok ? " OK" : " FAIL");
+  if (!ok) { return(ok); }
+  const uint8_t r8= CRC8T<1>().compute(gBuff, sizeof(gBuff));
+  const uint16_t r16= CRC16T<1>().compute(gBuff, sizeof(gBuff));
+  const uint32_t r32= CRC32T<1>().compute(gBuff, sizeof(gBuff));
+  ok&= benchCRC1< CRC8T<1> >(s, "CRC8x1", r8);
+  ok&= benchCRC1< CRC8T<4> >(s, "CRC8x4", r8);
+  ok&= benchCRC1< CRC8T<8> >(s, "CRC8x8", r8);
+  ok&= benchCRC1< CRC16T<1> >(s, "CRC16x1", r16);
+  ok&= benchCRC1< CRC16T<4> >(s, "CRC16x4", r16);
+  ok&= benchCRC1< CRC16T<8> >(s, "CRC16x8", r16);
+  ok&= benchCRC1< CRC32T<1> >(s, "CRC32x1", r32);
+  ok&= benchCRC1< CRC32T<4> >(s, "CRC32x4", r32);
+  ok&= benchCRC1< CRC32T<8> >(s, "CRC32x8", r32);
+  // STM32 peripheral adapter: virtual time is the modelled unit
+  ok&= benchCRC1< CRC32Unit<CHostCRC> >(s, "CRC32 unit", r32);
+  for (uint32_t n= 1; n <= 9; n++)
+  {  // continuation at every alignment
+    uint32_t c= CRC32Unit<CHostCRC>().compute(v, n);
+    ok&= (0xCBF43926 == CRC32Unit<CHostCRC>().compute(v+n, 9-n, c));
+  }
+  s.print("CRC32 unit continuation:"); s.println(ok ? " OK" : " FAIL");
+  return(ok);
+} // benchCRC
+
+bool testSerMux (Stream& s)
+{
+  CMemStream ms(true); // loopback
+  CSerMux mux;
+  uint8_t b[16], epid= 0;
+  int8_t r;
+
+  mux.send(ms, 0x20, gBuff, 12);
+  r= mux.recv(b, sizeof(b), epid, ms);
+  s.print("SerMux: r="); s.print(r); s.print(" ep="); s.print(epid);
+  bool ok= (12 == r) && (2 == epid) && (0 == memcmp(b,gBuff,12));
+  s.println(ok ? " OK" : " FAIL");
+  return(ok);
+} // testSerMux
+
+// Expose per byte & block SPI paths for comparison
+class CBenchSPI : public CCommonSPIX1
+{
+public:
+  CBenchSPI (const uint8_t clkMHz) { spiSet= SPISettings(clkMHz*1000000, MSBFIRST, SPI_MODE0); }
+
+  uint32_t run (uint8_t b[], const uint32_t n, const uint8_t path)
+  {
+    CCommonSPI::begin();
+    start();
+    switch(path)
+    {
+      case 0 : readPB(b,n); break;
+      case 1 : read(b,n); break;
+      case 2 : writePB(b,n); break;
+      case 3 : write(b,n); break;
+      case 4 : for (uint32_t i=0; i<n; i+= 4) { readRev(b+i,4); } break;
+    }
+    complete();
+    return(n);
+  } // run
+}; // CBenchSPI
+
+// Per-call overhead modelled as ~40 core clocks @ 84MHz (STM32F4)
+void benchSPI (Stream& s, const uint8_t clkMHz=42, const uint32_t callNs=480)
+{
+static const char *label[]={" readPB"," read"," writePB"," write"," readRev4"};
+  CBenchSPI spi(clkMHz);
+  CHostBench bm;
+
+  SPI.setCallOverheadNs(callNs);
+  s.print("SPI @"); s.print(clkMHz); s.print("MHz call="); s.print(callNs); s.println("ns");
+  for (uint8_t p=0; p<5; p++)
+  {
+    uint32_t t= 0;
+    bm.start();
+    for (int i=0; i<16; i++) { t+= spi.run(gBuff+sizeof(gBuff)-4096, 4096, p); } // scratch, preserve pattern
+    bm.stop(t);
+    bm.report(s, label[p]);
+  }
+  SPI.setCallOverheadNs(0);
+} // benchSPI
+
+// Log throughput sizing: erase, program & read back 64KB at a given SPI clock
+bool benchW25Q (Stream& s, const uint8_t clkMHz)
+{
+  CHostW25Q flash(32);
+  CW25QUtil dev(clkMHz);
+  CHostBench bm;
+  const uint32_t n= 1<<16;
+  UU32 a={0};
+  bool ok;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  s.print("W25Q @"); s.print(clkMHz); s.println("MHz");
+
+  bm.start();
+  dev.dataErase(0, n >> 8);
+  dev.sync();
+  bm.stop(n);
+  bm.report(s," erase");
+
+  bm.start();
+  for (a.u32= 0; a.u32 < n; a.u32+= W25Q::PAGE_BYTES) { dev.dataWrite(gBuff+a.u32, W25Q::PAGE_BYTES, a); }
+  dev.sync();
+  bm.stop(n);
+  bm.report(s," write");
+
+  bm.start();
+  a.u32= 0;
+  dev.dataRead(gBuff+n, n, a);
+  bm.stop(n);
+  bm.report(s," read");
+
+  ok= (0 == memcmp(gBuff, gBuff+n, n));
+  flash.dumpStat(s);
+  s.println(ok ? " verify OK" : " verify FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // benchW25Q
+
+// Read modes: stream a span crossing page, sector & block boundaries in one select,
+// then scan the (erased) remainder of the device as for log recovery at boot.
+bool benchW25QRead (Stream& s, const uint8_t clkMHz)
+{
+static const char *label[]={" std"," fast"," dual"};
+  CHostW25Q flash(32);
+  CW25QUtil dev(clkMHz);
+  CHostBench bm;
+  const uint32_t n= 1<<16, a0= 0xFF00 - 0x11;
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  memcpy(flash.image()+a0, gBuff, n);
+  s.print("W25Q read @"); s.print(clkMHz); s.print("MHz auto="); s.println(label[CW25Q::readModeFor(clkMHz)]+1);
+  for (int8_t m= W25Q::RM_STD; m <= W25Q::RM_DUAL; m++)
+  {
+    UU32 a={a0};
+    uint32_t i;
+    dev.setReadMode((W25Q::ReadMode)m);
+    memset(gBuff+n, 0, n);
+    bm.start();
+    dev.streamOpen(a);
+    for (i= 0; i < n; i+= 0x1000) { dev.streamRead(gBuff+n+i, 0x1000); }
+    dev.streamClose();
+    bm.stop(n);
+    bm.report(s, label[m]);
+    ok&= (0 == memcmp(gBuff, gBuff+n, n));
+
+    a.u32= a0 + n;
+    bm.start();
+    for (i= 0; a.u32 < flash.bytes(); a.u32+= i)
+    {
+      i= dev.dataScan(a, min(1<<16, flash.bytes() - a.u32));
+      if (0 == i) { break; }
+    }
+    bm.stop(a.u32 - (a0 + n));
+    bm.report(s, "  scan");
+    ok&= (a.u32 == flash.bytes());
+  }
+  flash.dumpStat(s);
+  s.println(ok ? " verify OK" : " verify FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // benchW25QRead
+
+// Gather write of irregular fragments from an unaligned address: one program per page spanned
+bool testW25QFrags (Stream& s, const uint8_t clkMHz=42)
+{
+  CHostW25Q flash(32);
+  CW25QUtil dev(clkMHz);
+  CHostBench bm;
+  const uint8_t *pF[24];
+  uint8_t lF[24];
+  uint32_t n= 0, seed= 0x5EED;
+  const UU32 a={0x1234F};
+
+  for (int i=0; i<24; i++)
+  {
+    seed= seed * 1664525 + 1013904223;
+    pF[i]= gBuff + n;
+    lF[i]= 1 + ((seed >> 16) % 255);
+    n+= lF[i];
+  }
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  bm.start();
+  int r= dev.dataWriteFrags(a, pF, lF, 24);
+  dev.sync();
+  bm.stop(r);
+  bm.report(s,"W25Q frags");
+  const uint32_t nP= ((a.u32 + n - 1) >> 8) - (a.u32 >> 8) + 1;
+  bool ok= (r == (int)n) && (0 == memcmp(flash.image()+a.u32, gBuff, n)) && (nP == flash.stat.nProg);
+  flash.dumpStat(s);
+  s.print(" bytes="); s.print(r); s.print('/'); s.print(n); s.print(" pages="); s.print(nP);
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // testW25QFrags
+
+// Logging a page every 4ms into a circular region of 64 sectors (two passes, initially dirty):
+// worst case write latency with synchronous erase at each sector versus pre-erased pool.
+// NB: the pool erases the oldest data ahead of the writer, so pages are checked as written.
+bool benchW25QLog (Stream& s, const bool sched, const uint8_t clkMHz=42)
+{
+  CHostW25Q flash(32);
+  CW25QErase dev(clkMHz);
+  const uint16_t bS= 0x100, nS= 64;
+  const uint32_t period= 4000, nPg= 2 * nS * 16;
+  uint64_t maxNs= 0, sumNs= 0;
+  uint32_t nSvc= 0, nBad= 0, t0= micros();
+  UU32 a={0};
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  dev.setRegion(bS, nS, 32);
+  memset(flash.image() + ((uint32_t)bS << 12), 0x00, (uint32_t)nS << 12);
+  if (sched) { dev.prime(); }
+  for (uint32_t p= 0; p < nPg; p++)
+  {
+    while ((micros() - t0) < (p * period))
+    {
+      if (sched) { dev.service(); nSvc++; }
+      delayMicroseconds(50);
+    }
+    const uint64_t t1= gHostClock.nowNs();
+    if (0 == (p & 0xF))
+    {
+      if (sched) { a= dev.take(); }
+      else
+      {
+        a.u32= (uint32_t)(bS + ((p >> 4) % nS)) << 12;
+        dev.dataErase(a.u32 >> 8, 16);
+      }
+    }
+    if (sched) { dev.dataWriteNow(gBuff + ((p & 0xF) << 8), W25Q::PAGE_BYTES, a); }
+    else { dev.dataWrite(gBuff + ((p & 0xF) << 8), W25Q::PAGE_BYTES, a); }
+    const uint64_t dt= gHostClock.nowNs() - t1;
+    nBad+= (0 != memcmp(flash.image() + a.u32, gBuff + ((p & 0xF) << 8), W25Q::PAGE_BYTES));
+    a.u32+= W25Q::PAGE_BYTES;
+    sumNs+= dt;
+    if (dt > maxNs) { maxNs= dt; }
+  }
+  dev.sync();
+  bool ok= (0 == nBad);
+  s.print(sched ? "W25Q log sched:" : "W25Q log sync:");
+  s.print(" max="); s.print(maxNs * 1E-6, 3); s.print("ms mean="); s.print(sumNs * 1E-6 / nPg, 3); s.print("ms");
+  if (sched)
+  {
+    s.print(" erase="); s.print(dev.nErase); s.print(" blank="); s.print(dev.nBlank);
+    s.print(" stall="); s.print(dev.nStall); s.print(" suspend="); s.print(dev.nSuspend);
+    s.print(" service="); s.print(nSvc);
+  }
+  s.println(ok ? " OK" : " FAIL");
+  flash.dumpStat(s);
+  SPI.detach(&flash);
+  return(ok);
+} // benchW25QLog
+
+// CFC file system: interleaved appends to 4 files on a 1MB volume, then mount,
+// open by name & read back. Remount from a file backed image of the device.
+// Index: cold (scan) & warm (checkpoint) mount, open & seek. File 2 holds gBuff+4096..
+MFDIndex gCFCIdx;
+
+bool testCFCIndex (Stream& s, MFDVol& vol, MFDFile& f, const char *name, const uint32_t nF)
+{
+  CHostBench bm;
+  uint8_t b[64];
+  bool ok= true;
+
+  vol.setIndex(&gCFCIdx);
+  bm.start();
+  uint16_t nC= vol.mount();
+  bm.stop(0);
+  s.print(" index: entries="); s.print(gCFCIdx.n); s.print(" chunks="); s.print(nC);
+  s.print(" cold="); s.print(bm.virtNs * 1E-6, 3); s.print("ms");
+
+  bm.start();
+  ok&= vol.open(f, name) && (f.size == nF);
+  bm.stop(0);
+  s.print(" open="); s.print(bm.virtNs * 1E-3, 1); s.print("us");
+
+  bm.start();
+  for (int32_t p= nF - 1000; p > 1000; p-= 9973)
+  {
+    ok&= vol.seek(f, p) && (sizeof(b) == vol.read(f, b, sizeof(b))) && (0 == memcmp(b, gBuff + 4096 + p, sizeof(b)));
+  }
+  bm.stop(0);
+  s.print(" seek+read x10="); s.print(bm.virtNs * 1E-6, 3); s.println("ms");
+  ok&= !vol.seek(f, nF + 1) && (f.pos == nF);
+
+  bm.start();
+  uint16_t nE= vol.checkpoint();
+  bm.stop(nE * sizeof(CFC::IdxEnt));
+  s.print(" checkpoint="); s.print(bm.virtNs * 1E-6, 3); s.print("ms");
+  gCFCIdx.clear();
+  bm.start();
+  ok&= (vol.mount() == nC) && (gCFCIdx.n == nE);
+  bm.stop(0);
+  s.print(" warm="); s.print(bm.virtNs * 1E-6, 3); s.println("ms");
+
+  // Append invalidates checkpoint: next mount rescans & agrees with RAM index
+  ok&= vol.open(f, name) && ((int)nF == vol.append(f, gBuff + 4096, nF));
+  nE= gCFCIdx.n;
+  ok&= (vol.mount() > nC) && (gCFCIdx.n == nE) && vol.open(f, name) && (f.size == 2 * nF);
+  ok&= vol.seek(f, nF + 7) && (sizeof(b) == vol.read(f, b, sizeof(b))) && (0 == memcmp(b, gBuff + 4096 + 7, sizeof(b)));
+  vol.close(f);
+  vol.setIndex(NULL);
+  return(ok);
+} // testCFCIndex
+
+bool benchCFC (Stream& s, CClock& clk, const uint8_t clkMHz=42)
+{
+static const char *name[]={"log0.dat","log1.dat","log2.dat","log3.dat"};
+  CHostW25Q flash(32);
+  MFDDev dev(clkMHz);
+  MFDVol vol(dev);
+  MFDFile f[4];
+  CHostBench bm;
+  const uint32_t nR= 240, nF= 410 * nR;
+  uint8_t b[512];
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  vol.setVolume(0x1000, 0x1000);
+  vol.format();
+  for (int i=0; i<4; i++) { ok&= vol.create(f[i], name[i], &clk); }
+  bm.start();
+  for (uint32_t o= 0; o < nF; o+= nR)
+  {
+    for (int i=0; i<4; i++) { ok&= (nR == vol.append(f[i], gBuff + i * 4096 + o, nR)); }
+  }
+  dev.sync();
+  bm.stop(4 * nF);
+  bm.report(s,"CFC append");
+  for (int i=0; i<4; i++) { vol.close(f[i]); }
+
+  bm.start();
+  uint16_t nC= vol.mount();
+  bm.stop(0);
+  s.print(" mount: chunks="); s.print(nC); s.print(" head="); s.print(vol.head());
+  s.print(" virt="); s.print(bm.virtNs * 1E-6, 3); s.println("ms");
+
+  bm.start();
+  ok&= vol.open(f[2], name[2]) && (f[2].size == nF);
+  ok&= (1 == vol.read(f[2], b, 1));
+  bm.stop(1);
+  s.print(" open+read1: virt="); s.print(bm.virtNs * 1E-6, 3); s.println("ms");
+
+  for (int i=0; i<4; i++)
+  {
+    uint32_t t= 0;
+    int r;
+    if (i != 2) { ok&= vol.open(f[i], i+1); } else { f[i].rewind(); }
+    bm.start();
+    while ((r= vol.read(f[i], b, sizeof(b))) > 0)
+    {
+      ok&= (0 == memcmp(b, gBuff + i * 4096 + t, r));
+      t+= r;
+    }
+    bm.stop(t);
+    ok&= (t == nF);
+    if (0 == i) { bm.report(s," read"); }
+    vol.close(f[i]);
+  }
+  vol.list(s);
+  ok&= testCFCIndex(s, vol, f[0], name[1], nF);
+  nC= vol.mount();
+
+  const char *path= "/tmp/TestH_cfc.img";
+  if (flash.save(path))
+  {
+    CHostW25Q img(32);
+    SPI.detach(&flash);
+    SPI.attach(&img, PIN_NCS);
+    ok&= img.load(path) && (vol.mount() == nC) && vol.open(f[3], name[3]) && (f[3].size == nF);
+    ok&= (nR == vol.append(f[3], gBuff, nR)) && (f[3].size == (nF + nR));
+    vol.close(f[3]);
+    ok&= vol.open(f[3], 4) && (f[3].size == (nF + nR));
+    s.print(" image: "); s.print(path);
+    SPI.detach(&img);
+    remove(path);
+  }
+  else { SPI.detach(&flash); }
+  s.println(ok ? " OK" : " FAIL");
+  return(ok);
+} // benchCFC
+
+// Content of open file f equals gBuff prefix, returns size (or -1)
+int32_t checkCFC (MFDVol& vol, MFDFile& f)
+{
+  uint8_t b[512];
+  uint32_t t= 0;
+  int r;
+  while ((r= vol.read(f, b, sizeof(b))) > 0)
+  {
+    if (0 != memcmp(b, gBuff + t, r)) { return(-1); }
+    t+= r;
+  }
+  if (t != f.size) { return(-1); }
+  return(t);
+} // checkCFC
+
+// Power fail: for every count of bytes programmed during an append (of two
+// fragments, the second opening a chunk) cut power there, then remount and
+// check that the file holds the old data or a whole fragment prefix of the new,
+// and accepts a further append.
+bool testCFCPowerCut (Stream& s, const uint8_t clkMHz=42)
+{
+  CHostW25Q flash(32);
+  MFDDev dev(clkMHz);
+  MFDVol vol(dev);
+  MFDFile f;
+  CHostBench bm;
+  const uint32_t nV= 0x100 << 8, n0= 3900, nA= 300, nB= 50;
+  uint8_t *pS= (uint8_t*)malloc(nV);
+  uint32_t nP, nFwd= 0, nUndo= 0, nSize[3]={0,0,0};
+  double tMount= 0, tMax= 0, tSum= 0;
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  vol.setVolume(0, 0x100);
+  vol.setJournal();
+  vol.format();
+  ok&= vol.create(f, "pf.dat") && (n0 == (uint32_t)vol.append(f, gBuff, n0));
+  vol.close(f);
+  dev.sync();
+  memcpy(pS, flash.image(), nV);
+
+  const uint64_t p0= flash.stat.progBytes;
+  bm.start();
+  ok&= (vol.mount() > 0);
+  bm.stop(0);
+  tMount= bm.virtNs * 1E-3;
+  ok&= vol.open(f, "pf.dat") && (nA == (uint32_t)vol.append(f, gBuff + n0, nA));
+  dev.sync();
+  nP= flash.stat.progBytes - p0;
+
+  for (uint32_t c= 0; c <= nP; c++)
+  {
+    memcpy(flash.image(), pS, nV);
+    vol.mount();
+    vol.open(f, "pf.dat");
+    flash.setPowerCut(c);
+    vol.append(f, gBuff + n0, nA);
+    dev.sync();
+    flash.powerOn();
+    vol.close(f);
+
+    bm.start();
+    vol.mount();
+    bm.stop(0);
+    const double t= bm.virtNs * 1E-3;
+    if (vol.nFwd + vol.nUndo > 0) { tSum+= t; if (t > tMax) { tMax= t; } }
+    nFwd+= vol.nFwd; nUndo+= vol.nUndo;
+    int32_t z= -1;
+    if (vol.open(f, "pf.dat")) { z= checkCFC(vol, f); }
+    if (n0 == z) { nSize[0]++; } else if ((n0 + nA) == z) { nSize[2]++; } else if (z > (int32_t)n0) { nSize[1]++; }
+    ok&= (z >= (int32_t)n0);
+    if (z >= 0)
+    {
+      ok&= (nB == (uint32_t)vol.append(f, gBuff + z, nB));
+      vol.close(f);
+      ok&= vol.open(f, "pf.dat") && (checkCFC(vol, f) == (int32_t)(z + nB));
+    }
+    if (!ok) { s.print(" fail at cut="); s.println(c); break; }
+  }
+  free(pS);
+  s.print("CFC power cut: points="); s.print(nP+1);
+  s.print(" old/part/new="); s.print(nSize[0]); s.print('/'); s.print(nSize[1]); s.print('/'); s.print(nSize[2]);
+  s.print(" fwd="); s.print(nFwd); s.print(" undo="); s.println(nUndo);
+  s.print(" mount (us) clean="); s.print(tMount, 1);
+  s.print(" recover mean="); s.print(tSum / max(nFwd + nUndo, (uint32_t)1), 1); s.print(" max="); s.print(tMax, 1);
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // testCFCPowerCut
+
+// Garbage collection: 4 logs of 240 byte records, each trimmed to retain 12K,
+// appended far beyond the capacity of a 30 chunk volume. Collection runs in
+// 500us slices between records (one per 4ms, within the bandwidth of sector
+// erase). While a collection erase is in flight, open & seek another log (not
+// delayed by the erase). Then remount & verify the records retained are contiguous
+// to the last.
+bool benchCFCGC (Stream& s, const uint8_t clkMHz=42)
+{
+static const char *name[]={"gc0.log","gc1.log","gc2.log","gc3.log"};
+  CHostW25Q flash(32);
+  MFDDev dev(clkMHz);
+  MFDCompact vol(dev);
+  MFDFile f[4], g;
+  const uint32_t nR= 240, nRec= 2000, keep= 12 * 1024;
+  uint32_t r[nR/4], k[4]={0,0,0,0}, tA= 0, tT= 0, tC= 0, tO= 0, nO= 0, nB= 0;
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  vol.setVolume(0x400, 0x200);
+  vol.setJournal();
+  vol.format();
+  for (int i=0; i<4; i++) { ok&= vol.create(f[i], name[i]); }
+  const uint64_t p0= flash.stat.progBytes;
+  for (uint32_t n= 0; ok && (n < nRec); n++)
+  {
+    const int i= n & 3;
+    for (uint32_t j= 0; j < (nR/4); j++) { r[j]= (i << 24) | k[i]; }
+    uint32_t t0= micros();
+    ok&= (nR == (uint32_t)vol.append(f[i], (uint8_t*)r, nR));
+    tA= max(tA, micros() - t0);
+    k[i]++; nB+= nR;
+    if (f[i].size > (keep + 4096))
+    {
+      t0= micros();
+      vol.trim(f[i], f[i].size - keep);
+      tT= max(tT, micros() - t0);
+    }
+    t0= micros();
+    vol.collect(500);
+    tC= max(tC, micros() - t0);
+    if ((CFC::GC_ERASE == vol.gcPhase()) && (nO < vol.nVictim) && (f[i^1].size > nR))
+    {  // once per collection erase
+      t0= micros();
+      ok&= vol.open(g, name[i^1]) && vol.seek(g, nR);
+      tO= max(tO, micros() - t0);
+      nO++;
+    }
+    delayMicroseconds(4000);
+  }
+  const uint64_t nP= flash.stat.progBytes - p0;
+  s.print("CFC GC: appended="); s.print(nB); s.print(" copied="); s.print(vol.nCopy);
+  s.print(" victims="); s.print(vol.nVictim); s.print(" erased="); s.print(vol.nFree);
+  s.print(" suspend="); s.println(vol.nSuspend);
+  s.print(" WA: gc="); s.print((double)(nB + vol.nCopy) / nB, 3); s.print(" flash="); s.print((double)nP / nB, 3);
+  s.print(" max (us) append="); s.print(tA); s.print(" trim="); s.print(tT); s.print(" collect="); s.print(tC);
+  s.print(" open+seek="); s.print(tO); s.print(" (x"); s.print(nO); s.println(')');
+  ok&= (nO > 0) && (tO < 5000);
+
+  vol.mount();
+  for (int i=0; i<4; i++)
+  {
+    uint32_t m= 0, k0= 0;
+    ok&= vol.open(f[i], name[i]) && (f[i].size >= keep);
+    while (ok && (vol.read(f[i], (uint8_t*)r, nR) == (int)nR))
+    {
+      if (0 == m) { k0= r[0] & 0xFFFFFF; }
+      for (uint32_t j= 0; j < (nR/4); j++) { ok&= (r[j] == ((i << 24) | (k0 + m))); }
+      m++;
+    }
+    ok&= ((k0 + m) == k[i]) && ((m * nR) == f[i].size);
+  }
+  s.print(" remount: chunks="); s.print(vol.objects()); s.print(" free="); s.print(vol.freePages());
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // benchCFCGC
+
+// Collection with an index attached: an indexed open & read of the victim object
+// after every step (fragments span several copy steps), then a trim of the victim
+// mid copy (abandon) must leave the index as rebuilt by a remount.
+bool testCFCGCIndex (Stream& s, const uint8_t clkMHz=42)
+{
+  static const char *name[]={"gcx0.log","gcx1.log"};
+  static const uint32_t nR= 600;
+  CHostW25Q flash(32);
+  MFDDev dev(clkMHz);
+  MFDCompact vol(dev);
+  MFDFile f[2], g;
+  CFC::IdxEnt x[64];
+  uint32_t r[nR/4], k[2]={0,0}, k0= 3, nS= 0, nX= 0;
+  bool ok= true, cut= false;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  vol.setVolume(0x400, 0x200);
+  vol.setIndex(&gCFCIdx, false);
+  vol.setJournal();
+  vol.format();
+  for (int i=0; i<2; i++) { ok&= vol.create(f[i], name[i]); }
+  for (uint32_t n= 0; ok && (n < 24); n++)
+  {
+    const int i= n & 1;
+    for (uint32_t j= 0; j < (nR/4); j++) { r[j]= (i << 24) | k[i]; }
+    ok&= (nR == (uint32_t)vol.append(f[i], (uint8_t*)r, nR));
+    k[i]++;
+  }
+  vol.trim(f[0], 3 * nR); // first chunk of gcx0 becomes victim
+  for (uint32_t n= 0; ok && (n < 400) && !cut; n++)
+  {
+    vol.collect(0); // single step
+    nS++;
+    uint32_t m= 0;
+    ok&= vol.open(g, name[0]);
+    while (ok && (vol.read(g, (uint8_t*)r, nR) == (int)nR))
+    {
+      for (uint32_t j= 0; j < (nR/4); j++) { ok&= (r[j] == (k0 + m)); }
+      m++;
+    }
+    ok&= ((k0 + m) == k[0]);
+    if ((CFC::GC_COPY == vol.gcPhase()) && (vol.nCopy > (CFC::HDR_D + nR + 100)))
+    {  // second fragment partly copied: foreground trim of victim abandons
+      vol.trim(f[0], nR);
+      k0++;
+      cut= true;
+    }
+  }
+  ok&= cut && vol.open(g, name[0]) && (g.size == (k[0] - k0) * nR) && vol.seek(g, nR) && (vol.read(g, (uint8_t*)r, 4) == 4) && (r[0] == k0 + 1);
+  for (uint16_t i= 0; i < gCFCIdx.n; i++) { if ((gCFCIdx.e[i].j == f[0].id) && (nX < 64)) { x[nX++]= gCFCIdx.e[i]; } }
+  vol.mount(); // rebuild
+  uint32_t nM= 0, nY= 0;
+  for (uint16_t i= 0; i < gCFCIdx.n; i++)
+  {
+    const CFC::IdxEnt& y= gCFCIdx.e[i];
+    if (y.j != f[0].id) { continue; }
+    nM+= (nY < nX) && (y.a == x[nY].a) && (y.f == x[nY].f) && (y.n == x[nY].n) && (y.e == x[nY].e);
+    nY++;
+  }
+  ok&= (nX > 0) && (nM == nX) && (nY == nX);
+  s.print("CFC GC index: steps="); s.print(nS); s.print(" copied="); s.print(vol.nCopy); s.print(" entries="); s.print(nX);
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // testCFCGCIndex
+
+// Ring log: 24 byte records every 2ms over several laps of a 16 sector region,
+// append latency per lap must not grow. Then remount & read back from tail.
+bool benchCFCRing (Stream& s, const uint8_t clkMHz=42)
+{
+  CHostW25Q flash(32);
+  MFDDev dev(clkMHz);
+  MFDRing ring(dev);
+  const uint32_t nRec= 2000; // ~1 lap
+  uint32_t k= 0, r[6];
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  ring.setRegion(0x300, 16);
+  ring.format();
+  s.print("CFC ring: max append (us) per lap=");
+  for (int lap= 0; lap < 5; lap++)
+  {
+    uint32_t tMax= 0;
+    for (uint32_t i= 0; i < nRec; i++, k++)
+    {
+      for (int j= 0; j < 6; j++) { r[j]= k; }
+      const uint32_t t0= micros();
+      ok&= (sizeof(r) == ring.append((uint8_t*)r, sizeof(r)));
+      const uint32_t dt= micros() - t0;
+      if (dt > tMax) { tMax= dt; }
+      delayMicroseconds(2000);
+    }
+    s.print(' '); s.print(tMax);
+    ok&= (tMax < 1000); // no wait on reclaim erase
+  }
+  s.print(" reclaim="); s.print(ring.nReclaim); s.print(" suspend="); s.print(ring.nSuspend); s.print(" wait="); s.println(ring.nWait);
+
+  MFDRing ring2(dev);
+  MFDRing::Cursor c;
+  ring2.setRegion(0x300, 16);
+  ok&= (ring2.mount() == ring.used()) && (ring2.firstID() == ring.firstID()) && (ring2.nextFragID() == ring.nextFragID());
+  ring2.rewind(c);
+  uint32_t n= 0, k0= 0;
+  while (ring2.read(c, (uint8_t*)r, sizeof(r)) == sizeof(r))
+  {
+    if (0 == n) { k0= r[0]; }
+    for (int j= 0; j < 6; j++) { ok&= (r[j] == (k0 + n)); }
+    n++;
+  }
+  ok&= ((k0 + n) == k) && (n > (nRec / 2));
+  s.print(" remount: sectors="); s.print(ring2.used()); s.print(" records="); s.print(n); s.print(" from="); s.print(k0);
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // benchCFCRing
+
+// Endurance: rewrite 4 "configuration" sectors (alongside 48 of static data) until
+// data is lost, with & without the wear levelling layer. Sector endurance 100 (+-50%).
+void fillWear (uint8_t b[256], const uint32_t k, const uint8_t p)
+{
+  for (int i= 0; i < 256; i++) { b[i]= k * 7 + p * 13 + i; }
+} // fillWear
+
+bool benchWear (Stream& s, const bool level, const uint8_t clkMHz=42)
+{
+  W25QSim::Timing tm= W25QSim::TYPICAL;
+  tm.tPP= 20; tm.tSE= 200; // timing irrelevant here: reduce status polling
+  CHostW25Q flash(32, tm);
+  CW25QWear dev(clkMHz);
+  uint8_t b[256], t[256];
+  const uint16_t bS= 0x200, nS= 64, nCold= 48;
+  uint32_t n, lo, hi;
+  UU32 a;
+  bool ok= true;
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  flash.setEndurance(100);
+  if (level) { ok&= dev.setRegion(bS, nS, 8); ok&= !dev.mount(); }
+  for (uint16_t l= 4; l < (4 + nCold); l++)
+  {
+    dev.dataErase((bS + l) << 4, 16);
+    for (uint8_t p= 0; p < 16; p++) { fillWear(b, 0xC0 + l, p); a.u32= ((uint32_t)(bS + l) << 12) + (p << 8); dev.dataWrite(b, 256, a); }
+  }
+  dev.clearStat();
+  for (n= 0; n < 40000; n++)
+  {
+    const uint16_t l= n & 3;
+    const uint8_t pc= n % 16;
+    dev.dataErase((bS + l) << 4, 16);
+    for (uint8_t p= 0; p < 16; p++) { fillWear(b, n, p); a.u32= ((uint32_t)(bS + l) << 12) + (p << 8); dev.dataWrite(b, 256, a); }
+    dev.sync();
+    fillWear(b, n, pc);
+    a.u32= ((uint32_t)(bS + l) << 12) + (pc << 8);
+    dev.dataRead(t, 256, a);
+    if ((dev.nFail > 0) || (0 != memcmp(b, t, 256))) { break; }
+  }
+  flash.eraseRange(lo, hi, bS, nS - 2);
+  s.print(level ? "Wear levelled: " : "Wear none: "); s.print("rewrites="); s.print(n);
+  s.print(" erase="); s.print(lo); s.print(".."); s.print(hi);
+  s.print(" WA="); s.print((float)dev.nProgP / max((uint64_t)1, dev.nProgL), 3);
+  s.print(" moves="); s.print(dev.nMove); s.print(" retired="); s.println(dev.nRetire);
+  if (level)
+  {  // journal restores map: static data intact after remount
+    CW25QWear d2(clkMHz);
+    d2.setRegion(bS, nS, 8);
+    ok&= d2.mount() && (n > 2000);
+    for (uint16_t l= 4; l < (4 + nCold); l+= 7)
+    {
+      fillWear(b, 0xC0 + l, l & 0xF);
+      a.u32= ((uint32_t)(bS + l) << 12) + ((l & 0xF) << 8);
+      d2.dataRead(t, 256, a);
+      ok&= (0 == memcmp(b, t, 256));
+    }
+    // logical scan of a remapped sector (old physical sector still programmed)
+    a.u32= (uint32_t)bS << 12;
+    fillWear(b, 0, 0);
+    d2.dataErase(bS << 4, 16);
+    d2.dataWrite(b, 256, a);
+    d2.dataErase(bS << 4, 16);
+    d2.sync();
+    ok&= (W25Q::SECTOR_BYTES == d2.dataScan(a));
+    // bounded status polling: no program while erase in flight
+    const uint8_t *pF[1]= {b}, lF[1]= {64};
+    d2.dataErase((bS + 1) << 4, 16);
+    ok&= (0 == d2.dataWriteFrags(a, pF, lF, 1, 1)) && (64 == d2.dataWriteFrags(a, pF, lF, 1));
+    d2.sync();
+    // power cut in journal rotation (sequence beyond 0x7FFF): the other journal
+    // sector erased, then holding only a header of newer sequence (torn snapshot)
+    uint8_t *j[2]= { flash.image() + ((uint32_t)(bS + nS - 2) << 12), flash.image() + ((uint32_t)(bS + nS - 1) << 12) };
+    Wear::JHdr *h[2]= { (Wear::JHdr*)j[0], (Wear::JHdr*)j[1] };
+    const int k= (0 != memcmp(h[0]->m, "WLJ", 3)) || ((0 == memcmp(h[1]->m, "WLJ", 3)) && ((int16_t)(h[1]->seq - h[0]->seq) > 0));
+    CRC8 crc;
+    h[k]->seq= 0x8123;
+    h[k]->crc= crc.compute(j[k] + 4, 8 + nS * sizeof(uint32_t) + d2.logicalSectors() * sizeof(uint16_t));
+    for (int c= 0; c < 2; c++)
+    {
+      CW25QWear d3(clkMHz);
+      memset(j[k^1], 0xFF, W25Q::SECTOR_BYTES);
+      if (c) { memcpy(j[k^1], j[k], sizeof(Wear::JHdr)); h[k^1]->seq= 0x8124; }
+      d3.setRegion(bS, nS, 8);
+      ok&= d3.mount() && (d3.spares() == d2.spares());
+      for (uint16_t l= 4; l < (4 + nCold); l+= 7)
+      {
+        fillWear(b, 0xC0 + l, l & 0xF);
+        a.u32= ((uint32_t)(bS + l) << 12) + ((l & 0xF) << 8);
+        d3.dataRead(t, 256, a);
+        ok&= (0 == memcmp(b, t, 256));
+      }
+    }
+    s.print(" remount: spares="); s.print(d2.spares());
+    s.println(ok ? " OK" : " FAIL");
+  }
+  SPI.detach(&flash);
+  return(ok);
+} // benchWear
+
+// 4KB flash burst via transaction queue while "sampling" every 10us
+bool benchSPIQ (Stream& s, const uint8_t clkMHz=42)
+{
+  CHostW25Q flash(32);
+  CW25QUtil dev(clkMHz);
+  CHostSPIQ q;
+  SPIQ::Trans t[16];
+  CHostBench bm;
+  const uint32_t n= 16 * W25Q::PAGE_BYTES;
+  uint32_t nS= 0;
+  UU32 a={0};
+
+  SPI.attach(&flash, PIN_NCS);
+  dev.init();
+  memcpy(flash.image(), gBuff, n);
+  memset(gBuff+n, 0, n);
+
+  bm.start();
+  for (int i=0; i<16; i++)
+  {
+    a.u32= i * W25Q::PAGE_BYTES;
+    while (!dev.dataReadAS(q, t[i], gBuff+n+a.u32, W25Q::PAGE_BYTES, a)) { delayMicroseconds(10); nS++; q.poll(); }
+  }
+  while (!q.idle()) { delayMicroseconds(10); nS++; q.poll(); }
+  bm.stop(n);
+
+  bool ok= (0 == memcmp(gBuff, gBuff+n, n)) && (16 == q.nDone);
+  bm.report(s,"SPIQ");
+  s.print(" trans="); s.print(q.nDone); s.print(" xfer="); s.print(q.nXfer);
+  s.print(" samples="); s.print(nS);
+  s.println(ok ? " OK" : " FAIL");
+  SPI.detach(&flash);
+  return(ok);
+} // benchSPIQ
+
+// Post & run bus to completion
+int8_t runTWM (TWM::Trans& t)
+{
+  if (!gTWM.post(t)) { return(TWM::FREE); }
+  gHostTWI.sync();
+  return(t.state);
+} // runTWM
+
+void postNext (TWM::Trans& t) { gTWM.post(*(TWM::Trans*)t.ctx); }
+
+// TWM::ISR state machine against scripted slaves: fragment modes, ACK polling,
+// queue chaining, failure & callbacks, clock stretching
+bool testTWM (Stream& s)
+{
+  CHostEEPROM ee(gBuff+(1<<16), 4096, 32);
+  CHostRTC rtc;
+  CHostNackDev nd(0x3C, 1);
+  TWM::Trans t[4];
+  TWM::Frag f[4][2];
+  uint16_t a[4];
+  uint8_t rb[4][16], fill= 0xA5, nOK= 0, nT= 0;
+  uint64_t t0;
+
+  gHostTWI.attach(&ee); gHostTWI.attach(&rtc); gHostTWI.attach(&nd);
+  gTWM.setClkT(TWM::CLK_400);
+  gHostTWI.resetStats();
+
+  // page write, address big endian via REV
+  a[0]= 0x0040;
+  f[0][0]= {(uint8_t*)a, 2, TWM::REV|TWM::WRITE};
+  f[0][1]= {gBuff, 16, TWM::WRITE};
+  t[0].set(0x50, f[0], 2);
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (18 == t[0].nX) && (0 == memcmp(gBuff+(1<<16)+0x40, gBuff, 16));
+
+  // ACK poll (address only) through write cycle
+  uint8_t nP= 0;
+  f[1][0]= {rb[0], 0, TWM::WRITE};
+  t[1].set(0x50, f[1], 1);
+  t0= gHostClock.nowNs();
+  while ((TWM::DONE != runTWM(t[1])) && (++nP < 100)) { delayMicroseconds(500); }
+  nT++; nOK+= (nP > 0) && (nP < 100) && ((gHostClock.nowNs() - t0) >= ee.tWRNs) && (ee.nPoll == nP);
+
+  // random read, verify all, verify until fail
+  f[0][1]= {rb[0], 16, TWM::READ};
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (0 == memcmp(rb[0], gBuff, 16));
+  f[0][1]= {gBuff, 16, TWM::VERA};
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (16 == t[0].nV);
+  memcpy(rb[1], gBuff, 16); rb[1][5]^= 0x10;
+  f[0][1]= {rb[1], 16, TWM::VERF};
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (5 == t[0].nV) && (7 == t[0].nX - 2);
+
+  // repeated byte fill, read back with stop-start (RESTART)
+  f[0][1]= {&fill, 8, TWM::REPB|TWM::WRITE};
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (10 == t[0].nX);
+  delay(5);
+  f[0][1]= {rb[0], 8, TWM::RESTART|TWM::READ};
+  memset(rb[0], 0, 16);
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (0xA5 == rb[0][0]) && (0xA5 == rb[0][7]) && (gBuff[8] == gBuff[(1<<16)+0x48]);
+
+  // RESTART without change of direction: new transfer, its first two bytes address
+  uint8_t wb[]= {0x00, 0x60, 0x11, 0x22};
+  f[0][1]= {wb, 4, TWM::RESTART|TWM::WRITE};
+  gHostTWI.resetStats();
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (2 == gHostTWI.nStart) && (0x11 == gBuff[(1<<16)+0x60]) && (0x22 == gBuff[(1<<16)+0x61]);
+  delay(5);
+
+  // set RTC 12:34:56, chain: RTC read, NACK device, EEPROM read, absent device
+  uint8_t tb[]= {0x00, 0x56, 0x34, 0x12};
+  f[3][0]= {tb, 4, TWM::WRITE};
+  t[3].set(0x68, f[3], 1);
+  runTWM(t[3]);
+  delay(2000);
+  a[0]= 0; a[2]= 0x0040;
+  f[0][0]= {(uint8_t*)a, 1, TWM::WRITE}; f[0][1]= {rb[0], 7, TWM::READ}; t[0].set(0x68, f[0], 2);
+  f[1][0]= {gBuff, 4, TWM::WRITE}; t[1].set(0x3C, f[1], 1);
+  f[2][0]= {(uint8_t*)(a+2), 2, TWM::REV|TWM::WRITE}; f[2][1]= {rb[2], 16, TWM::READ}; t[2].set(0x50, f[2], 2);
+  f[3][0]= {rb[3], 1, TWM::READ}; t[3].set(0x21, f[3], 1);
+  const uint16_t nF0= gTWM.nFail;
+  gHostTWI.resetStats();
+  bool q= true;
+  for (int i=0; i<4; i++) { q&= gTWM.post(t[i]); }
+  q&= !gTWM.idle() && (4 == gTWM.queued());
+  gHostTWI.sync();
+  nT++; nOK+= q && (TWM::DONE == t[0].state) && (TWM::FAIL == t[1].state) && (TWM::DONE == t[2].state) && (TWM::FAIL == t[3].state) &&
+    (0x58 == rb[0][0]) && (0x34 == rb[0][1]) && (0 == memcmp(rb[2], gBuff+(1<<16)+0x40, 16)) && (2 == gTWM.nFail - nF0) &&
+    (2 == gHostTWI.nStop) && (6 == gHostTWI.nStart) && gTWM.idle();
+  s.print("TWM: chain start="); s.print(gHostTWI.nStart); s.print(" stop="); s.print(gHostTWI.nStop);
+  s.print(" nack="); s.print(gHostTWI.nNack);
+
+  // completion callback posts follow on
+  t[0].done= postNext; t[0].ctx= t+2;
+  memset(rb[2], 0, 16);
+  nT++; nOK+= (TWM::DONE == runTWM(t[0])) && (TWM::DONE == t[2].state) && (0xA5 == rb[2][0]) && (gBuff[8] == rb[2][8]);
+  t[0].done= NULL;
+
+  // clock stretching (per data byte)
+  uint64_t dt[2];
+  for (int i=0; i<2; i++)
+  {
+    rtc.stretchNs= i * 10000;
+    t0= gHostClock.nowNs();
+    runTWM(t[0]);
+    dt[i]= gHostClock.nowNs() - t0;
+  }
+  rtc.stretchNs= 0;
+  nT++; nOK+= (80000 == dt[1] - dt[0]);
+  s.print(" stretch="); s.print((uint32_t)(dt[1]-dt[0])); s.print("ns");
+  s.print(" tests="); s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  gHostTWI.detach(&ee); gHostTWI.detach(&rtc); gHostTWI.detach(&nd);
+  return(nOK == nT);
+} // testTWM
+
+// Decode SerMux framed trace records from stream, returning first & last
+// record times (ticks) of the frames read
+uint32_t decodeTWT (TWT::Decoder& dec, CMemStream& ms, uint32_t tR[], const uint32_t nMax)
+{
+  CSerMux mux;
+  TWT::Rec d[4];
+  uint8_t epid;
+  int8_t n;
+  uint32_t k= 0;
+  while ((n= mux.recv((uint8_t*)d, sizeof(d), epid, ms)) > 0)
+  {
+    for (int i=0; i < (n / (int)sizeof(TWT::Rec)); i++)
+    {
+      uint32_t t;
+      if (dec.decode(d[i], t) && (k < nMax)) { tR[k++]= t; }
+    }
+  }
+  return(k);
+} // decodeTWT
+
+// Trace ring: out of band drain, stamp unwrap across a stall, loss accounting
+bool testTWTrace (Stream& s)
+{
+  CHostEEPROM ee(gBuff+(1<<16), 4096, 32);
+  CMemStream ms(true);
+  CSerMux mux;
+  TWT::Decoder dec;
+  TWM::Trans t;
+  TWM::Frag f[2];
+  uint16_t a= 0;
+  uint8_t rb[8];
+  uint32_t tR[64], k, nEv;
+  uint64_t tP[2];
+
+  gHostTWI.attach(&ee);
+  gTWM.setClkT(TWM::CLK_400);
+  gTWM.clrEv();
+  gHostTWI.resetStats();
+  f[0]= {(uint8_t*)&a, 2, TWM::REV|TWM::WRITE};
+  f[1]= {rb, 8, TWM::READ};
+  t.set(0x50, f, 2);
+
+  tP[0]= gHostClock.nowNs();
+  runTWM(t);
+  gTWM.sendEv(ms, mux, 1);
+  delay(10); // bus idle beyond stamp roll over
+  tP[1]= gHostClock.nowNs();
+  runTWM(t);
+  nEv= gHostTWI.nEvent;
+  gTWM.sendEv(ms, mux, 1);
+  k= decodeTWT(dec, ms, tR, 64);
+  const uint32_t kA= k / 2; // first record of second transaction
+  const int32_t eUs= (int32_t)((tR[kA] - tR[0]) / TWT_TICK_PER_US) - (int32_t)((tP[1] - tP[0]) / 1000);
+  bool ok= (k == nEv) && (0 == (k & 1)) && (0 == dec.nLost) && (abs(eUs) <= 8);
+  s.print("TWTrace: rec="); s.print(k); s.print('/'); s.print(nEv);
+  s.print(" gap="); s.print((tR[kA] - tR[0]) / TWT_TICK_PER_US); s.print("us err="); s.print(eUs);
+
+  // overrun without drain
+  gHostTWI.resetStats();
+  for (int i=0; i<3; i++) { runTWM(t); }
+  nEv= gHostTWI.nEvent;
+  gTWM.sendEv(ms, mux, 1);
+  TWT::Decoder dec2;
+  k= decodeTWT(dec2, ms, tR, 64);
+  ok&= (TWT_MAX == k) && (dec2.nLost == nEv - TWT_MAX);
+  s.print(" overrun rec="); s.print(k); s.print(" lost="); s.print(dec2.nLost);
+  s.println(ok ? " OK" : " FAIL");
+  gHostTWI.detach(&ee);
+  return(ok);
+} // testTWTrace
+
+// Clock planner: optimal (highest not exceeding target) TWBR/prescaler for a range
+// of core clocks & targets; per device rates on a shared bus
+bool testTWMClk (Stream& s)
+{
+  static_assert((TWM::CLK_100 == TWM::plan(100000, 16000000).br) && (TWM::CLK_400 == TWM::plan(400000, 16000000).br), "TWM::plan");
+  static const uint32_t fC[]= {1000000, 8000000, 16000000, 20000000};
+  static const uint32_t fS[]= {1000000, 400000, 250000, 100000, 31250, 10000, 2000, 500};
+  uint8_t nOK= 0, nT= 0;
+
+  for (uint8_t i=0; i < sizeof(fC)/sizeof(fC[0]); i++)
+  {
+    for (uint8_t j=0; j < sizeof(fS)/sizeof(fS[0]); j++)
+    {
+      const TWM::Rate r= TWM::plan(fS[j], fC[i]);
+      const uint32_t f= TWM::sclHz(r, fC[i]), fT= min(fS[j], TWM_SCL_MAX);
+      bool ok= (f <= fT) || ((fC[i] / 16 < fT) && (0 == r.br)) || ((0xFF == r.br) && (3 == r.ps)); // else saturated
+      if (r.br > 0) { TWM::Rate q= r; q.br--; ok&= (TWM::sclHz(q, fC[i]) > fT); } // optimal
+      if (r.ps > 0) { ok&= (TWM::brFor(TWM::ratioFor(fC[i], fT), r.ps-1) > 0xFF); } // least prescale
+      if ((r.ps < 3) || (r.br < 0xFF)) { ok&= (f * 1.1 > fT) || (TWM::ratioFor(fC[i], fT) < 32); } // NB: coarse at low ratio
+      nT++; nOK+= ok;
+    }
+  }
+
+  // shared bus: EEPROM at 400kHz, RTC at bus default 100kHz
+  CHostEEPROM ee(gBuff+(1<<16), 4096, 32);
+  CHostRTC rtc;
+  TWM::Trans t[3];
+  TWM::Frag f[3][2];
+  uint8_t rb[3][32], a0= 0;
+  uint16_t a1= 0x0100;
+  uint64_t dt[2];
+
+  memcpy(gBuff+(1<<16), gBuff, 4096);
+  gHostTWI.attach(&ee); gHostTWI.attach(&rtc);
+  gTWM.setRate(100000);
+  for (int k=0; k<2; k++)
+  {
+    f[0][0]= {&a0, 1, TWM::WRITE}; f[0][1]= {rb[0], 8, TWM::READ};
+    f[1][0]= {(uint8_t*)&a1, 2, TWM::REV|TWM::WRITE}; f[1][1]= {rb[1], 32, TWM::READ};
+    f[2][0]= {&a0, 1, TWM::WRITE}; f[2][1]= {rb[2], 8, TWM::READ};
+    t[0].set(0x68, f[0], 2);
+    t[1].set(0x50, f[1], 2, k ? TWM_RATE_DEFAULT : TWM::plan(400000));
+    t[2].set(0x68, f[2], 2);
+    gHostTWI.resetStats();
+    const uint64_t t0= gHostClock.nowNs();
+    for (int i=0; i<3; i++) { gTWM.post(t[i]); }
+    gHostTWI.sync();
+    dt[k]= gHostClock.nowNs() - t0;
+    nT++; nOK+= (TWM::DONE == t[2].state) && (0 == memcmp(rb[1], gBuff+0x100, 32)) && (gHostTWI.nStop == (k ? 1 : 3)) &&
+      (TWM::CLK_100 == TWBR);
+  }
+  // 36 of 58 bytes at 4x rate -> 0.53
+  const float r= (float)dt[0] / dt[1];
+  nT++; nOK+= (r > 0.5) && (r < 0.56);
+  s.print("TWMClk: plans & shared bus "); s.print(nOK); s.print('/'); s.print(nT);
+  s.print(" mixed/100k="); s.print(r, 3);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  gHostTWI.detach(&ee); gHostTWI.detach(&rtc);
+  return(nOK == nT);
+} // testTWMClk
+
+// EEPROM read throughput with 4 queued 32 byte transactions at a time: ISR
+// events per byte & host time per event, bus utilisation at 100 & 400kHz
+bool benchTWM (Stream& s, const TWM::ClkTok ck)
+{
+  CHostEEPROM ee(gBuff+(1<<16), 4096, 32);
+  TWM::Trans t[4];
+  TWM::Frag f[4][2];
+  uint16_t a[4];
+  CHostBench bm;
+  uint32_t nB= 0;
+  char label[16];
+
+  memcpy(gBuff+(1<<16), gBuff, 4096);
+  gHostTWI.attach(&ee);
+  gTWM.setClkT(ck);
+  gHostTWI.resetStats();
+  bm.start();
+  for (uint16_t p= 0; p < 4096; p+= 32 * 4)
+  {
+    for (int i=0; i<4; i++)
+    {
+      a[i]= p + i * 32;
+      f[i][0]= {(uint8_t*)(a+i), 2, TWM::REV|TWM::WRITE};
+      f[i][1]= {gBuff+(1<<16)+4096+a[i], 32, TWM::READ};
+      t[i].set(0x50, f[i], 2);
+      gTWM.post(t[i]);
+    }
+    gHostTWI.sync();
+    for (int i=0; i<4; i++) { nB+= (TWM::DONE == t[i].state) * 32; }
+  }
+  bm.stop(nB);
+  bool ok= (4096 == nB) && (0 == memcmp(gBuff, gBuff+(1<<16)+4096, 4096));
+  snprintf(label, sizeof(label), "TWM%ukHz", (unsigned)(16000 / (16 + 2 * ck)));
+  bm.report(s,label);
+  s.print(" ev/B="); s.print((float)gHostTWI.nEvent / gHostTWI.nByte, 3);
+  s.print(" ns/ev="); s.print((float)gHostTWI.tEventWall / gHostTWI.nEvent, 1);
+  s.print(" start="); s.print(gHostTWI.nStart); s.print(" stop="); s.print(gHostTWI.nStop);
+  s.println(ok ? " OK" : " FAIL");
+  gHostTWI.detach(&ee);
+  return(ok);
+} // benchTWM
+
+// RTC set: full, date only, time only (with & without day) and second adjustment each
+// write exactly the registers packed, checked against the model register file
+bool testDS1307Set (Stream& s)
+{
+  static const struct { const char *time, *day, *date; uint8_t r[7]; } t[]=
+  { // expected T_SS .. D_YY, 0xFF -> unchanged
+    { "12:34:56", NULL, "Oct 17 2026", {0x56, 0x34, 0x12, 0x06, 0x17, 0x10, 0x26} }, // Sat
+    { NULL, NULL, "Jan 02 2025", {0xFF, 0xFF, 0xFF, 0x04, 0x02, 0x01, 0x25} }, // Thu
+    { "01:02:03", NULL, NULL, {0x03, 0x02, 0x01, 0xFF, 0xFF, 0xFF, 0xFF} },
+    { "04:05:06", "Mon", NULL, {0x06, 0x05, 0x04, 0x01, 0xFF, 0xFF, 0xFF} },
+    { NULL, "Wed", NULL, {0xFF, 0xFF, 0xFF, 0x03, 0xFF, 0xFF, 0xFF} },
+  };
+  CHostRTC rtc;
+  CDS1307A ds;
+  uint8_t nOK= 0, nT= 0, p[8];
+  uint8_t *r= rtc.reg();
+
+  Wire.attach(&rtc);
+  r[DS1307HW::SQ_CTRL]= 0x5A; // sentinel
+  for (uint8_t k=0; k < sizeof(t)/sizeof(t[0]); k++)
+  {
+    memcpy(p, r, sizeof(p));
+    ds.setA(t[k].time, t[k].day, t[k].date, 2);
+    uint8_t nE= (0x5A == r[DS1307HW::SQ_CTRL]);
+    for (int i=0; i<7; i++) { nE+= (r[i] == ((0xFF == t[k].r[i]) ? p[i] : t[k].r[i])); }
+    nT++; nOK+= (8 == nE);
+  }
+  memcpy(p, r, sizeof(p));
+  ds.adjustSec(2);
+  nT++; nOK+= (0x08 == r[DS1307HW::T_SS]) && (0 == memcmp(p+1, r+1, sizeof(p)-1));
+  s.print("DS1307Set: "); s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  Wire.detach(&rtc);
+  return(nOK == nT);
+} // testDS1307Set
+
+// RTC time service over 1ms steps: interval resync only, then with square wave edges
+// (and crystal error) without periodic reads; monotonic through day roll over
+bool testDS1307Time (Stream& s)
+{
+  static const int32_t ppm[]= {0, 1500, -2000};
+  CHostRTC rtc;
+  CDS1307A ds;
+  uint8_t nOK= 0, nT= 0;
+  int32_t eMax[2]={0,0};
+
+  Wire.attach(&rtc);
+  for (int k=0; k<3; k++)
+  {
+    const bool sqw= (k > 0);
+    uint32_t tPrev= 0, nRoll= 0, nBack= 0;
+    int32_t eLo= 1000, eHi= -1000;
+    uint8_t q= 1;
+
+    rtc.ppm= ppm[k];
+    ds.resyncMs= sqw ? 0 : 10000;
+    ds.setA(sqw ? "23:57:58" : "12:34:56", NULL, NULL, 2);
+    ds.setSqCtrl(sqw ? DS1307HW::SQWE : DS1307HW::SQ_OUT);
+    ds.nRead= 0; ds.nEdge= 0;
+    for (uint32_t i=0; i < 150000; i++)
+    {
+      gHostClock.advance(1000000);
+      const uint8_t v= rtc.sqw();
+      if (sqw && q && !v) { ds.edge(); }
+      q= v;
+      const uint32_t t= ds.msOfDay();
+      if (t < tPrev) { if ((tPrev > DS1307_DAY_MS - 1000) && (t < 1000)) { nRoll++; } else { nBack++; } }
+      tPrev= t;
+      int32_t e= (int32_t)(rtc.msOfDay() - t);
+      if (e > 43200000) { e-= DS1307_DAY_MS; } else if (e < -43200000) { e+= DS1307_DAY_MS; }
+      if ((i >= 3000) && (ds.isPhased() == sqw)) { eLo= min(eLo, e); eHi= max(eHi, e); }
+    }
+    eMax[sqw]= max(eMax[sqw], max(eHi, -eLo));
+    // interval: lag < 1s (plus drift) & 15 reads; edges: few ms & (day roll over) reads only
+    if (sqw) { nT++; nOK+= (eLo >= -3) && (eHi <= 3) && (1 == nRoll) && (ds.nRead <= 3) && (ds.nEdge >= 145); }
+    else { nT++; nOK+= (eLo >= 0) && (eHi < 1000) && (ds.nRead >= 15) && (ds.nRead <= 16); }
+    nT++; nOK+= (0 == nBack);
+    s.print("DS1307Time: ppm="); s.print(ppm[k]); s.print(" err="); s.print(eLo); s.print(".."); s.print(eHi);
+    s.print("ms reads="); s.print(ds.nRead); s.print(" edges="); s.println(ds.nEdge);
+  }
+  s.print("DS1307Time: "); s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  Wire.detach(&rtc);
+  return(nOK == nT);
+} // testDS1307Time
+
+// EEPROM configuration updates (1-4 bytes, half unchanged, 64 byte record across 3
+// pages, 1ms of other work per update): write through with ACK polling vs write
+// back cache flushed by poll(). Write cycles, bus time & contents; eviction.
+bool testCAT24CCache (Stream& s)
+{
+  static uint8_t img[4096], rb[256];
+  CHostEEPROM ee(gBuff+(1<<16), sizeof(img), 32);
+  CAT24C d;
+  CAT24CCache c;
+  uint32_t nC[2], x= 0x2468ACE1;
+  uint64_t tB[2];
+  uint8_t nOK= 0, nT= 0;
+
+  Wire.attach(&ee);
+  for (int k=0; k<2; k++)
+  {
+    memset(img, 0xFF, sizeof(img));
+    memset(gBuff+(1<<16), 0xFF, sizeof(img));
+    ee.nCycle= 0;
+    tB[k]= 0;
+    for (int i=0; i<200; i++)
+    {
+      x= x * 1103515245 + 12345;
+      const uint16_t a= 0xF0 + ((x >> 8) % 61);
+      const uint8_t n= 1 + ((x >> 20) & 0x3);
+      uint8_t v[4];
+      for (int j=0; j<n; j++) { v[j]= (x & 0x80000000) ? img[a+j] : (uint8_t)(x >> (4 * j)); img[a+j]= v[j]; }
+      const uint64_t t0= gHostClock.nowNs();
+      if (k) { c.write(a, v, n); c.poll(); }
+      else
+      { // split at page boundary
+        const uint8_t m= min(n, 32 - (a & 31));
+        UU16 u= { a }; d.writeAddr(u, v, m); d.sync();
+        if (m < n) { u.u16+= m; d.writeAddr(u, v+m, n-m); d.sync(); }
+      }
+      tB[k]+= gHostClock.nowNs() - t0;
+      gHostClock.advance(1000000);
+    }
+    if (k) { const uint64_t t0= gHostClock.nowNs(); c.flush(); tB[k]+= gHostClock.nowNs() - t0; }
+    nC[k]= ee.nCycle;
+    nT++; nOK+= (0 == memcmp(img, gBuff+(1<<16), sizeof(img)));
+  }
+  nT++; nOK+= (nC[1] * 4 < nC[0]) && (nC[1] == c.nWrite) && (c.nSkip > 0) && (tB[1] * 4 < tB[0]);
+  // unchanged record: no write back
+  c.write(0xF0, img+0xF0, 64);
+  nT++; nOK+= (0 == c.dirtyPages()) && !c.poll() && (c.read(0xF0, rb, 64) == 64) && (0 == memcmp(rb, img+0xF0, 64));
+  // 8 pages through 4 lines: eviction & uncached reads
+  for (int i=0; i<256; i++) { img[0x400+i]= i ^ 0x5A; }
+  c.write(0x400, img+0x400, 256);
+  nT++; nOK+= c.flush() && (c.read(0x400, rb, 256) == 256) && (0 == memcmp(rb, img+0x400, 256)) &&
+    (0 == memcmp(img, gBuff+(1<<16), sizeof(img)));
+  s.print("CAT24CCache: cycles direct="); s.print(nC[0]); s.print(" cached="); s.print(nC[1]);
+  s.print(" skip="); s.print(c.nSkip); s.print(" poll="); s.print(c.nPoll);
+  s.print(" bus ms="); s.print((float)tB[0] * 1E-6, 1); s.print('/'); s.print((float)tB[1] * 1E-6, 1);
+  s.print(' '); s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  Wire.detach(&ee);
+  return(nOK == nT);
+} // testCAT24CCache
+
+// MAX30102 FIFO streaming from a replayed dump (unique 18 bit values): almost full
+// interrupt (INT falling edge), burst read queued (TWM) vs synchronous (Wire) at
+// SR400/100kHz & SR1600/400kHz. Samples in recorded order without loss; main loop
+// time spent reading. Also direct dump unpack.
+bool testMAX30102 (Stream& s)
+{
+  static const uint16_t nRec= 500;
+  static uint8_t rec[nRec * 6];
+  static const MAX30102HW::SampleRate sr[]= {MAX30102HW::SR400, MAX30102HW::SR1600};
+  static const uint32_t clk[]= {100000, 400000};
+  CHostMAX30102 dev(rec, sizeof(rec));
+  CMAX30102Stream ms;
+  CMAX30102Ring::Sample d[MAX30102_RING];
+  uint8_t nOK= 0, nT= 0;
+
+  for (uint16_t i=0; i < nRec; i++)
+  {
+    const uint32_t v[2]= { (i * 40503U + 1000) & 0x3FFFF, ((i * 9973U) ^ 0x2AAAA) & 0x3FFFF };
+    for (int j=0; j<2; j++) { rec[6*i+3*j]= v[j] >> 16; rec[6*i+3*j+1]= v[j] >> 8; rec[6*i+3*j+2]= v[j]; }
+  }
+  { // replay dump directly
+    CMAX30102Ring rg;
+    uint16_t k= rg.unpack(rec, 20);
+    k+= rg.unpack(rec+120, 20); // ring full
+    nT++; nOK+= (32 == k) && (8 == rg.nLost) && (32 == rg.get(d, MAX30102_RING)) && (d[31].red == ((31 * 40503U + 1000) & 0x3FFFF)) &&
+      (d[31].ir == (((31 * 9973U) ^ 0x2AAAA) & 0x3FFFF));
+  }
+  Wire.attach(&dev); gHostTWI.attach(&dev);
+  for (int c=0; c<2; c++)
+  {
+    for (int q=0; q<2; q++)
+    {
+      uint32_t nS= 0, nBad= 0, k= 0, nLost= dev.nLost;
+      uint64_t tRd= 0;
+      uint8_t pin= 1;
+
+      ms.useQ= q; gTWM.setRate(clk[c]); Wire.setClock(clk[c]);
+      ms.start(sr[c]); ms.arm(15);
+      ms.nIn= ms.nLost= ms.nBurst= ms.nErr= 0;
+      for (uint32_t i=1; i <= 100000; i++) // 1s
+      {
+        gHostClock.advance(10000);
+        const uint8_t v= dev.intPin();
+        if (pin && !v) { ms.irq(); }
+        pin= v;
+        gHostTWI.poll();
+        if (0 == (i % 100))
+        {
+          const uint64_t t0= gHostClock.nowNs();
+          ms.poll();
+          tRd+= gHostClock.nowNs() - t0;
+          const uint16_t n= ms.get(d, MAX30102_RING);
+          for (uint16_t j=0; j < n; j++, nS++)
+          {
+            if (0 == nS) { while ((k < nRec) && (d[j].red != ((k * 40503U + 1000) & 0x3FFFF))) { ++k; } }
+            else { k= (k + 1) % nRec; }
+            nBad+= (d[j].red != ((k * 40503U + 1000) & 0x3FFFF)) || (d[j].ir != (((k * 9973U) ^ 0x2AAAA) & 0x3FFFF));
+          }
+        }
+      }
+      const uint32_t nE= (400 << (2 * c)) - 32; // less FIFO content
+      nT++; nOK+= (nS >= nE) && (0 == nBad) && (dev.nLost == nLost) && (0 == ms.nLost) && (0 == ms.nErr);
+      s.print("MAX30102: SR"); s.print(400 << (2 * c)); s.print(q ? " TWM " : " Wire "); s.print(clk[c] / 1000); s.print("kHz samples=");
+      s.print(nS); s.print(" bursts="); s.print(ms.nBurst); s.print(" lost="); s.print(dev.nLost - nLost + ms.nLost);
+      s.print(" loop read ms="); s.println((float)tRd * 1E-6, 2);
+    }
+  }
+  { uint8_t b[2]= { MAX30102HW::MCON, 0x80 }; Wire.beginTransmission(MAX30102HW::ADDR); Wire.write(b, 2); Wire.endTransmission(); } // shutdown
+  s.print("MAX30102: "); s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  Wire.detach(&dev); gHostTWI.detach(&dev);
+  return(nOK == nT);
+} // testMAX30102
+
+// DS18B20 pipeline: 16 probes (& a non temperature device) enumerated, set time at
+// 12 & 9 bit resolution against 16 sequential conversions, CRC failure isolated
+bool testDS18 (Stream& s)
+{
+  static const uint8_t nP= 16;
+  CHostDS18B20 dev[nP+1];
+  CDS18Bus ow;
+  uint8_t nOK= 0, nT= 0;
+  uint32_t dt[3];
+
+  for (uint8_t i=0; i <= nP; i++)
+  {
+    dev[i]= CHostDS18B20((i < nP) ? 0x28 : 0x01, 0x1000 + i * 0x0101);
+    dev[i].t16= -168 + i * 49; // -10.5C .. 35.4C
+    ow.attach(dev+i);
+  }
+  nT++; nOK+= (nP == ow.enumerate());
+  for (int k=0; k<2; k++)
+  {
+    const DS18::Res r= k ? DS18::R9 : DS18::R12;
+    uint8_t nV= 0;
+    ow.setResolution(r);
+    const uint32_t t0= millis();
+    while (!ow.poll()) { delay(1); }
+    dt[k]= millis() - t0;
+    for (uint8_t i=0; i < nP; i++)
+    {
+      const uint8_t *id= ow.id(i);
+      int j= 0;
+      while ((j < nP) && memcmp(id, dev[j].rom, 8)) { ++j; }
+      nV+= ow.isValid(i) && (j < nP) && (ow.raw(i) == (dev[j].t16 & ~((1 << (3 - r)) - 1)));
+    }
+    nT++; nOK+= (nP == nV) && (dt[k] >= DS18::convMs(r)) && (dt[k] < DS18::convMs(r) + nP * 15U);
+  }
+  // corrupted scratchpad read: probe invalid, others & previous value retained
+  {
+    const uint8_t *id= ow.id(3);
+    int j= 0;
+    while (memcmp(id, dev[j].rom, 8)) { ++j; }
+    const int16_t v= ow.raw(3);
+    dev[j].corrupt= 1; dev[j].t16+= 16;
+    while (!ow.poll()) { delay(1); }
+    uint8_t nV= 0;
+    for (uint8_t i=0; i < nP; i++) { nV+= ow.isValid(i); }
+    nT++; nOK+= !ow.isValid(3) && (nP-1 == nV) && (1 == ow.nCRC) && (v == ow.raw(3));
+  }
+  // DS18S20 present: fixed 750ms conversion, resolution set on the others only
+  {
+    const int16_t t= dev[0].t16;
+    dev[0]= CHostDS18B20(0x10, 0x1000);
+    dev[0].t16= t;
+    nT++; nOK+= (nP == ow.enumerate());
+    ow.setResolution(DS18::R9);
+    const uint32_t t0= millis();
+    while (!ow.poll()) { delay(1); }
+    dt[2]= millis() - t0;
+    uint8_t nV= 0;
+    for (uint8_t i=0; i < nP; i++)
+    {
+      const uint8_t *id= ow.id(i);
+      int j= 0;
+      while ((j < nP) && memcmp(id, dev[j].rom, 8)) { ++j; }
+      const int16_t m= (0 == j) ? ~0 : ~0x7;
+      nV+= ow.isValid(i) && (j < nP) && (ow.raw(i) == (dev[j].t16 & m));
+    }
+    nT++; nOK+= (nP == nV) && (dt[2] >= DS18::convMs(DS18::R12));
+  }
+  s.print("DS18: probes="); s.print(ow.count()); s.print(" set ms 12b="); s.print(dt[0]); s.print(" 9b="); s.print(dt[1]);
+  s.print(" S20="); s.print(dt[2]);
+  s.print(" (sequential 12b="); s.print(nP * DS18::convMs(DS18::R12)); s.print(") ");
+  s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  return(nOK == nT);
+} // testDS18
+
+CAnSampler gAn;
+
+SIGNAL(ADC_vect) { gAn.event(); }
+
+// Free running ADC sampler over 4 mux inputs (distinct levels): values exact with one
+// settling conversion discarded per switch, inexact without; sequence & time stamps
+// contiguous at 125kHz & 1MHz ADC clock; overflow accounted. Main loop time blocked
+// in synchronous reads for comparison.
+bool testAnSampler (Stream& s)
+{
+  static const uint8_t nC= 4;
+  static const uint8_t ps[]= {7, 4};
+  static const uint16_t tC[]= {1000, 200}; // consume interval us
+  CAnSampler::Sample d[ANLG_RING_MAX];
+  uint8_t nOK= 0, nT= 0;
+
+  for (int i=0; i<32; i++) { gHostADC.in[i]= 100 * i + 37; }
+  for (int k=0; k<3; k++)
+  {
+    const uint8_t nS= (k < 2) ? 1 : 0;
+    uint32_t nG= 0, nBad= 0, nSeq= 0;
+    uint16_t tL= 0;
+    uint8_t iL= nC-1;
+
+    gAn.init(ps[k & 1]);
+    gAn.start(nC, nS, 1 + (0 == nS));
+    for (uint32_t i=1; i <= 50000; i++) // 50ms
+    {
+      gHostClock.advance(1000);
+      gHostADC.poll();
+      if (0 == (i % tC[k & 1]))
+      {
+        const uint8_t n= gAn.get(d, ANLG_RING_MAX);
+        for (uint8_t j=0; j < n; j++, nG++)
+        {
+          const uint8_t c= CAnSampler::index(d[j]);
+          nBad+= (CAnSampler::value(d[j]) != gHostADC.in[gAn.get(c) & 0x1F]);
+          if (nS) { nSeq+= (c != (iL + 1) % nC) || ((nG > 0) && ((uint16_t)(d[j].t - tL) != 2)); }
+          iL= c; tL= d[j].t;
+        }
+      }
+    }
+    gAn.stop();
+    const uint16_t nCv= gAn.conversions();
+    nT++;
+    if (nS) { nOK+= (0 == nBad) && (0 == nSeq) && (0 == gAn.lost()) && (nG + 2 >= nCv / 2U); }
+    else { nOK+= (nBad > 0) && (0 == gAn.lost()); }
+    s.print("AnSampler: ADC clk="); s.print(16000 >> ps[k & 1]); s.print("kHz settle="); s.print(nS);
+    s.print(" conversions="); s.print(nCv); s.print(" samples="); s.print(nG); s.print(" inexact="); s.println(nBad);
+    gHostClock.advance(200000); gHostADC.poll();
+  }
+  { // stalled consumer: ring fills, excess counted
+    gAn.init(4);
+    gAn.start(nC);
+    for (uint32_t i=1; i <= 5000; i++) { gHostClock.advance(1000); gHostADC.poll(); }
+    gAn.stop();
+    const uint16_t nCv= gAn.conversions(), nL= gAn.lost();
+    const uint8_t n= gAn.get(d, ANLG_RING_MAX);
+    nT++; nOK+= (ANLG_RING_MAX == n) && (n + nL == nCv / 2) && (0 == gAn.avail());
+    s.print("AnSampler: stall conversions="); s.print(nCv); s.print(" held="); s.print(n); s.print(" lost="); s.println(nL);
+    gHostClock.advance(200000); gHostADC.poll();
+  }
+  { // synchronous equivalent: main loop blocked for each conversion
+    CAnReadSync rs(0);
+    const uint64_t t0= gHostClock.nowNs();
+    rs.init(0, 7);
+    for (uint8_t i=0; i < 64; i++) { rs.set(i % nC); rs.read(); }
+    const uint32_t dt= (gHostClock.nowNs() - t0) / 1000;
+    nT++; nOK+= (dt >= 64 * 104U);
+    s.print("AnSampler: sync read us/sample="); s.print(dt / 64.0, 1); s.print(' ');
+  }
+  s.print(nOK); s.print('/'); s.print(nT);
+  s.println((nOK == nT) ? " OK" : " FAIL");
+  return(nOK == nT);
+} // testAnSampler
+
+bool gOK= true; // all tests passed
+
+void setup (void)
+{
+  bootMsg(DEBUG);
+  gClock.setA(__DATE__,__TIME__);
+  fillPattern(gBuff, sizeof(gBuff));
+  gOK&= testSerMux(DEBUG);
+  gOK&= benchCRC(DEBUG);
+  benchSPI(DEBUG);
+  gOK&= benchSPIQ(DEBUG);
+  gOK&= benchW25Q(DEBUG,8);
+  gOK&= benchW25Q(DEBUG,42); // STM32F4 max.
+  gOK&= testW25QFrags(DEBUG);
+  gOK&= benchW25QLog(DEBUG,false);
+  gOK&= benchW25QLog(DEBUG,true);
+  gOK&= benchW25QRead(DEBUG,42);
+  gOK&= benchW25QRead(DEBUG,84);
+  gOK&= benchCFC(DEBUG,gClock);
+  gOK&= testCFCPowerCut(DEBUG);
+  gOK&= benchCFCGC(DEBUG);
+  gOK&= testCFCGCIndex(DEBUG);
+  gOK&= benchCFCRing(DEBUG);
+  gOK&= benchWear(DEBUG,false);
+  gOK&= benchWear(DEBUG,true);
+  gOK&= testTWM(DEBUG);
+  gOK&= testTWTrace(DEBUG);
+  gOK&= testTWMClk(DEBUG);
+  gOK&= benchTWM(DEBUG,TWM::CLK_100);
+  gOK&= benchTWM(DEBUG,TWM::CLK_400);
+  gOK&= testDS1307Set(DEBUG);
+  gOK&= testDS1307Time(DEBUG);
+  gOK&= testCAT24CCache(DEBUG);
+  gOK&= testMAX30102(DEBUG);
+  gOK&= testDS18(DEBUG);
+  gOK&= testAnSampler(DEBUG);
+} // setup
+
+void loop (void)
+{
+  hostStop(gOK ? 0 : 1);
+} // loop